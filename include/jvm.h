@@ -81,6 +81,26 @@ typedef struct jvm_allocation_callbacks_T jvm_allocation_callbacks;
  */
 typedef struct jvm_allocator_create_info_T jvm_allocator_create_info;
 
+/**
+ * How memory of an allocation is going to be accessed, which determines what memory types are preferred for it.
+ */
+typedef enum jvm_memory_usage_T jvm_memory_usage;
+
+/**
+ * How the allocator finds space for an allocation within its memory pools.
+ */
+typedef enum jvm_allocation_strategy_T jvm_allocation_strategy;
+
+/**
+ * How long an allocation is expected to live, which determines what pools it shares.
+ */
+typedef enum jvm_allocation_lifetime_T jvm_allocation_lifetime;
+
+/**
+ * Struct which holds parameters of a single buffer or image allocation.
+ */
+typedef struct jvm_allocation_create_info_T jvm_allocation_create_info;
+
 /**
  * Opaque handle to a buffer allocation.
  */
@@ -91,6 +111,96 @@ typedef struct jvm_buffer_allocation_T jvm_buffer_allocation;
  */
 typedef struct jvm_image_allocation_T jvm_image_allocation;
 
+/**
+ * Opaque handle to memory allocated for a buffer or an image which was created outside of the allocator.
+ */
+typedef struct jvm_memory_allocation_T jvm_memory_allocation;
+
+/**
+ * Struct which describes memory exported to a file descriptor, so that it can be imported by another process or device.
+ */
+typedef struct jvm_external_memory_info_T jvm_external_memory_info;
+
+/**
+ * Opaque handle to a group of buffers and images which share (alias) the same memory.
+ */
+typedef struct jvm_aliasing_group_T jvm_aliasing_group;
+
+/**
+ * Struct which describes a resource which is to be part of an aliasing group.
+ */
+typedef struct jvm_aliased_resource_info_T jvm_aliased_resource_info;
+
+/**
+ * Opaque handle to a staging ring used to upload data to buffers and images which the host can not write to.
+ */
+typedef struct jvm_uploader_T jvm_uploader;
+
+/**
+ * Opaque handle to a ring of host-cached memory used to read data of buffers and images back to the host.
+ */
+typedef struct jvm_readback_T jvm_readback;
+
+/**
+ * Handle to a slot of a readback ring, which receives data of a single copy. Never zero for a valid slot.
+ */
+typedef uint64_t jvm_readback_slot;
+
+/**
+ * Opaque handle to a sparse buffer, whose memory is bound page by page, so that only the pages in use are resident.
+ */
+typedef struct jvm_sparse_buffer_T jvm_sparse_buffer;
+
+/**
+ * Opaque handle to a sparse image, whose memory is bound tile by tile, so that only the tiles in use are resident.
+ */
+typedef struct jvm_sparse_image_T jvm_sparse_image;
+
+/**
+ * Callback called when an evictable buffer or image is about to be destroyed to make room for other allocations. The
+ * device is done with the resource at that point, so its data may be saved elsewhere, such as in host memory, and it
+ * may be recreated and reloaded once it is needed again.
+ * @param user_data Pointer given to jvm_buffer_set_evictable or jvm_image_set_evictable.
+ * @param buffer_allocation Buffer which is evicted, or NULL if an image is evicted.
+ * @param image_allocation Image which is evicted, or NULL if a buffer is evicted.
+ */
+typedef void (*jvm_eviction_callback)(
+        void* user_data, jvm_buffer_allocation* buffer_allocation, jvm_image_allocation* image_allocation);
+
+/**
+ * Opaque handle to a file being streamed into a buffer by worker threads.
+ */
+typedef struct jvm_stream_T jvm_stream;
+
+/**
+ * Struct which holds parameters of streaming a file into a buffer.
+ */
+typedef struct jvm_stream_info_T jvm_stream_info;
+
+/**
+ * Callback called once all of a stream's data is in the buffer, or once it failed. It is called from one of the
+ * stream's worker threads, so it should only hand the result over to another thread, such as by signaling it.
+ * @param user_data Pointer given as jvm_stream_info::user_data.
+ * @param result VK_SUCCESS if all data was written and flushed, otherwise the error which stopped the stream.
+ */
+typedef void (*jvm_stream_callback)(void* user_data, VkResult result);
+
+/**
+ * Opaque handle to a range of offsets, which are handed out the same way as memory of the allocator's pools, but
+ * without any memory behind them. Does not need a Vulkan device.
+ */
+typedef struct jvm_virtual_block_T jvm_virtual_block;
+
+/**
+ * Struct which holds parameters of a virtual block.
+ */
+typedef struct jvm_virtual_block_create_info_T jvm_virtual_block_create_info;
+
+/**
+ * Struct which receives statistics of a virtual block.
+ */
+typedef struct jvm_virtual_block_stats_T jvm_virtual_block_stats;
+
 
 struct jvm_allocation_callbacks_T
 {
@@ -142,6 +252,328 @@ struct jvm_error_callbacks_T
     void* state;
 };
 
+enum jvm_memory_usage_T
+{
+    /**
+     * Memory type is chosen only based on desired and undesired flags, preferring the type with the largest heap.
+     */
+    JVM_MEMORY_USAGE_UNKNOWN = 0,
+
+    /**
+     * Memory is only accessed by the device. Device local memory which is not host-visible is preferred, so that memory
+     * of a limited BAR is kept for resources which need it.
+     */
+    JVM_MEMORY_USAGE_GPU_ONLY = 1,
+
+    /**
+     * Memory is written by the host and read by the device, such as per-frame uniform data. Device local host-visible
+     * memory is preferred on integrated devices and on devices where the whole device memory is host-visible (resizable
+     * BAR), otherwise host memory is preferred.
+     */
+    JVM_MEMORY_USAGE_CPU_TO_GPU = 2,
+
+    /**
+     * Memory is written by the device and read by the host. Host-cached memory is preferred.
+     */
+    JVM_MEMORY_USAGE_GPU_TO_CPU = 3,
+
+    /**
+     * Memory is written by the host and only read by the device in transfers, such as staging buffers. Host memory which
+     * is not device local is preferred.
+     */
+    JVM_MEMORY_USAGE_CPU_ONLY = 4,
+
+    /**
+     * Memory is only used as a transient attachment. Lazily allocated memory is used for images when the device has it,
+     * otherwise this is the same as JVM_MEMORY_USAGE_GPU_ONLY.
+     */
+    JVM_MEMORY_USAGE_GPU_LAZY = 5,
+};
+
+enum jvm_allocation_strategy_T
+{
+    /**
+     * Use jvm_allocator_create_info::default_strategy, or JVM_ALLOCATION_STRATEGY_FIRST_FIT if that is not set either.
+     */
+    JVM_ALLOCATION_STRATEGY_DEFAULT = 0,
+
+    /**
+     * Take the first unused space which is large enough, searching pools in order they were created in.
+     */
+    JVM_ALLOCATION_STRATEGY_FIRST_FIT = 1,
+
+    /**
+     * Take the smallest unused space which is large enough out of all pools, which wastes the least memory. Best for
+     * long-lived resources.
+     */
+    JVM_ALLOCATION_STRATEGY_BEST_FIT = 2,
+
+    /**
+     * Take the unused space with the lowest offset, even for optimal tiling images when
+     * jvm_allocator_create_info::separate_linear_and_optimal is set, so that the ends of pools are left empty and the
+     * pools can be freed sooner.
+     */
+    JVM_ALLOCATION_STRATEGY_MIN_OFFSET = 3,
+
+    /**
+     * Take the first unused space which is large enough, continuing the search from where the last allocation from the
+     * pool was made. Best for short-lived resources, such as per-frame ones.
+     */
+    JVM_ALLOCATION_STRATEGY_FASTEST = 4,
+};
+
+enum jvm_allocation_lifetime_T
+{
+    /**
+     * Lifetime is not known. Such allocations share pools with each other.
+     */
+    JVM_ALLOCATION_LIFETIME_DEFAULT = 0,
+
+    /**
+     * Allocation lives for (almost) as long as the application, such as meshes and textures which are always needed.
+     * These are packed densely into their own pools with JVM_ALLOCATION_STRATEGY_BEST_FIT, unless a strategy is given.
+     */
+    JVM_ALLOCATION_LIFETIME_STATIC = 1,
+
+    /**
+     * Allocation lives until the end of a level or a similar phase of the application. These are placed into their own
+     * pools with JVM_ALLOCATION_STRATEGY_MIN_OFFSET, unless a strategy is given. The pools are released as soon as they
+     * are empty, even if jvm_allocator_create_info::automatically_free_unused is not set.
+     */
+    JVM_ALLOCATION_LIFETIME_LEVEL = 2,
+
+    /**
+     * Allocation lives for a frame or a few. These are placed into their own pools with JVM_ALLOCATION_STRATEGY_FASTEST,
+     * unless a strategy is given. The pools are kept when they are empty, even if
+     * jvm_allocator_create_info::automatically_free_unused is set, since they are going to be filled again soon. They are
+     * released by jvm_allocator_free_unused or when memory is needed elsewhere.
+     */
+    JVM_ALLOCATION_LIFETIME_FRAME = 3,
+};
+
+struct jvm_allocation_create_info_T
+{
+    /**
+     * How the memory is going to be accessed. Out of memory types with all desired and none of the undesired flags, the
+     * one most suited to this usage is chosen.
+     */
+    jvm_memory_usage usage;
+
+    /**
+     * Flags that the memory must have. This is in addition to flags required by the resource.
+     */
+    VkMemoryPropertyFlags desired_flags;
+
+    /**
+     * Flags that the memory must not have.
+     */
+    VkMemoryPropertyFlags undesired_flags;
+
+    /**
+     * If non-zero, the allocation is made for this resource only. Otherwise, the allocator makes it dedicated when the
+     * driver prefers or requires it, or when it is larger than half of jvm_allocator_create_info::min_pool_size.
+     */
+    VkBool32 dedicated;
+
+    /**
+     * How space for the allocation is found within memory pools. If set to JVM_ALLOCATION_STRATEGY_DEFAULT, the strategy
+     * depends on jvm_allocation_create_info::lifetime, or jvm_allocator_create_info::default_strategy is used if that is
+     * not set either.
+     */
+    jvm_allocation_strategy strategy;
+
+    /**
+     * How long the allocation is expected to live. Allocations of different lifetimes never share pools, so that
+     * short-lived allocations do not keep pools with long-lived ones from being released.
+     */
+    jvm_allocation_lifetime lifetime;
+
+    /**
+     * Priority of the memory in range (0, 1], which the driver uses to decide what to page out when the device runs out
+     * of memory. If set to 0, it is set to 0.5. Only allocations of the same priority share pools. Ignored unless
+     * jvm_allocator_create_info::memory_priority is non-zero.
+     */
+    float priority;
+
+    /**
+     * If non-zero and the chosen memory type runs out of memory even after the allocator freed what it could, the next
+     * best memory type with all desired and none of the undesired flags is tried (for example host visible memory
+     * instead of device local). Property flags of the memory which was used in the end can be checked with
+     * jvm_buffer_allocation_get_memory_flags or jvm_image_allocation_get_memory_flags.
+     */
+    VkBool32 allow_fallback;
+
+    /**
+     * Handle types the memory can be exported as with jvm_buffer_export_fd or jvm_image_export_fd. Only allocations with
+     * the same handle types share pools, so a pool exported for one resource only holds other exportable resources. The
+     * buffer or image create info must chain VkExternalMemoryBufferCreateInfo or VkExternalMemoryImageCreateInfo with
+     * the same handle types. Requires jvm_allocator_create_info::external_memory_fd to be non-zero.
+     */
+    VkExternalMemoryHandleTypeFlags export_handle_types;
+};
+
+struct jvm_external_memory_info_T
+{
+    /**
+     * Handle type of the file descriptor, such as VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT or
+     * VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT.
+     */
+    VkExternalMemoryHandleTypeFlagBits handle_type;
+
+    /**
+     * File descriptor of the memory. Once vkAllocateMemory imports it, its ownership passes to the Vulkan
+     * implementation, even if creating the resource for it fails afterwards.
+     */
+    int fd;
+
+    /**
+     * Size of the whole exported memory, which may be shared with other resources.
+     */
+    VkDeviceSize memory_size;
+
+    /**
+     * Offset within the memory at which the resource is bound.
+     */
+    VkDeviceSize offset;
+
+    /**
+     * Index of the memory type the memory was allocated from. Opaque file descriptors must be imported with the same
+     * memory type on the same device. For other handle types it is used if the handle supports it.
+     */
+    uint32_t memory_type_index;
+
+    /**
+     * Non-zero if the memory was a dedicated allocation for the resource, in which case it is imported as one too.
+     */
+    VkBool32 dedicated;
+};
+
+struct jvm_stream_info_T
+{
+    /**
+     * Path of the file to read.
+     */
+    const char* path;
+
+    /**
+     * Offset in the file of the first byte to read.
+     */
+    uint64_t file_offset;
+
+    /**
+     * Number of bytes to read.
+     */
+    VkDeviceSize size;
+
+    /**
+     * Offset in the buffer where the first byte is written.
+     */
+    VkDeviceSize buffer_offset;
+
+    /**
+     * Size of the pieces the range is split into, each of which is read and flushed by one worker at a time. If set to
+     * 0, it is set to 4 MiB.
+     */
+    VkDeviceSize chunk_size;
+
+    /**
+     * Number of worker threads reading the file in parallel. If set to 0, it is set to 4.
+     */
+    uint32_t thread_count;
+
+    /**
+     * Called once the stream is done. May be NULL.
+     */
+    jvm_stream_callback callback;
+
+    /**
+     * Pointer passed to jvm_stream_info::callback.
+     */
+    void* user_data;
+};
+
+struct jvm_virtual_block_create_info_T
+{
+    /**
+     * Size of the range of offsets which the block hands out.
+     */
+    VkDeviceSize size;
+
+    /**
+     * Smallest unused range which is split off of an allocation. Smaller ones stay part of it as padding. If set to 0,
+     * allocations are never larger than needed.
+     */
+    VkDeviceSize min_allocation_size;
+
+    /**
+     * Strategy used to pick where an allocation is placed. If set to JVM_ALLOCATION_STRATEGY_DEFAULT, it is set to
+     * JVM_ALLOCATION_STRATEGY_FIRST_FIT.
+     */
+    jvm_allocation_strategy strategy;
+
+    /**
+     * Allocation callbacks to use. If set to NULL, default allocators (using malloc, realloc, and free) are used.
+     */
+    const jvm_allocation_callbacks* allocation_callbacks;
+
+    /**
+     * Error callbacks to use. If set to NULL, default callback (which uses fprintf to write to stderr) is used.
+     */
+    const jvm_error_callbacks* error_callbacks;
+};
+
+struct jvm_virtual_block_stats_T
+{
+    /**
+     * Size of the block.
+     */
+    VkDeviceSize size;
+
+    /**
+     * Number of live allocations.
+     */
+    uint32_t allocation_count;
+
+    /**
+     * Space taken by live allocations, including their padding.
+     */
+    VkDeviceSize used_size;
+
+    /**
+     * Number of unused ranges between allocations.
+     */
+    uint32_t unused_range_count;
+
+    /**
+     * Size of the largest unused range. An allocation of at most this size with no alignment requirement would fit.
+     */
+    VkDeviceSize largest_unused_range;
+};
+
+struct jvm_aliased_resource_info_T
+{
+    /**
+     * Creation info of the buffer. Ignored if jvm_aliased_resource_info::image_create_info is not NULL.
+     */
+    const VkBufferCreateInfo* buffer_create_info;
+
+    /**
+     * Creation info of the image, or NULL if the resource is a buffer.
+     */
+    const VkImageCreateInfo* image_create_info;
+
+    /**
+     * Index of the first use of the resource (such as a render graph pass).
+     */
+    uint32_t first_use;
+
+    /**
+     * Index of the last use of the resource (inclusive). Resources with overlapping [first_use, last_use] intervals never
+     * share memory.
+     */
+    uint32_t last_use;
+};
+
 struct jvm_allocator_create_info_T
 {
     /**
@@ -154,275 +586,1440 @@ struct jvm_allocator_create_info_T
      */
     VkBool32 automatically_free_unused;
 
-    /**
-     * What is the smallest possible allocation size. If set to 0, it is set to VkPhysicalDeviceProperties::limits.nonCoherentAtomSize.
-     */
-    VkDeviceSize min_allocation_size;
+    /**
+     * What is the smallest possible allocation size. If set to 0, it is set to VkPhysicalDeviceProperties::limits.nonCoherentAtomSize.
+     */
+    VkDeviceSize min_allocation_size;
+
+    /**
+     * If non-zero, buffers and linear images are placed from the start of pools, while optimal tiling images are placed
+     * from the end, which keeps the padding needed for VkPhysicalDeviceLimits::bufferImageGranularity to a minimum.
+     */
+    VkBool32 separate_linear_and_optimal;
+
+    /**
+     * Set to non-zero if the device was created with Vulkan 1.1 or with VK_KHR_get_memory_requirements2 and
+     * VK_KHR_dedicated_allocation enabled. The allocator then gives resources their own memory whenever the driver
+     * prefers or requires it.
+     */
+    VkBool32 dedicated_allocation;
+
+    /**
+     * Set to non-zero if the device was created with Vulkan 1.3 or with VK_KHR_maintenance4 enabled. The allocator then
+     * finds memory requirements of resources without creating them first.
+     */
+    VkBool32 maintenance4;
+
+    /**
+     * Set to non-zero if the device was created with VK_EXT_memory_priority enabled. The allocator then gives memory the
+     * priority of jvm_allocation_create_info::priority.
+     */
+    VkBool32 memory_priority;
+
+    /**
+     * Set to non-zero if the device was created with VK_EXT_pageable_device_local_memory enabled. Priority of memory can
+     * then be changed after it is allocated with jvm_allocator_set_priority.
+     */
+    VkBool32 pageable_device_local_memory;
+
+    /**
+     * If non-zero, allocations from memory types in jvm_allocator_create_info::page_memory_type_bits are rounded up to a
+     * multiple of this size and placed in pools which keep track of their pages with a bitmap instead of splitting them
+     * into chunks. This is faster when most allocations are around the size of a page, such as tiles of a streaming
+     * cache. Must be a power of two. If it is smaller than VkPhysicalDeviceLimits::bufferImageGranularity, linear and
+     * optimal resources are kept in separate pools. Dedicated allocations and those with larger alignment are not
+     * affected.
+     */
+    VkDeviceSize page_size;
+
+    /**
+     * Bit i is set if allocations from memory type i should use pages of size jvm_allocator_create_info::page_size.
+     */
+    uint32_t page_memory_type_bits;
+
+    /**
+     * Set to non-zero if the device was created with VK_KHR_external_memory_fd enabled (and VK_EXT_external_memory_dma_buf
+     * for dma-buf handles). Memory can then be exported and imported with jvm_*_export_fd and jvm_*_import_fd.
+     */
+    VkBool32 external_memory_fd;
+
+    /**
+     * Set to non-zero if the device was created with VK_EXT_external_memory_host enabled. Buffers can then be created
+     * from host memory with jvm_buffer_create_from_host_pointer.
+     */
+    VkBool32 external_memory_host;
+
+    /**
+     * Strategy used by allocations which do not specify their own. If set to JVM_ALLOCATION_STRATEGY_DEFAULT, it is set
+     * to JVM_ALLOCATION_STRATEGY_FIRST_FIT.
+     */
+    jvm_allocation_strategy default_strategy;
+
+    /**
+     * Allocation callbacks to use. If set to NULL, default allocators (using malloc, realloc, and free) are used.
+     */
+    const jvm_allocation_callbacks* allocation_callbacks;
+
+    /**
+     * Error callbacks to use. If set to NULL, default callback (which uses fprintf to write to stderr) is used.
+     */
+    const jvm_error_callbacks* error_callbacks;
+
+    /**
+     * Vulkan logical device interface to use.
+     */
+    VkDevice device;
+
+    /**
+     * Physical Vulkan device to which the jvm_allocator_create_info::device corresponds to.
+     */
+    VkPhysicalDevice physical_device;
+};
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          Allocator functions
+ *
+ *
+ **********************************************************************************************************************/
+
+/**
+ * Creates a new Vulkan memory allocator.
+ * @param create_info Struct which contains most of the creation parameters.
+ * @param vk_allocation_callbacks Pointer to allocators to use for vulkan function calls. May be left NULL.
+ * @param p_out Pointer which receives the created allocator.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
+ */
+JVM_API
+VkResult jvm_allocator_create(
+        jvm_allocator_create_info create_info, const VkAllocationCallbacks* vk_allocation_callbacks,
+        jvm_allocator** p_out);
+
+/**
+ * Destroys the provided Vulkan memory allocator, unmapping and freeing any associated memory. Resources still waiting
+ * for deferred destruction are destroyed as well. Will report an error for each still unfree-d block.
+ * @param allocator Allocator to destroy.
+ */
+JVM_API
+void jvm_allocator_destroy(jvm_allocator* allocator);
+
+/**
+ * Frees unused memory pools. On allocators created with jvm_allocator_create_info::automatically_free_unused set to
+ * non-zero, this only frees pools of JVM_ALLOCATION_LIFETIME_FRAME allocations. On debug build, it will report any other
+ * unfree-d pools as internal errors
+ * @param allocator Allocator for which to free unused pools.
+ */
+JVM_API
+void jvm_allocator_free_unused(jvm_allocator* allocator);
+
+/**
+ * Reports how far the device has progressed, so that all resources passed to jvm_buffer_destroy_deferred or
+ * jvm_image_destroy_deferred with a retire value equal to or less than completed_value are destroyed. All such
+ * resources are destroyed in one batch, after which their memory can be reused by new allocations.
+ * @param allocator Allocator for which to process the deferred destructions.
+ * @param completed_value Last timeline semaphore value or frame index which the device has finished.
+ * @return VK_SUCCESS if successful, VK_ERROR_UNKNOWN an internal error occurred and memory of a destroyed resource
+ * was not found in its proper pool.
+ */
+JVM_API
+VkResult jvm_allocator_report_progress(jvm_allocator* allocator, uint64_t completed_value);
+
+/**
+ * Finds memory requirements of a buffer without keeping it around. Requirements are cached, so repeated queries with
+ * the same creation parameters (and creating such buffers) do not need to ask the driver again. If
+ * jvm_allocator_create_info::maintenance4 was not set, a temporary buffer is created the first time.
+ * @param allocator Allocator to use for the query.
+ * @param create_info Buffer creation info, as it would be passed to jvm_buffer_create.
+ * @param p_out Pointer which receives the memory requirements.
+ * @return VK_SUCCESS if successful, or the return value of vkCreateBuffer if that was needed and failed.
+ */
+JVM_API
+VkResult jvm_buffer_memory_requirements(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, VkMemoryRequirements* p_out);
+
+/**
+ * Finds memory requirements of an image without keeping it around. Requirements are cached, so repeated queries with
+ * the same creation parameters (and creating such images) do not need to ask the driver again. If
+ * jvm_allocator_create_info::maintenance4 was not set, a temporary image is created the first time.
+ * @param allocator Allocator to use for the query.
+ * @param create_info Image creation info, as it would be passed to jvm_image_create.
+ * @param p_out Pointer which receives the memory requirements.
+ * @return VK_SUCCESS if successful, or the return value of vkCreateImage if that was needed and failed.
+ */
+JVM_API
+VkResult jvm_image_memory_requirements(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, VkMemoryRequirements* p_out);
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          Buffer related functions
+ *
+ *
+ **********************************************************************************************************************/
+/**
+ * Creates a new buffer using vkCreateBuffer and binds the correct memory to it.
+ * @param allocator Allocator to use for the allocation.
+ * @param create_info Buffer creation info passed to vkCreateBuffer.
+ * @param desired_flags Flags that are desired for the buffer memory to have. This is in addition to flags required
+ * by the buffer.
+ * @param undesired_flags Flags that the memory should not have. If these conflict with buffer required memory flags,
+ * it will cause the function to fail with VK_ERROR_OUT_OF_DEVICE_MEMORY.
+ * @param dedicated If non-zero, the allocation is made for this buffer only. Otherwise, the allocator makes it dedicated
+ * when the driver prefers or requires it, or when it is larger than half of jvm_allocator_create_info::min_pool_size.
+ * @param p_out Pointer to receive the create allocation.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory,
+ * return value of vkCreateBuffer if that fails, VK_ERROR_OUT_OF_DEVICE_MEMORY if undesired_flags conflict with flags
+ * required by the buffer, return value of vkBindBufferMemory if that fails.
+ */
+JVM_API
+VkResult jvm_buffer_create(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, VkMemoryPropertyFlags desired_flags,
+        VkMemoryPropertyFlags undesired_flags, VkBool32 dedicated, jvm_buffer_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Creates a new buffer using vkCreateBuffer and binds memory to it, which is chosen based on the allocation info.
+ * @param allocator Allocator to use for the allocation.
+ * @param create_info Buffer creation info passed to vkCreateBuffer.
+ * @param allocation_info Parameters of the allocation.
+ * @param p_out Pointer to receive the create allocation.
+ * @return Same as jvm_buffer_create.
+ */
+JVM_API
+VkResult jvm_buffer_create2(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info,
+        const jvm_allocation_create_info* allocation_info, jvm_buffer_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Destroys a buffer allocation, destroying the buffer and returning its device memory to its pool.
+ * @param buffer_allocation Buffer allocation to free.
+ * @return VK_SUCCESS if successful VK_ERROR_UNKNOWN an internal error occurred and buffer memory allocation
+ * was not found in its proper pool.
+ */
+JVM_API
+VkResult jvm_buffer_destroy(jvm_buffer_allocation* buffer_allocation);
+
+/**
+ * Destroys a buffer allocation once the device no longer uses it. The allocation handle becomes invalid immediately,
+ * but the buffer and its device memory are only released once jvm_allocator_report_progress is called with a value
+ * equal to or greater than retire_value.
+ * @param buffer_allocation Buffer allocation to free.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the buffer.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
+ */
+JVM_API
+VkResult jvm_buffer_destroy_deferred(jvm_buffer_allocation* buffer_allocation, uint64_t retire_value);
+
+/**
+ * Changes the size of a buffer. A new buffer replaces the old one, while the allocation handle stays the same. The buffer
+ * grows in place when memory right after it is unused, otherwise it is moved to new memory of the same memory type if
+ * the buffer's requirements allow it. Memory a buffer no longer needs after shrinking is kept until it is destroyed.
+ * The old buffer, and the old memory if the buffer was moved, are destroyed once jvm_allocator_report_progress is
+ * called with a value equal to or greater than retire_value.
+ * @param buffer_allocation Buffer allocation to resize. If it was mapped and is moved, it is unmapped.
+ * @param create_info Information to create the new buffer with. It should be the same as the one the buffer was
+ * created with except for the size.
+ * @param command_buffer Command buffer in recording state to which a copy of the contents is recorded if the buffer is
+ * moved, or VK_NULL_HANDLE. Without it, contents of host visible memory are copied on the host right away, and
+ * contents of other memory are lost when it is moved.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the old buffer,
+ * including the copy recorded to command_buffer.
+ * @param p_moved Receives non-zero if the buffer was moved to new memory and zero if it was resized in place. May be
+ * NULL.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_DEVICE_MEMORY if memory for the moved buffer could not be
+ * allocated, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory. On failure the old buffer is
+ * left as it was.
+ */
+JVM_API
+VkResult jvm_buffer_resize(
+        jvm_buffer_allocation* buffer_allocation, const VkBufferCreateInfo* create_info, VkCommandBuffer command_buffer,
+        uint64_t retire_value, VkBool32* p_moved
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Attempts to map a provided buffer allocation to host memory. Behaviour depends on the memory flags from which it was
+ * allocated.
+ * @param buffer_allocation Buffer allocation to map.
+ * @param p_size Pointer which receives the size of the mapped region.
+ * @param p_out pointer which receives the pointer to the mapped memory.
+ * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if chunk is already mapped, return value of vkMapMemory
+ * if that fails, or the return value of vkFlushMappedMemoryRanges if that needed to be called and failed.
+ */
+JVM_API
+VkResult jvm_buffer_map(jvm_buffer_allocation* buffer_allocation, size_t* p_size, void** p_out);
+
+/**
+ * Attempts to unmap a provided buffer allocation to host memory. Behaviour depends on the memory flags from which it was
+ * allocated.
+ * @param buffer_allocation Buffer allocation to unmap.
+ * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if the chunk was not mapped before, or the return value
+ * of vkInvalidateMappedMemoryRanges if that fails.
+ */
+JVM_API
+VkResult jvm_buffer_unmap(jvm_buffer_allocation* buffer_allocation);
+
+/**
+ * Flushes mapped buffer to ensure changes made to it on the host are visible to the device.
+ * @param buffer_allocation Mapped buffer allocation to flush.
+ * @return VK_SUCCESS if successful, or return value of vkFlushMappedMemoryRanges if it fails.
+ */
+JVM_API
+VkResult jvm_buffer_mapped_flush(jvm_buffer_allocation* buffer_allocation);
+
+/**
+ * Invalidates mapped buffer to ensure changes made to it from the device are visible to the host.
+ * @param buffer_allocation Mapped buffer allocation to invalidate.
+ * @return VK_SUCCESS if successful, or return value of vkInvalidateMappedMemoryRanges if it fails.
+ */
+JVM_API
+VkResult jvm_buffer_mapped_invalidate(jvm_buffer_allocation* buffer_allocation);
+
+/**
+ * Writes data into a host visible buffer and flushes it if its memory is not host coherent. Unless the memory is host
+ * cached, the data is written with non-temporal stores picked for the CPU at allocator creation, which avoids reading
+ * write-combined memory into the cache. The buffer may or may not be mapped.
+ * @param buffer_allocation Buffer allocation to write to.
+ * @param offset Offset in the buffer where the data is written.
+ * @param data Data to write.
+ * @param size Number of bytes to write.
+ * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if the buffer is not host visible, VK_ERROR_UNKNOWN if
+ * the range does not fit into the buffer, or the return value of vkMapMemory or vkFlushMappedMemoryRanges if that
+ * fails.
+ */
+JVM_API
+VkResult jvm_mapped_write(
+        jvm_buffer_allocation* buffer_allocation, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+/**
+ * Fills a range of a host visible buffer with a byte value, the same way jvm_mapped_write writes data.
+ * @param buffer_allocation Buffer allocation to fill.
+ * @param offset Offset in the buffer where the range begins.
+ * @param value Value to set each byte to.
+ * @param size Number of bytes to set.
+ * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if the buffer is not host visible, VK_ERROR_UNKNOWN if
+ * the range does not fit into the buffer, or the return value of vkMapMemory or vkFlushMappedMemoryRanges if that
+ * fails.
+ */
+JVM_API
+VkResult jvm_mapped_fill(
+        jvm_buffer_allocation* buffer_allocation, VkDeviceSize offset, uint8_t value, VkDeviceSize size);
+
+/**
+ * Returns the Vulkan handle to the buffer.
+ * @param buffer_allocation Buffer allocation to get the handle from.
+ * @return Handle to the buffer.
+ */
+JVM_API
+VkBuffer jvm_buffer_allocation_get_buffer(jvm_buffer_allocation* buffer_allocation);
+
+/**
+ * Returns the allocator with which the buffer was allocated.
+ * @param buffer_allocation Buffer allocation to get the allocator from.
+ * @return Handle to the allocator.
+ */
+JVM_API
+jvm_allocator* jvm_buffer_allocation_get_allocator(jvm_buffer_allocation* buffer_allocation);
+
+/**
+ * Returns the useful size of the buffer in bytes.
+ * @param buffer_allocation Buffer allocation to get the size of.
+ * @return Useful size of the allocation.
+ */
+JVM_API
+VkDeviceSize jvm_buffer_allocation_get_size(jvm_buffer_allocation* buffer_allocation);
+
+/**
+ * Returns property flags of the memory type the buffer's memory was allocated from.
+ * @param buffer_allocation Buffer allocation to get the memory flags of.
+ * @return Property flags of the memory type.
+ */
+JVM_API
+VkMemoryPropertyFlags jvm_buffer_allocation_get_memory_flags(jvm_buffer_allocation* buffer_allocation);
+
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          Image related functions
+ *
+ *
+ **********************************************************************************************************************/
+
+/**
+ * Creates a new image using vkCreateBuffer and binds the correct memory to it.
+ * @param allocator Allocator to use for the allocation.
+ * @param create_info Image creation info passed to vkCreateImage.
+ * @param desired_flags Flags that are desired for the image memory to have. This is in addition to flags required
+ * by the image.
+ * @param undesired_flags Flags that the memory should not have. If these conflict with image required memory flags,
+ * it will cause the function to fail with VK_ERROR_OUT_OF_DEVICE_MEMORY.
+ * @param dedicated If non-zero, the allocation is made for this image only. Otherwise, the allocator makes it dedicated
+ * when the driver prefers or requires it, or when it is larger than half of jvm_allocator_create_info::min_pool_size.
+ * Images with VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT are given their own lazily allocated, non-mappable memory if the
+ * device has such a memory type, or device local memory if it does not.
+ * @param p_out Pointer to receive the create allocation.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory,
+ * return value of vkCreateBuffer if that fails, VK_ERROR_OUT_OF_DEVICE_MEMORY if undesired_flags conflict with flags
+ * required by the image, return value of vkBindImageMemory if that fails.
+ */
+JVM_API
+VkResult jvm_image_create(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, VkMemoryPropertyFlags desired_flags,
+        VkMemoryPropertyFlags undesired_flags, VkBool32 dedicated, jvm_image_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Creates a new image using vkCreateImage and binds memory to it, which is chosen based on the allocation info.
+ * @param allocator Allocator to use for the allocation.
+ * @param create_info Image creation info passed to vkCreateImage.
+ * @param allocation_info Parameters of the allocation.
+ * @param p_out Pointer to receive the create allocation.
+ * @return Same as jvm_image_create.
+ */
+JVM_API
+VkResult jvm_image_create2(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info,
+        const jvm_allocation_create_info* allocation_info, jvm_image_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Destroys a image allocation, destroying the image and returning its device memory to its pool.
+ * @param image_allocation Image allocation to free.
+ * @return VK_SUCCESS if successful VK_ERROR_UNKNOWN an internal error occurred and image memory allocation
+ * was not found in its proper pool.
+ */
+JVM_API
+VkResult jvm_image_destroy(jvm_image_allocation* image_allocation);
+
+/**
+ * Destroys an image allocation once the device no longer uses it. The allocation handle becomes invalid immediately,
+ * but the image and its device memory are only released once jvm_allocator_report_progress is called with a value
+ * equal to or greater than retire_value.
+ * @param image_allocation Image allocation to free.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the image.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
+ */
+JVM_API
+VkResult jvm_image_destroy_deferred(jvm_image_allocation* image_allocation, uint64_t retire_value);
+
+/**
+ * Attempts to map a provided image allocation to host memory. Behaviour depends on the memory flags from which it was
+ * allocated.
+ * @param image_allocation Image allocation to map.
+ * @param p_size Pointer which receives the size of the mapped region.
+ * @param p_out Pointer which receives the pointer to the mapped memory.
+ * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if chunk is already mapped, return value of vkMapMemory
+ * if that fails, or the return value of vkFlushMappedMemoryRanges if that needed to be called and failed.
+ */
+JVM_API
+VkResult jvm_image_map(jvm_image_allocation* image_allocation, size_t* p_size, void** p_out);
+
+/**
+ * Attempts to unmap a provided image allocation to host memory. Behaviour depends on the memory flags from which it was
+ * allocated.
+ * @param image_allocation Image allocation to unmap.
+ * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if the chunk was not mapped before, or the return value
+ * of vkInvalidateMappedMemoryRanges if that fails.
+ */
+JVM_API
+VkResult jvm_image_unmap(jvm_image_allocation* image_allocation);
+
+/**
+ * Flushes mapped image to ensure changes made to it on the host are visible to the device.
+ * @param image_allocation Mapped image allocation to flush.
+ * @return VK_SUCCESS if successful, or return value of vkFlushMappedMemoryRanges if it fails.
+ */
+JVM_API
+VkResult jvm_image_mapped_flush(jvm_image_allocation* image_allocation);
+
+/**
+ * Invalidates mapped image to ensure changes made to it from the device are visible to the host.
+ * @param image_allocation Mapped image allocation to invalidate.
+ * @return VK_SUCCESS if successful, or return value of vkInvalidateMappedMemoryRanges if it fails.
+ */
+JVM_API
+VkResult jvm_image_mapped_invalidate(jvm_image_allocation* image_allocation);
+
+/**
+ * Returns the Vulkan handle to the image.
+ * @param image_allocation Image allocation to get the handle from.
+ * @return Handle to the image.
+ */
+JVM_API
+VkImage jvm_image_allocation_get_image(jvm_image_allocation* image_allocation);
+
+/**
+ * Returns the allocator with which the image was allocated.
+ * @param image_allocation Image allocation to get the allocator from.
+ * @return Handle to the allocator.
+ */
+JVM_API
+jvm_allocator* jvm_image_allocation_get_allocator(jvm_image_allocation* image_allocation);
+
+/**
+ * Returns the useful size of the image in bytes.
+ * @param image_allocation Image allocation to get the size of.
+ * @return Useful size of the allocation.
+ */
+JVM_API
+VkExtent3D jvm_image_allocation_get_extent(jvm_image_allocation* image_allocation);
+
+/**
+ * Returns property flags of the memory type the image's memory was allocated from.
+ * @param image_allocation Image allocation to get the memory flags of.
+ * @return Property flags of the memory type.
+ */
+JVM_API
+VkMemoryPropertyFlags jvm_image_allocation_get_memory_flags(jvm_image_allocation* image_allocation);
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          Memory related functions
+ *
+ *
+ **********************************************************************************************************************/
+
+/**
+ * Allocates memory for a buffer which was created by the caller, for example with a pNext chain the allocator does not
+ * know about. Memory comes from the same pools as memory of buffers created with jvm_buffer_create2, but is not bound.
+ * @param allocator Allocator to use.
+ * @param buffer Buffer to allocate memory for.
+ * @param allocation_info Parameters of the allocation.
+ * @param p_out Pointer which receives the memory allocation handle.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_DEVICE_MEMORY if there was not enough device memory,
+ * VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
+ */
+JVM_API
+VkResult jvm_allocate_for_buffer(
+        jvm_allocator* allocator, VkBuffer buffer, const jvm_allocation_create_info* allocation_info,
+        jvm_memory_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Allocates memory for an image which was created by the caller. Memory comes from the same pools as memory of images
+ * created with jvm_image_create2, but is not bound.
+ * @param allocator Allocator to use.
+ * @param image Image to allocate memory for.
+ * @param tiling Tiling the image was created with.
+ * @param allocation_info Parameters of the allocation.
+ * @param p_out Pointer which receives the memory allocation handle.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_DEVICE_MEMORY if there was not enough device memory,
+ * VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
+ */
+JVM_API
+VkResult jvm_allocate_for_image(
+        jvm_allocator* allocator, VkImage image, VkImageTiling tiling, const jvm_allocation_create_info* allocation_info,
+        jvm_memory_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Binds memory allocations to the buffers they were allocated for. All of them are bound with as few calls to
+ * vkBindBufferMemory2 as possible, or one by one with vkBindBufferMemory if it is not available.
+ * @param allocator Allocator the memory was allocated with.
+ * @param count Number of buffers to bind.
+ * @param allocations Array of count memory allocations.
+ * @param buffers Array of count buffers, each of which is bound to the allocation at the same index.
+ * @return VK_SUCCESS if successful, otherwise the error returned by Vulkan.
+ */
+JVM_API
+VkResult jvm_bind_buffer_memory(
+        jvm_allocator* allocator, uint32_t count, jvm_memory_allocation* const* allocations, const VkBuffer* buffers);
+
+/**
+ * Binds memory allocations to the images they were allocated for. All of them are bound with as few calls to
+ * vkBindImageMemory2 as possible, or one by one with vkBindImageMemory if it is not available.
+ * @param allocator Allocator the memory was allocated with.
+ * @param count Number of images to bind.
+ * @param allocations Array of count memory allocations.
+ * @param images Array of count images, each of which is bound to the allocation at the same index.
+ * @return VK_SUCCESS if successful, otherwise the error returned by Vulkan.
+ */
+JVM_API
+VkResult jvm_bind_image_memory(
+        jvm_allocator* allocator, uint32_t count, jvm_memory_allocation* const* allocations, const VkImage* images);
+
+/**
+ * Returns memory to its pool. The resource it was bound to must already be destroyed by the caller.
+ * @param memory_allocation Memory allocation to free.
+ * @return VK_SUCCESS if successful VK_ERROR_UNKNOWN an internal error occurred and the memory was not found in its
+ * proper pool.
+ */
+JVM_API
+VkResult jvm_memory_free(jvm_memory_allocation* memory_allocation);
+
+/**
+ * Returns memory to its pool once the device no longer uses it. The allocation handle becomes invalid immediately, but
+ * the memory is only returned once jvm_allocator_report_progress is called with a value equal to or greater than
+ * retire_value.
+ * @param memory_allocation Memory allocation to free.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the memory.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
+ */
+JVM_API
+VkResult jvm_memory_free_deferred(jvm_memory_allocation* memory_allocation, uint64_t retire_value);
+
+/**
+ * Maps memory to host memory. Memory must be host-visible.
+ * @param memory_allocation Memory allocation to map.
+ * @param p_size Receives the size of the mapped memory.
+ * @param p_out Receives pointer to mapped memory.
+ * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if it is already mapped, otherwise the error returned
+ * by vkMapMemory.
+ */
+JVM_API
+VkResult jvm_memory_map(jvm_memory_allocation* memory_allocation, size_t* p_size, void** p_out);
+
+/**
+ * Unmaps memory from host memory.
+ * @param memory_allocation Memory allocation to unmap.
+ * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if it was not mapped.
+ */
+JVM_API
+VkResult jvm_memory_unmap(jvm_memory_allocation* memory_allocation);
+
+/**
+ * Flushes host writes to mapped memory, so that the device sees them.
+ * @param memory_allocation Memory allocation to flush.
+ * @return Result of vkFlushMappedMemoryRanges.
+ */
+JVM_API
+VkResult jvm_memory_mapped_flush(jvm_memory_allocation* memory_allocation);
+
+/**
+ * Invalidates mapped memory, so that the host sees device writes.
+ * @param memory_allocation Memory allocation to invalidate.
+ * @return Result of vkInvalidateMappedMemoryRanges.
+ */
+JVM_API
+VkResult jvm_memory_mapped_invalidate(jvm_memory_allocation* memory_allocation);
+
+/**
+ * Returns the Vulkan memory handle the allocation is in, which is shared with other allocations.
+ * @param memory_allocation Memory allocation to get the handle from.
+ * @return Handle to the memory.
+ */
+JVM_API
+VkDeviceMemory jvm_memory_allocation_get_memory(jvm_memory_allocation* memory_allocation);
+
+/**
+ * Returns the offset of the allocation within its Vulkan memory, which is where the resource is bound.
+ * @param memory_allocation Memory allocation to get the offset of.
+ * @return Offset of the allocation.
+ */
+JVM_API
+VkDeviceSize jvm_memory_allocation_get_offset(jvm_memory_allocation* memory_allocation);
+
+/**
+ * Returns the size the resource the memory was allocated for requires.
+ * @param memory_allocation Memory allocation to get the size of.
+ * @return Size of the allocation.
+ */
+JVM_API
+VkDeviceSize jvm_memory_allocation_get_size(jvm_memory_allocation* memory_allocation);
+
+/**
+ * Returns property flags of the memory type the memory was allocated from.
+ * @param memory_allocation Memory allocation to get the memory flags of.
+ * @return Property flags of the memory type.
+ */
+JVM_API
+VkMemoryPropertyFlags jvm_memory_allocation_get_memory_flags(jvm_memory_allocation* memory_allocation);
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          External memory related functions
+ *
+ *
+ **********************************************************************************************************************/
+
+/**
+ * Exports memory of the buffer as a file descriptor. The buffer must have been allocated with
+ * jvm_allocation_create_info::export_handle_types including handle_type. The whole memory the buffer is in is exported,
+ * so the offset of the buffer within it is returned too.
+ * @param buffer_allocation Buffer allocation to export.
+ * @param handle_type Handle type of the file descriptor.
+ * @param p_out Receives the file descriptor and what is needed to import it. The caller owns the file descriptor.
+ * @return VK_SUCCESS if successful, VK_ERROR_INVALID_EXTERNAL_HANDLE if the memory can not be exported as handle_type,
+ * otherwise the error returned by vkGetMemoryFdKHR.
+ */
+JVM_API
+VkResult jvm_buffer_export_fd(
+        jvm_buffer_allocation* buffer_allocation, VkExternalMemoryHandleTypeFlagBits handle_type,
+        jvm_external_memory_info* p_out);
+
+/**
+ * Exports memory of the image as a file descriptor. The image must have been allocated with
+ * jvm_allocation_create_info::export_handle_types including handle_type. The whole memory the image is in is exported,
+ * so the offset of the image within it is returned too.
+ * @param image_allocation Image allocation to export.
+ * @param handle_type Handle type of the file descriptor.
+ * @param p_out Receives the file descriptor and what is needed to import it. The caller owns the file descriptor.
+ * @return VK_SUCCESS if successful, VK_ERROR_INVALID_EXTERNAL_HANDLE if the memory can not be exported as handle_type,
+ * otherwise the error returned by vkGetMemoryFdKHR.
+ */
+JVM_API
+VkResult jvm_image_export_fd(
+        jvm_image_allocation* image_allocation, VkExternalMemoryHandleTypeFlagBits handle_type,
+        jvm_external_memory_info* p_out);
+
+/**
+ * Creates a buffer bound to memory imported from a file descriptor. The memory is not shared with other allocations,
+ * and is released when the buffer is destroyed.
+ * @param allocator Allocator to use.
+ * @param create_info Information to create the buffer with. It must chain VkExternalMemoryBufferCreateInfo with the
+ * handle type of the memory.
+ * @param memory Memory to import, as returned by jvm_buffer_export_fd in the exporting process.
+ * @param p_out Pointer which receives the buffer allocation handle.
+ * @return VK_SUCCESS if successful, VK_ERROR_INVALID_EXTERNAL_HANDLE if the memory can not hold the buffer or be imported,
+ * VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory. The file descriptor is consumed as
+ * soon as vkAllocateMemory imports it, even if creating the buffer fails afterwards, such as when host memory runs out
+ * or the memory can not be bound. The caller keeps ownership of it for errors before that.
+ */
+JVM_API
+VkResult jvm_buffer_import_fd(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, const jvm_external_memory_info* memory,
+        jvm_buffer_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Creates an image bound to memory imported from a file descriptor. The memory is not shared with other allocations,
+ * and is released when the image is destroyed.
+ * @param allocator Allocator to use.
+ * @param create_info Information to create the image with. It must chain VkExternalMemoryImageCreateInfo with the
+ * handle type of the memory.
+ * @param memory Memory to import, as returned by jvm_image_export_fd in the exporting process.
+ * @param p_out Pointer which receives the image allocation handle.
+ * @return VK_SUCCESS if successful, VK_ERROR_INVALID_EXTERNAL_HANDLE if the memory can not hold the image or be imported,
+ * VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory. The file descriptor is consumed as
+ * soon as vkAllocateMemory imports it, even if creating the image fails afterwards, such as when host memory runs out
+ * or the memory can not be bound. The caller keeps ownership of it for errors before that.
+ */
+JVM_API
+VkResult jvm_image_import_fd(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, const jvm_external_memory_info* memory,
+        jvm_image_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Creates a buffer which uses host memory the caller already has, such as a memory mapped file, as its memory without
+ * copying it. The range is widened to VkPhysicalDeviceExternalMemoryHostPropertiesEXT::minImportedHostPointerAlignment
+ * on both sides, and all of the widened range must be mapped. The buffer is created with
+ * VkExternalMemoryBufferCreateInfo chained in front of create_info's own chain. Memory is not shared with other
+ * allocations, and the host memory must stay mapped until the buffer is destroyed.
+ * @param allocator Allocator to use.
+ * @param create_info Information to create the buffer with. Usually it is used as a transfer source.
+ * @param host_pointer Pointer to the first byte of the buffer. It must be aligned to the buffer's memory requirements,
+ * which is always the case for the start of a mapped file.
+ * @param p_out Pointer which receives the buffer allocation handle.
+ * @return VK_SUCCESS if successful, VK_ERROR_INVALID_EXTERNAL_HANDLE if the host memory can not be imported for the
+ * buffer, VK_ERROR_FEATURE_NOT_PRESENT if jvm_allocator_create_info::external_memory_host was not set,
+ * VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
+ */
+JVM_API
+VkResult jvm_buffer_create_from_host_pointer(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, const void* host_pointer,
+        jvm_buffer_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          Aliasing related functions
+ *
+ *
+ **********************************************************************************************************************/
+
+/**
+ * Creates a group of buffers and images which are not all alive at the same time, so that they can share memory.
+ * Resources are packed into a single allocation, largest first, each at the lowest offset where it does not overlap
+ * any other resource whose lifetime overlaps its own. Contents of aliased resources are not preserved between uses.
+ * @param allocator Allocator to use for the allocation.
+ * @param resource_count Number of resources in the group.
+ * @param resources Array of resource_count descriptions of resources in the group.
+ * @param desired_flags Flags that are desired for the group's memory to have.
+ * @param undesired_flags Flags that the memory should not have.
+ * @param p_out Pointer to receive the created aliasing group.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory,
+ * VK_ERROR_OUT_OF_DEVICE_MEMORY if the resources have no memory type in common, or the return value of vkCreateBuffer,
+ * vkCreateImage, vkBindBufferMemory, or vkBindImageMemory if that fails.
+ */
+JVM_API
+VkResult jvm_aliasing_group_create(
+        jvm_allocator* allocator, uint32_t resource_count, const jvm_aliased_resource_info* resources,
+        VkMemoryPropertyFlags desired_flags, VkMemoryPropertyFlags undesired_flags, jvm_aliasing_group** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Destroys all resources of an aliasing group and returns their memory to its pool.
+ * @param aliasing_group Aliasing group to destroy.
+ */
+JVM_API
+void jvm_aliasing_group_destroy(jvm_aliasing_group* aliasing_group);
+
+/**
+ * Destroys all resources of an aliasing group once the device no longer uses them, the same way as
+ * jvm_buffer_destroy_deferred does.
+ * @param aliasing_group Aliasing group to destroy.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the group.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, in which
+ * case the group is not destroyed.
+ */
+JVM_API
+VkResult jvm_aliasing_group_destroy_deferred(jvm_aliasing_group* aliasing_group, uint64_t retire_value);
+
+/**
+ * Returns the Vulkan handle to a buffer in the aliasing group.
+ * @param aliasing_group Aliasing group to get the handle from.
+ * @param index Index of the resource, in the order they were given to jvm_aliasing_group_create.
+ * @return Handle to the buffer, or VK_NULL_HANDLE if the resource is not a buffer.
+ */
+JVM_API
+VkBuffer jvm_aliasing_group_get_buffer(jvm_aliasing_group* aliasing_group, uint32_t index);
+
+/**
+ * Returns the Vulkan handle to an image in the aliasing group.
+ * @param aliasing_group Aliasing group to get the handle from.
+ * @param index Index of the resource, in the order they were given to jvm_aliasing_group_create.
+ * @return Handle to the image, or VK_NULL_HANDLE if the resource is not an image.
+ */
+JVM_API
+VkImage jvm_aliasing_group_get_image(jvm_aliasing_group* aliasing_group, uint32_t index);
+
+/**
+ * Returns how much memory all resources of the aliasing group need together.
+ * @param aliasing_group Aliasing group to get the size of.
+ * @return Size of the group's memory.
+ */
+JVM_API
+VkDeviceSize jvm_aliasing_group_get_size(jvm_aliasing_group* aliasing_group);
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          Upload related functions
+ *
+ *
+ **********************************************************************************************************************/
+
+/**
+ * Creates an uploader with a persistently mapped staging ring. Space in the ring is taken by uploads and given back once
+ * the device is done with the copies which read from it, as reported by jvm_uploader_report_progress.
+ * @param allocator Allocator to use for the staging ring.
+ * @param ring_size Size of the staging ring in bytes. No single upload can be larger than this.
+ * @param p_out Pointer to receive the created uploader.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, or the
+ * return value of jvm_buffer_create or jvm_buffer_map if that fails.
+ */
+JVM_API
+VkResult jvm_uploader_create(jvm_allocator* allocator, VkDeviceSize ring_size, jvm_uploader** p_out);
+
+/**
+ * Destroys the uploader. Uploads which were not yet recorded are discarded. If recorded copies may still be executing,
+ * the staging ring is destroyed once the allocator is given the retire value of the last recording through
+ * jvm_allocator_report_progress.
+ * @param uploader Uploader to destroy.
+ */
+JVM_API
+void jvm_uploader_destroy(jvm_uploader* uploader);
 
-    /**
-     * Allocation callbacks to use. If set to NULL, default allocators (using malloc, realloc, and free) are used.
-     */
-    const jvm_allocation_callbacks* allocation_callbacks;
+/**
+ * Uploads data to a buffer. If the buffer's memory is host-visible, as is the case on devices with unified memory, the
+ * data is written immediately, so the device must not be using the buffer. Otherwise the data is copied to the staging
+ * ring and the copy is recorded by the next call to jvm_uploader_record.
+ * @param uploader Uploader to use.
+ * @param buffer_allocation Buffer to upload to.
+ * @param offset Offset in the buffer at which the data is put.
+ * @param data Data to upload.
+ * @param size Size of the data in bytes.
+ * @return VK_SUCCESS if successful, VK_NOT_READY if the staging ring currently has no space for the data, in which
+ * case pending uploads should be recorded and the device's progress reported before trying again,
+ * VK_ERROR_OUT_OF_DEVICE_MEMORY if the data is larger than the staging ring, VK_ERROR_OUT_OF_HOST_MEMORY if it can not
+ * allocate required host memory, or VK_ERROR_UNKNOWN if the data does not fit into the buffer.
+ */
+JVM_API
+VkResult jvm_uploader_upload_buffer(
+        jvm_uploader* uploader, jvm_buffer_allocation* buffer_allocation, VkDeviceSize offset, const void* data,
+        VkDeviceSize size);
 
-    /**
-     * Error callbacks to use. If set to NULL, default callback (which uses fprintf to write to stderr) is used.
-     */
-    const jvm_error_callbacks* error_callbacks;
+/**
+ * Uploads tightly packed texels to a region of an image. The data is copied to the staging ring and the copy is recorded
+ * by the next call to jvm_uploader_record. The data is staged at an offset which is a multiple of the texel block size
+ * of the image's format.
+ * @param uploader Uploader to use.
+ * @param image_allocation Image to upload to.
+ * @param layout Layout the image will be in when the copy is executed.
+ * @param subresource Subresource of the image to upload to.
+ * @param offset Offset of the region in texels.
+ * @param extent Extent of the region in texels.
+ * @param data Texel data to upload.
+ * @param size Size of the data in bytes.
+ * @return Same as jvm_uploader_upload_buffer, except that bounds are not checked, and VK_ERROR_FORMAT_NOT_SUPPORTED if
+ * the texel block size of the image's format is not known.
+ */
+JVM_API
+VkResult jvm_uploader_upload_image(
+        jvm_uploader* uploader, jvm_image_allocation* image_allocation, VkImageLayout layout,
+        VkImageSubresourceLayers subresource, VkOffset3D offset, VkExtent3D extent, const void* data, VkDeviceSize size);
 
-    /**
-     * Vulkan logical device interface to use.
-     */
-    VkDevice device;
+/**
+ * Records copies of all pending uploads into a command buffer. Consecutive uploads to the same buffer or image are
+ * batched into a single copy command. Synchronization of the copies with other commands is left to the caller.
+ * @param uploader Uploader to record copies of.
+ * @param command_buffer Command buffer in the recording state to record copies to.
+ * @param retire_value Timeline value or frame index after which the command buffer is done executing.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, or the
+ * return value of vkFlushMappedMemoryRanges if that fails.
+ */
+JVM_API
+VkResult jvm_uploader_record(jvm_uploader* uploader, VkCommandBuffer command_buffer, uint64_t retire_value);
 
-    /**
-     * Physical Vulkan device to which the jvm_allocator_create_info::device corresponds to.
-     */
-    VkPhysicalDevice physical_device;
-};
+/**
+ * Reports how far the device has progressed, so that staging ring space used by copies recorded with a retire value
+ * less than or equal to completed_value can be used again.
+ * @param uploader Uploader to report progress to.
+ * @param completed_value Value which the device has reached.
+ */
+JVM_API
+void jvm_uploader_report_progress(jvm_uploader* uploader, uint64_t completed_value);
 
 
 /***********************************************************************************************************************
  *
  *
- *                                          Allocator functions
+ *                                          Readback related functions
  *
  *
  **********************************************************************************************************************/
 
 /**
- * Creates a new Vulkan memory allocator.
- * @param create_info Struct which contains most of the creation parameters.
- * @param vk_allocation_callbacks Pointer to allocators to use for vulkan function calls. May be left NULL.
- * @param p_out Pointer which receives the created allocator.
- * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
+ * Creates a readback ring. Its memory is host-cached when the device has such a memory type, so that reads from it are
+ * fast. Space in the ring is given out as slots, which are given back in order once they are released.
+ * @param allocator Allocator to use for the ring.
+ * @param ring_size Size of the ring in bytes. No single readback can be larger than this.
+ * @param p_out Pointer to receive the created readback ring.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, or the
+ * return value of jvm_buffer_create or jvm_buffer_map if that fails.
  */
 JVM_API
-VkResult jvm_allocator_create(
-        jvm_allocator_create_info create_info, const VkAllocationCallbacks* vk_allocation_callbacks,
-        jvm_allocator** p_out);
+VkResult jvm_readback_create(jvm_allocator* allocator, VkDeviceSize ring_size, jvm_readback** p_out);
 
 /**
- * Destroys the provided Vulkan memory allocator, unmapping and freeing any associated memory. Will report an error for
- * each still unfree-d block.
- * @param allocator Allocator to destroy.
+ * Destroys the readback ring. All slots are released. If copies may still be executing, the ring is destroyed once the
+ * allocator is given the retire value of the last copy through jvm_allocator_report_progress.
+ * @param readback Readback ring to destroy.
  */
 JVM_API
-void jvm_allocator_destroy(jvm_allocator* allocator);
+void jvm_readback_destroy(jvm_readback* readback);
 
 /**
- * Frees unused memory pools. On allocators created with jvm_allocator_create_info::automatically_free_unused set to
- * non-zero, this does noting when not on debug build. On debug build, it will report any unfree-d pools as internal
- * errors
- * @param allocator Allocator for which to free unused pools.
+ * Takes a slot from the ring and records a copy of a buffer region to it. Synchronization of the copy with other
+ * commands is left to the caller.
+ * @param readback Readback ring to use.
+ * @param command_buffer Command buffer in the recording state to record the copy to.
+ * @param buffer_allocation Buffer to read from.
+ * @param offset Offset of the region in the buffer.
+ * @param size Size of the region in bytes.
+ * @param retire_value Timeline value or frame index after which the command buffer is done executing.
+ * @param p_slot Pointer to receive the slot handle.
+ * @return VK_SUCCESS if successful, VK_NOT_READY if the ring currently has no space for the data, in which case slots
+ * should be released before trying again, VK_ERROR_OUT_OF_DEVICE_MEMORY if the region is larger than the ring,
+ * VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, or VK_ERROR_UNKNOWN if the region is out of
+ * bounds of the buffer.
  */
 JVM_API
-void jvm_allocator_free_unused(jvm_allocator* allocator);
+VkResult jvm_readback_read_buffer(
+        jvm_readback* readback, VkCommandBuffer command_buffer, jvm_buffer_allocation* buffer_allocation,
+        VkDeviceSize offset, VkDeviceSize size, uint64_t retire_value, jvm_readback_slot* p_slot);
+
+/**
+ * Takes a slot from the ring and records a copy of an image region to it, with texels tightly packed. The slot starts at
+ * an offset which is a multiple of the texel block size of the image's format.
+ * @param readback Readback ring to use.
+ * @param command_buffer Command buffer in the recording state to record the copy to.
+ * @param image_allocation Image to read from.
+ * @param layout Layout the image will be in when the copy is executed.
+ * @param subresource Subresource of the image to read from.
+ * @param offset Offset of the region in texels.
+ * @param extent Extent of the region in texels.
+ * @param size Size of the region's texel data in bytes.
+ * @param retire_value Timeline value or frame index after which the command buffer is done executing.
+ * @param p_slot Pointer to receive the slot handle.
+ * @return Same as jvm_readback_read_buffer, except that bounds are not checked, and VK_ERROR_FORMAT_NOT_SUPPORTED if the
+ * texel block size of the image's format is not known.
+ */
+JVM_API
+VkResult jvm_readback_read_image(
+        jvm_readback* readback, VkCommandBuffer command_buffer, jvm_image_allocation* image_allocation,
+        VkImageLayout layout, VkImageSubresourceLayers subresource, VkOffset3D offset, VkExtent3D extent,
+        VkDeviceSize size, uint64_t retire_value, jvm_readback_slot* p_slot);
+
+/**
+ * Reports how far the device has progressed, which makes slots with a retire value less than or equal to
+ * completed_value ready. If the ring's memory is not host-coherent, all such slots are invalidated with a single call
+ * to vkInvalidateMappedMemoryRanges.
+ * @param readback Readback ring to report progress to.
+ * @param completed_value Value which the device has reached.
+ * @return VK_SUCCESS if successful, or the return value of vkInvalidateMappedMemoryRanges if that fails.
+ */
+JVM_API
+VkResult jvm_readback_report_progress(jvm_readback* readback, uint64_t completed_value);
+
+/**
+ * Returns a pointer to the data of a slot, if it is ready.
+ * @param readback Readback ring the slot is from.
+ * @param slot Slot to get the data of.
+ * @param p_size Pointer which receives the size of the data. May be NULL.
+ * @return Pointer to the data, which is valid until the slot is released, or NULL if the slot is not yet ready.
+ */
+JVM_API
+const void* jvm_readback_get_data(jvm_readback* readback, jvm_readback_slot slot, VkDeviceSize* p_size);
+
+/**
+ * Releases a slot, so that its space may be used again once all older slots are released as well.
+ * @param readback Readback ring the slot is from.
+ * @param slot Slot to release.
+ */
+JVM_API
+void jvm_readback_release(jvm_readback* readback, jvm_readback_slot slot);
 
 
 /***********************************************************************************************************************
  *
  *
- *                                          Buffer related functions
+ *                                          Sparse residency related functions
  *
  *
  **********************************************************************************************************************/
+
 /**
- * Creates a new buffer using vkCreateBuffer and binds the correct memory to it.
- * @param allocator Allocator to use for the allocation.
- * @param create_info Buffer creation info passed to vkCreateBuffer.
- * @param desired_flags Flags that are desired for the buffer memory to have. This is in addition to flags required
- * by the buffer.
- * @param undesired_flags Flags that the memory should not have. If these conflict with buffer required memory flags,
- * it will cause the function to fail with VK_ERROR_OUT_OF_DEVICE_MEMORY.
- * @param dedicated If non-zero, the allocation is made for this buffer only.
- * @param p_out Pointer to receive the create allocation.
+ * Creates a sparse buffer with no resident pages. Pages are the size of the buffer's sparse block and are allocated from
+ * pools which only hold pages of sparse resources. Making pages resident or evicting them only changes what is bound
+ * once jvm_sparse_submit is called.
+ * @param allocator Allocator to use for the buffer's pages.
+ * @param create_info Creation info of the buffer, which must include VK_BUFFER_CREATE_SPARSE_BINDING_BIT.
+ * @param allocation_info Parameters which determine the memory type of the pages. Dedicated and strategy are ignored.
+ * @param p_out Pointer to receive the created sparse buffer.
  * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory,
- * return value of vkCreateBuffer if that fails, VK_ERROR_OUT_OF_DEVICE_MEMORY if undesired_flags conflict with flags
- * required by the buffer, return value of vkBindBufferMemory if that fails.
+ * VK_ERROR_OUT_OF_DEVICE_MEMORY if no memory type is suitable, VK_ERROR_UNKNOWN if the buffer is not sparse, or the
+ * return value of vkCreateBuffer if that fails.
  */
 JVM_API
-VkResult jvm_buffer_create(
-        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, VkMemoryPropertyFlags desired_flags,
-        VkMemoryPropertyFlags undesired_flags, VkBool32 dedicated, jvm_buffer_allocation** p_out
+VkResult jvm_sparse_buffer_create(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info,
+        const jvm_allocation_create_info* allocation_info, jvm_sparse_buffer** p_out
 #ifdef JVM_TRACK_ALLOCATIONS
         ,const char* file, int line
 #endif
 );
 
 /**
- * Destroys a buffer allocation, destroying the buffer and returning its device memory to its pool.
- * @param buffer_allocation Buffer allocation to free.
- * @return VK_SUCCESS if successful VK_ERROR_UNKNOWN an internal error occurred and buffer memory allocation
- * was not found in its proper pool.
+ * Destroys the sparse buffer and returns memory of its resident pages right away. Pages which were evicted are still
+ * returned once their retire value is reached.
+ * @param sparse_buffer Sparse buffer to destroy.
  */
 JVM_API
-VkResult jvm_buffer_destroy(jvm_buffer_allocation* buffer_allocation);
+void jvm_sparse_buffer_destroy(jvm_sparse_buffer* sparse_buffer);
 
 /**
- * Attempts to map a provided buffer allocation to host memory. Behaviour depends on the memory flags from which it was
- * allocated.
- * @param buffer_allocation Buffer allocation to map.
- * @param p_size Pointer which receives the size of the mapped region.
- * @param p_out pointer which receives the pointer to the mapped memory.
- * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if chunk is already mapped, return value of vkMapMemory
- * if that fails, or the return value of vkFlushMappedMemoryRanges if that needed to be called and failed.
+ * Destroys the sparse buffer and returns memory of its resident pages once the device no longer uses them, the same
+ * way as jvm_buffer_destroy_deferred does.
+ * @param sparse_buffer Sparse buffer to destroy.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the buffer.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, in which
+ * case the buffer is not destroyed.
  */
 JVM_API
-VkResult jvm_buffer_map(jvm_buffer_allocation* buffer_allocation, size_t* p_size, void** p_out);
+VkResult jvm_sparse_buffer_destroy_deferred(jvm_sparse_buffer* sparse_buffer, uint64_t retire_value);
 
 /**
- * Attempts to unmap a provided buffer allocation to host memory. Behaviour depends on the memory flags from which it was
- * allocated.
- * @param buffer_allocation Buffer allocation to unmap.
- * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if the chunk was not mapped before, or the return value
- * of vkInvalidateMappedMemoryRanges if that fails.
+ * Allocates memory for all pages which the range of the buffer touches and are not yet resident. They are bound by the
+ * next call to jvm_sparse_submit. If allocation fails part way, pages allocated before that stay resident.
+ * @param sparse_buffer Sparse buffer to make resident.
+ * @param offset Offset of the range in the buffer.
+ * @param size Size of the range in bytes.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory,
+ * VK_ERROR_UNKNOWN if the range is out of bounds of the buffer, or the return value of vkAllocateMemory if that fails.
  */
 JVM_API
-VkResult jvm_buffer_unmap(jvm_buffer_allocation* buffer_allocation);
+VkResult jvm_sparse_buffer_make_resident(jvm_sparse_buffer* sparse_buffer, VkDeviceSize offset, VkDeviceSize size);
 
 /**
- * Flushes mapped buffer to ensure changes made to it on the host are visible to the device.
- * @param buffer_allocation Mapped buffer allocation to flush.
- * @return VK_SUCCESS if successful, or return value of vkFlushMappedMemoryRanges if it fails.
+ * Evicts all resident pages which the range of the buffer touches. They are unbound by the next call to
+ * jvm_sparse_submit, and their memory is returned once the allocator is given the retire value through
+ * jvm_allocator_report_progress, which must thus come after the unbind and any use of the pages before it.
+ * @param sparse_buffer Sparse buffer to evict pages of.
+ * @param offset Offset of the range in the buffer.
+ * @param size Size of the range in bytes.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the pages.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, or
+ * VK_ERROR_UNKNOWN if the range is out of bounds of the buffer.
  */
 JVM_API
-VkResult jvm_buffer_mapped_flush(jvm_buffer_allocation* buffer_allocation);
+VkResult jvm_sparse_buffer_evict(
+        jvm_sparse_buffer* sparse_buffer, VkDeviceSize offset, VkDeviceSize size, uint64_t retire_value);
 
 /**
- * Invalidates mapped buffer to ensure changes made to it from the device are visible to the host.
- * @param buffer_allocation Mapped buffer allocation to invalidate.
- * @return VK_SUCCESS if successful, or return value of vkInvalidateMappedMemoryRanges if it fails.
+ * Returns the Vulkan handle to the sparse buffer.
+ * @param sparse_buffer Sparse buffer to get the handle from.
+ * @return Handle to the buffer.
  */
 JVM_API
-VkResult jvm_buffer_mapped_invalidate(jvm_buffer_allocation* buffer_allocation);
+VkBuffer jvm_sparse_buffer_get_buffer(jvm_sparse_buffer* sparse_buffer);
 
 /**
- * Returns the Vulkan handle to the buffer.
- * @param buffer_allocation Buffer allocation to get the handle from.
- * @return Handle to the buffer.
+ * Returns the size of a single page of the sparse buffer, at which granularity it is made resident and evicted.
+ * @param sparse_buffer Sparse buffer to get the page size of.
+ * @return Size of a page in bytes.
  */
 JVM_API
-VkBuffer jvm_buffer_allocation_get_buffer(jvm_buffer_allocation* buffer_allocation);
+VkDeviceSize jvm_sparse_buffer_get_page_size(jvm_sparse_buffer* sparse_buffer);
 
 /**
- * Returns the allocator with which the buffer was allocated.
- * @param buffer_allocation Buffer allocation to get the allocator from.
- * @return Handle to the allocator.
+ * Returns how much memory resident pages of the sparse buffer take up.
+ * @param sparse_buffer Sparse buffer to get the resident size of.
+ * @return Size of all resident pages in bytes.
  */
 JVM_API
-jvm_allocator* jvm_buffer_allocation_get_allocator(jvm_buffer_allocation* buffer_allocation);
+VkDeviceSize jvm_sparse_buffer_get_resident_size(jvm_sparse_buffer* sparse_buffer);
 
 /**
- * Returns the useful size of the buffer in bytes.
- * @param buffer_allocation Buffer allocation to get the size of.
- * @return Useful size of the allocation.
+ * Creates a sparse image with no resident tiles. Its mip tail and metadata, if any, are allocated right away and stay
+ * resident for its whole lifetime. Only images with a single aspect bound tile by tile (besides metadata) are supported,
+ * so depth/stencil formats with separately bound aspects are not.
+ * @param allocator Allocator to use for the image's tiles.
+ * @param create_info Creation info of the image, which must include VK_IMAGE_CREATE_SPARSE_BINDING_BIT and
+ * VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT.
+ * @param allocation_info Parameters which determine the memory type of the tiles. Dedicated and strategy are ignored.
+ * @param p_out Pointer to receive the created sparse image.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory,
+ * VK_ERROR_OUT_OF_DEVICE_MEMORY if no memory type is suitable, VK_ERROR_FORMAT_NOT_SUPPORTED if the image has more
+ * than one aspect bound tile by tile, VK_ERROR_UNKNOWN if the image is not sparse resident, or the return value of
+ * vkCreateImage or vkAllocateMemory if that fails.
  */
 JVM_API
-VkDeviceSize jvm_buffer_allocation_get_size(jvm_buffer_allocation* buffer_allocation);
+VkResult jvm_sparse_image_create(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info,
+        const jvm_allocation_create_info* allocation_info, jvm_sparse_image** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+/**
+ * Destroys the sparse image and returns memory of its resident tiles, mip tail, and metadata right away, the same way as
+ * jvm_sparse_buffer_destroy does.
+ * @param sparse_image Sparse image to destroy.
+ */
+JVM_API
+void jvm_sparse_image_destroy(jvm_sparse_image* sparse_image);
+
+/**
+ * Destroys the sparse image once the device no longer uses it, the same way as jvm_sparse_buffer_destroy_deferred does.
+ * @param sparse_image Sparse image to destroy.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the image.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, in which
+ * case the image is not destroyed.
+ */
+JVM_API
+VkResult jvm_sparse_image_destroy_deferred(jvm_sparse_image* sparse_image, uint64_t retire_value);
+
+/**
+ * Allocates memory for all tiles which the region of the image touches and are not yet resident, the same way as
+ * jvm_sparse_buffer_make_resident does. Regions in the mip tail are always resident.
+ * @param sparse_image Sparse image to make resident.
+ * @param subresource Mip level and array layer of the region. The aspect is ignored.
+ * @param offset Offset of the region in texels.
+ * @param extent Extent of the region in texels.
+ * @return Same as jvm_sparse_buffer_make_resident.
+ */
+JVM_API
+VkResult jvm_sparse_image_make_resident(
+        jvm_sparse_image* sparse_image, VkImageSubresource subresource, VkOffset3D offset, VkExtent3D extent);
+
+/**
+ * Evicts all resident tiles which the region of the image touches, the same way as jvm_sparse_buffer_evict does.
+ * @param sparse_image Sparse image to evict tiles of.
+ * @param subresource Mip level and array layer of the region. The aspect is ignored.
+ * @param offset Offset of the region in texels.
+ * @param extent Extent of the region in texels.
+ * @param retire_value Timeline semaphore value or frame index after which the device no longer uses the tiles.
+ * @return Same as jvm_sparse_buffer_evict.
+ */
+JVM_API
+VkResult jvm_sparse_image_evict(
+        jvm_sparse_image* sparse_image, VkImageSubresource subresource, VkOffset3D offset, VkExtent3D extent,
+        uint64_t retire_value);
+
+/**
+ * Returns the Vulkan handle to the sparse image.
+ * @param sparse_image Sparse image to get the handle from.
+ * @return Handle to the image.
+ */
+JVM_API
+VkImage jvm_sparse_image_get_image(jvm_sparse_image* sparse_image);
+
+/**
+ * Returns the extent of a single tile of the sparse image, at which granularity it is made resident and evicted.
+ * @param sparse_image Sparse image to get the tile extent of.
+ * @return Extent of a tile in texels.
+ */
+JVM_API
+VkExtent3D jvm_sparse_image_get_granularity(jvm_sparse_image* sparse_image);
+
+/**
+ * Returns how much memory resident tiles of the sparse image take up, not counting its mip tail and metadata.
+ * @param sparse_image Sparse image to get the resident size of.
+ * @return Size of all resident tiles in bytes.
+ */
+JVM_API
+VkDeviceSize jvm_sparse_image_get_resident_size(jvm_sparse_image* sparse_image);
 
+/**
+ * Binds and unbinds memory of all pages and tiles of the given resources which were made resident or evicted since
+ * they were last submitted, with a single call to vkQueueBindSparse. Neighbouring pages of a buffer are merged into a
+ * single bind where possible.
+ * @param allocator Allocator the resources were created with.
+ * @param queue Queue with sparse binding support to submit the binds to.
+ * @param batch_info Semaphores to wait on and signal, and the pNext chain of the batch, such as
+ * VkTimelineSemaphoreSubmitInfo. Its bind arrays are ignored. May be NULL.
+ * @param buffer_count Number of sparse buffers.
+ * @param sparse_buffers Array of buffer_count sparse buffers.
+ * @param image_count Number of sparse images.
+ * @param sparse_images Array of image_count sparse images.
+ * @param fence Fence to signal once the binds are done, or VK_NULL_HANDLE.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, or the
+ * return value of vkQueueBindSparse if that fails, in which case the binds are kept for the next submission.
+ */
+JVM_API
+VkResult jvm_sparse_submit(
+        jvm_allocator* allocator, VkQueue queue, const VkBindSparseInfo* batch_info, uint32_t buffer_count,
+        jvm_sparse_buffer* const* sparse_buffers, uint32_t image_count, jvm_sparse_image* const* sparse_images,
+        VkFence fence);
 
 
 /***********************************************************************************************************************
  *
  *
- *                                          Image related functions
+ *                                          Eviction related functions
  *
  *
  **********************************************************************************************************************/
 
 /**
- * Creates a new image using vkCreateBuffer and binds the correct memory to it.
- * @param allocator Allocator to use for the allocation.
- * @param create_info Image creation info passed to vkCreateImage.
- * @param desired_flags Flags that are desired for the image memory to have. This is in addition to flags required
- * by the image.
- * @param undesired_flags Flags that the memory should not have. If these conflict with image required memory flags,
- * it will cause the function to fail with VK_ERROR_OUT_OF_DEVICE_MEMORY.
- * @param dedicated If non-zero, the allocation is made for this image only.
- * @param p_out Pointer to receive the create allocation.
- * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory,
- * return value of vkCreateBuffer if that fails, VK_ERROR_OUT_OF_DEVICE_MEMORY if undesired_flags conflict with flags
- * required by the image, return value of vkBindImageMemory if that fails.
+ * Sets how large pools on a heap may grow in total. When a new pool would go over the budget, or the device runs out of
+ * memory, empty pools on the heap are released first, then evictable resources on it are evicted, least recently used
+ * first, until either enough memory is free or nothing is left to evict. In the latter case the budget is exceeded
+ * rather than failing the allocation.
+ * @param allocator Allocator to set the budget of.
+ * @param heap_index Index of the memory heap.
+ * @param budget Budget of the heap in bytes, or zero for no budget.
  */
 JVM_API
-VkResult jvm_image_create(
-        jvm_allocator* allocator, const VkImageCreateInfo* create_info, VkMemoryPropertyFlags desired_flags,
-        VkMemoryPropertyFlags undesired_flags, VkBool32 dedicated, jvm_image_allocation** p_out
-#ifdef JVM_TRACK_ALLOCATIONS
-        ,const char* file, int line
-#endif
-);
+void jvm_allocator_set_heap_budget(jvm_allocator* allocator, uint32_t heap_index, VkDeviceSize budget);
 
 /**
- * Destroys a image allocation, destroying the image and returning its device memory to its pool.
- * @param image_allocation Image allocation to free.
- * @return VK_SUCCESS if successful VK_ERROR_UNKNOWN an internal error occurred and image memory allocation
- * was not found in its proper pool.
+ * Returns how much device memory the allocator's pools on a heap take up.
+ * @param allocator Allocator to get the usage of.
+ * @param heap_index Index of the memory heap.
+ * @return Size of all pools on the heap in bytes.
  */
 JVM_API
-VkResult jvm_image_destroy(jvm_image_allocation* image_allocation);
+VkDeviceSize jvm_allocator_get_heap_usage(jvm_allocator* allocator, uint32_t heap_index);
 
 /**
- * Attempts to map a provided image allocation to host memory. Behaviour depends on the memory flags from which it was
- * allocated.
- * @param image_allocation Image allocation to map.
- * @param p_size Pointer which receives the size of the mapped region.
- * @param p_out Pointer which receives the pointer to the mapped memory.
- * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if chunk is already mapped, return value of vkMapMemory
- * if that fails, or the return value of vkFlushMappedMemoryRanges if that needed to be called and failed.
+ * Marks a buffer as evictable, so that the allocator may destroy it when its heap is under memory pressure, but only
+ * once the device has progressed past its last use (see jvm_buffer_touch and jvm_allocator_report_progress). The
+ * callback is called right before the buffer is destroyed, after which its handle is no longer valid.
+ * @param buffer_allocation Buffer to mark as evictable.
+ * @param callback Callback to call on eviction, or NULL to make the buffer no longer evictable.
+ * @param user_data Pointer passed to the callback.
+ * @return VK_SUCCESS if successful, or VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
  */
 JVM_API
-VkResult jvm_image_map(jvm_image_allocation* image_allocation, size_t* p_size, void** p_out);
+VkResult jvm_buffer_set_evictable(
+        jvm_buffer_allocation* buffer_allocation, jvm_eviction_callback callback, void* user_data);
 
 /**
- * Attempts to unmap a provided image allocation to host memory. Behaviour depends on the memory flags from which it was
- * allocated.
- * @param image_allocation Image allocation to unmap.
- * @return VK_SUCCESS if successful, VK_ERROR_MEMORY_MAP_FAILED if the chunk was not mapped before, or the return value
- * of vkInvalidateMappedMemoryRanges if that fails.
+ * Marks an image as evictable, the same way as jvm_buffer_set_evictable does for buffers.
+ * @param image_allocation Image to mark as evictable.
+ * @param callback Callback to call on eviction, or NULL to make the image no longer evictable.
+ * @param user_data Pointer passed to the callback.
+ * @return VK_SUCCESS if successful, or VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory.
  */
 JVM_API
-VkResult jvm_image_unmap(jvm_image_allocation* image_allocation);
+VkResult jvm_image_set_evictable(jvm_image_allocation* image_allocation, jvm_eviction_callback callback, void* user_data);
 
 /**
- * Flushes mapped image to ensure changes made to it on the host are visible to the device.
- * @param image_allocation Mapped image allocation to flush.
- * @return VK_SUCCESS if successful, or return value of vkFlushMappedMemoryRanges if it fails.
+ * Records that an evictable buffer is used by the device until the given value is reached. Least recently used buffers
+ * are evicted first, and none is evicted before the value was passed to jvm_allocator_report_progress. Does nothing for
+ * buffers which are not evictable.
+ * @param buffer_allocation Buffer which is used.
+ * @param use_value Timeline semaphore value or frame index after which the device no longer uses the buffer.
  */
 JVM_API
-VkResult jvm_image_mapped_flush(jvm_image_allocation* image_allocation);
+void jvm_buffer_touch(jvm_buffer_allocation* buffer_allocation, uint64_t use_value);
 
 /**
- * Invalidates mapped image to ensure changes made to it from the device are visible to the host.
- * @param image_allocation Mapped image allocation to invalidate.
- * @return VK_SUCCESS if successful, or return value of vkInvalidateMappedMemoryRanges if it fails.
+ * Records that an evictable image is used by the device until the given value is reached, the same way as
+ * jvm_buffer_touch does for buffers.
+ * @param image_allocation Image which is used.
+ * @param use_value Timeline semaphore value or frame index after which the device no longer uses the image.
  */
 JVM_API
-VkResult jvm_image_mapped_invalidate(jvm_image_allocation* image_allocation);
+void jvm_image_touch(jvm_image_allocation* image_allocation, uint64_t use_value);
 
 /**
- * Returns the Vulkan handle to the image.
- * @param image_allocation Image allocation to get the handle from.
- * @return Handle to the image.
+ * Changes priority of all memory allocated with a given priority, for example to let the driver page out a streaming
+ * cache before render targets. Allocations made with the old priority afterwards are placed in new pools, while those
+ * made with the new priority may share the changed pools.
+ * @param allocator Allocator of which memory is changed.
+ * @param old_priority Priority the memory was allocated with (jvm_allocation_create_info::priority).
+ * @param new_priority New priority of the memory in range (0, 1].
+ * @return VK_SUCCESS if successful, VK_ERROR_FEATURE_NOT_PRESENT if
+ * jvm_allocator_create_info::pageable_device_local_memory was not set, or VK_ERROR_UNKNOWN if the priority is out of
+ * range.
  */
 JVM_API
-VkImage jvm_image_allocation_get_image(jvm_image_allocation* image_allocation);
+VkResult jvm_allocator_set_priority(jvm_allocator* allocator, float old_priority, float new_priority);
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          Streaming related functions
+ *
+ *
+ **********************************************************************************************************************/
 
 /**
- * Returns the allocator with which the image was allocated.
- * @param image_allocation Image allocation to get the allocator from.
- * @return Handle to the allocator.
+ * Starts reading a range of a file into a host visible buffer. The range is split into chunks, which worker threads
+ * read straight into the buffer's mapped memory in parallel, flushing each chunk once it is read if the memory is not
+ * host coherent. The function returns once the workers are started. The buffer must not be mapped when the stream is
+ * started, nor destroyed, resized or mapped until jvm_stream_wait returns. Allocator functions are not called from the
+ * worker threads, apart from the error callback.
+ * @param buffer_allocation Buffer to write to. Its memory must be host visible.
+ * @param stream_info Parameters of the stream.
+ * @param p_out Pointer which receives the stream handle, which must be passed to jvm_stream_wait.
+ * @return VK_SUCCESS if successful, VK_ERROR_INITIALIZATION_FAILED if the file could not be opened or the range does not
+ * fit into the buffer, VK_ERROR_MEMORY_MAP_FAILED if the buffer is not host visible or is already mapped,
+ * VK_ERROR_FEATURE_NOT_PRESENT if threads are not supported on the platform, VK_ERROR_OUT_OF_HOST_MEMORY if it can not
+ * allocate required host memory.
  */
 JVM_API
-jvm_allocator* jvm_image_allocation_get_allocator(jvm_image_allocation* image_allocation);
+VkResult jvm_stream_file_into(
+        jvm_buffer_allocation* buffer_allocation, const jvm_stream_info* stream_info, jvm_stream** p_out);
 
 /**
- * Returns the useful size of the image in bytes.
- * @param image_allocation Image allocation to get the size of.
- * @return Useful size of the allocation.
+ * Waits for all workers of a stream to finish and releases it.
+ * @param stream Stream to wait for.
+ * @return VK_SUCCESS if all data was written and flushed, VK_ERROR_UNKNOWN if reading the file failed or it ended before
+ * the whole range was read, otherwise the error returned by vkFlushMappedMemoryRanges.
  */
 JVM_API
-VkExtent3D jvm_image_allocation_get_extent(jvm_image_allocation* image_allocation);
+VkResult jvm_stream_wait(jvm_stream* stream);
+
+
+/***********************************************************************************************************************
+ *
+ *
+ *                                          Virtual block related functions
+ *
+ *
+ **********************************************************************************************************************/
+
+/**
+ * Creates a virtual block, which hands out offsets within a range using the same placement and merging as the
+ * allocator's memory pools. It can be used for ranges in large buffers, descriptor heaps, or indices, and needs no
+ * Vulkan device.
+ * @param create_info Parameters of the block.
+ * @param p_out Pointer which receives the created block.
+ * @return VK_SUCCESS if successful, VK_ERROR_INITIALIZATION_FAILED if the size is zero, VK_ERROR_OUT_OF_HOST_MEMORY if
+ * it can not allocate required host memory.
+ */
+JVM_API
+VkResult jvm_virtual_block_create(jvm_virtual_block_create_info create_info, jvm_virtual_block** p_out);
+
+/**
+ * Destroys a virtual block. Allocations still left in it are reported as errors and released with it.
+ * @param block Block to destroy.
+ */
+JVM_API
+void jvm_virtual_block_destroy(jvm_virtual_block* block);
+
+/**
+ * Allocates a range from a virtual block.
+ * @param block Block to allocate from.
+ * @param size Size of the range. Must not be zero.
+ * @param alignment Alignment of the offset of the range. Must be a power of two.
+ * @param p_offset Pointer which receives the offset of the range within the block.
+ * @return VK_SUCCESS if successful, VK_ERROR_OUT_OF_DEVICE_MEMORY if there is no unused range where it fits,
+ * VK_ERROR_OUT_OF_HOST_MEMORY if it can not allocate required host memory, VK_ERROR_UNKNOWN if the size is zero.
+ */
+JVM_API
+VkResult jvm_virtual_block_allocate(
+        jvm_virtual_block* block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* p_offset);
+
+/**
+ * Frees a range allocated from a virtual block.
+ * @param block Block the range was allocated from.
+ * @param offset Offset returned by jvm_virtual_block_allocate.
+ * @return VK_SUCCESS if successful, VK_ERROR_UNKNOWN if there is no allocation at that offset.
+ */
+JVM_API
+VkResult jvm_virtual_block_free(jvm_virtual_block* block, VkDeviceSize offset);
+
+/**
+ * Gathers statistics of a virtual block.
+ * @param block Block to gather statistics of.
+ * @param p_stats Pointer which receives the statistics.
+ */
+JVM_API
+void jvm_virtual_block_get_stats(const jvm_virtual_block* block, jvm_virtual_block_stats* p_stats);
 
 
 #ifdef JVM_TRACK_ALLOCATIONS
@@ -430,6 +2027,29 @@ VkExtent3D jvm_image_allocation_get_extent(jvm_image_allocation* image_allocatio
         jvm_buffer_create(allocator, create_info, desired_flags, undesired_flags, dedicated, p_out, __FILE__, __LINE__)
     #define jvm_image_create(allocator, create_info, desired_flags, undesired_flags, dedicated, p_out)\
         jvm_image_create(allocator, create_info, desired_flags, undesired_flags, dedicated, p_out, __FILE__, __LINE__)
+    #define jvm_buffer_create2(allocator, create_info, allocation_info, p_out)\
+        jvm_buffer_create2(allocator, create_info, allocation_info, p_out, __FILE__, __LINE__)
+    #define jvm_image_create2(allocator, create_info, allocation_info, p_out)\
+        jvm_image_create2(allocator, create_info, allocation_info, p_out, __FILE__, __LINE__)
+    #define jvm_buffer_resize(buffer_allocation, create_info, command_buffer, retire_value, p_moved)\
+        jvm_buffer_resize(buffer_allocation, create_info, command_buffer, retire_value, p_moved, __FILE__, __LINE__)
+    #define jvm_allocate_for_buffer(allocator, buffer, allocation_info, p_out)\
+        jvm_allocate_for_buffer(allocator, buffer, allocation_info, p_out, __FILE__, __LINE__)
+    #define jvm_allocate_for_image(allocator, image, tiling, allocation_info, p_out)\
+        jvm_allocate_for_image(allocator, image, tiling, allocation_info, p_out, __FILE__, __LINE__)
+    #define jvm_buffer_import_fd(allocator, create_info, memory, p_out)\
+        jvm_buffer_import_fd(allocator, create_info, memory, p_out, __FILE__, __LINE__)
+    #define jvm_image_import_fd(allocator, create_info, memory, p_out)\
+        jvm_image_import_fd(allocator, create_info, memory, p_out, __FILE__, __LINE__)
+    #define jvm_buffer_create_from_host_pointer(allocator, create_info, host_pointer, p_out)\
+        jvm_buffer_create_from_host_pointer(allocator, create_info, host_pointer, p_out, __FILE__, __LINE__)
+    #define jvm_aliasing_group_create(allocator, resource_count, resources, desired_flags, undesired_flags, p_out)\
+        jvm_aliasing_group_create(allocator, resource_count, resources, desired_flags, undesired_flags, p_out, __FILE__,\
+        __LINE__)
+    #define jvm_sparse_buffer_create(allocator, create_info, allocation_info, p_out)\
+        jvm_sparse_buffer_create(allocator, create_info, allocation_info, p_out, __FILE__, __LINE__)
+    #define jvm_sparse_image_create(allocator, create_info, allocation_info, p_out)\
+        jvm_sparse_image_create(allocator, create_info, allocation_info, p_out, __FILE__, __LINE__)
 #endif
 
 #endif //JVM_JVM_H
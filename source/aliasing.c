@@ -0,0 +1,336 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+#undef jvm_aliasing_group_create
+
+//  Requirements and placement of a single resource while the group is being laid out
+typedef struct jvm_aliasing_placement_T jvm_aliasing_placement;
+struct jvm_aliasing_placement_T
+{
+    VkDeviceSize size;          //  size of the resource, rounded up to its alignment
+    VkDeviceSize alignment;     //  alignment the resource needs
+    VkDeviceSize offset;        //  where the resource was placed
+    uint32_t first_use;         //  first use of the resource
+    uint32_t last_use;          //  last use of the resource (inclusive)
+    VkBool32 placed;            //  non-zero once the offset is final
+};
+
+static int lifetimes_overlap(const jvm_aliasing_placement* p1, const jvm_aliasing_placement* p2)
+{
+    return p1->first_use <= p2->last_use && p2->first_use <= p1->last_use;
+}
+
+//  Returns non-zero if [offset, offset + size) does not overlap memory of any placed resource alive at the same time
+static int placement_is_free(
+        const jvm_aliasing_placement* placements, uint32_t count, const jvm_aliasing_placement* p, VkDeviceSize offset)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const jvm_aliasing_placement* const other = placements + i;
+        if (!other->placed || other == p || !lifetimes_overlap(other, p))
+        {
+            continue;
+        }
+        if (offset < other->offset + other->size && other->offset < offset + p->size)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//  Places resources largest first, each at the lowest offset where it does not overlap any resource which is alive at
+//  the same time. Candidate offsets are the start of memory and the ends of such resources. Returns the total size
+static VkDeviceSize place_resources(jvm_aliasing_placement* placements, uint32_t count)
+{
+    VkDeviceSize total_size = 0;
+    for (uint32_t n = 0; n < count; ++n)
+    {
+        //  Find the largest resource not yet placed
+        jvm_aliasing_placement* p = NULL;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (!placements[i].placed && (!p || placements[i].size > p->size))
+            {
+                p = placements + i;
+            }
+        }
+
+        VkDeviceSize best = 0;
+        int found = placement_is_free(placements, count, p, 0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const jvm_aliasing_placement* const other = placements + i;
+            if (!other->placed || !lifetimes_overlap(other, p))
+            {
+                continue;
+            }
+            const VkDeviceSize candidate = (other->offset + other->size + p->alignment - 1) & ~(p->alignment - 1);
+            if ((!found || candidate < best) && placement_is_free(placements, count, p, candidate))
+            {
+                best = candidate;
+                found = 1;
+            }
+        }
+        //  The end of the furthest overlapping resource is always free, so a place was found
+        p->offset = best;
+        p->placed = 1;
+        if (p->offset + p->size > total_size)
+        {
+            total_size = p->offset + p->size;
+        }
+    }
+    return total_size;
+}
+
+static void destroy_resources(jvm_allocator* allocator, jvm_aliased_resource* resources, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (resources[i].buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(allocator->device, resources[i].buffer, jvm_vk_callbacks(allocator));
+        }
+        if (resources[i].image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(allocator->device, resources[i].image, jvm_vk_callbacks(allocator));
+        }
+    }
+}
+
+VkResult jvm_aliasing_group_create(
+        jvm_allocator* allocator, uint32_t resource_count, const jvm_aliased_resource_info* resources,
+        VkMemoryPropertyFlags desired_flags, VkMemoryPropertyFlags undesired_flags, jvm_aliasing_group** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    if (resource_count == 0)
+    {
+        JVM_ERROR(allocator, "Aliasing group must contain at least one resource");
+        return VK_ERROR_UNKNOWN;
+    }
+    jvm_aliasing_group* const this = jvm_alloc(allocator, sizeof(*this));
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for aliasing group");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    this->resources = jvm_alloc(allocator, sizeof(*this->resources) * resource_count);
+    jvm_aliasing_placement* const placements = jvm_alloc(allocator, sizeof(*placements) * resource_count);
+    if (!this->resources || !placements)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for aliasing group resources");
+        jvm_free(allocator, placements);
+        jvm_free(allocator, this->resources);
+        jvm_free(allocator, this);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memset(this->resources, 0, sizeof(*this->resources) * resource_count);
+
+    //  Gather requirements of all resources
+    VkResult vk_result = VK_SUCCESS;
+    uint32_t type_bits = ~0u;
+    VkBool32 has_linear = 0, has_optimal = 0;
+    for (uint32_t i = 0; i < resource_count; ++i)
+    {
+        const jvm_aliased_resource_info* const info = resources + i;
+        VkMemoryRequirements mem_req;
+        if (info->image_create_info)
+        {
+            vk_result = jvm_image_memory_requirements(allocator, info->image_create_info, &mem_req);
+            if (info->image_create_info->tiling == VK_IMAGE_TILING_LINEAR)
+            {
+                has_linear = 1;
+            }
+            else
+            {
+                has_optimal = 1;
+            }
+        }
+        else
+        {
+            vk_result = jvm_buffer_memory_requirements(allocator, info->buffer_create_info, &mem_req);
+            has_linear = 1;
+        }
+        if (vk_result != VK_SUCCESS)
+        {
+            break;
+        }
+        type_bits &= mem_req.memoryTypeBits;
+        placements[i] = (jvm_aliasing_placement)
+                {
+                        .size = mem_req.size,
+                        .alignment = mem_req.alignment,
+                        .first_use = info->first_use,
+                        .last_use = info->last_use,
+                        .placed = 0,
+                };
+    }
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not find memory requirements of aliased resources");
+        jvm_free(allocator, placements);
+        jvm_free(allocator, this->resources);
+        jvm_free(allocator, this);
+        return vk_result;
+    }
+    if (!type_bits)
+    {
+        JVM_ERROR(allocator, "Aliased resources have no memory type in common");
+        jvm_free(allocator, placements);
+        jvm_free(allocator, this->resources);
+        jvm_free(allocator, this);
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    //  Linear and optimal resources placed next to each other must not share a bufferImageGranularity page
+    const jvm_tiling_class tiling = has_linear && has_optimal ? JVM_TILING_CLASS_MIXED :
+                                    has_optimal ? JVM_TILING_CLASS_OPTIMAL : JVM_TILING_CLASS_LINEAR;
+    VkDeviceSize alignment = 1;
+    for (uint32_t i = 0; i < resource_count; ++i)
+    {
+        jvm_aliasing_placement* const p = placements + i;
+        if (tiling == JVM_TILING_CLASS_MIXED && p->alignment < allocator->buffer_image_granularity)
+        {
+            p->alignment = allocator->buffer_image_granularity;
+        }
+        p->size = (p->size + p->alignment - 1) & ~(p->alignment - 1);
+        if (p->alignment > alignment)
+        {
+            alignment = p->alignment;
+        }
+    }
+    this->size = place_resources(placements, resource_count);
+
+    const jvm_allocation_create_info allocation_info =
+            {
+                    .usage = JVM_MEMORY_USAGE_UNKNOWN,
+                    .desired_flags = desired_flags,
+                    .undesired_flags = undesired_flags,
+            };
+    vk_result = !jvm_should_be_dedicated(allocator, this->size, 0) ? jvm_allocate(
+            allocator, this->size, alignment, type_bits, &allocation_info, tiling, &this->allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            )
+                          : jvm_allocate_dedicated(
+                    allocator, this->size, alignment, type_bits, &allocation_info, tiling, NULL, &this->allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+                    ,file, line
+#endif
+            );
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory required for the aliasing group");
+        jvm_free(allocator, placements);
+        jvm_free(allocator, this->resources);
+        jvm_free(allocator, this);
+        return vk_result;
+    }
+
+    //  Create all resources and bind them to their place in the shared memory
+    const VkDeviceSize base_offset = this->allocation->chunk_offset + this->allocation->padding;
+    for (uint32_t i = 0; i < resource_count; ++i)
+    {
+        const jvm_aliased_resource_info* const info = resources + i;
+        jvm_aliased_resource* const resource = this->resources + i;
+        resource->offset = placements[i].offset;
+        if (info->image_create_info)
+        {
+            vk_result = vkCreateImage(
+                    allocator->device, info->image_create_info, jvm_vk_callbacks(allocator), &resource->image);
+            if (vk_result != VK_SUCCESS)
+            {
+                JVM_ERROR(allocator, "Could not create aliased image");
+                break;
+            }
+            vk_result = vkBindImageMemory(
+                    allocator->device, resource->image, this->allocation->memory, base_offset + resource->offset);
+        }
+        else
+        {
+            vk_result = vkCreateBuffer(
+                    allocator->device, info->buffer_create_info, jvm_vk_callbacks(allocator), &resource->buffer);
+            if (vk_result != VK_SUCCESS)
+            {
+                JVM_ERROR(allocator, "Could not create aliased buffer");
+                break;
+            }
+            vk_result = vkBindBufferMemory(
+                    allocator->device, resource->buffer, this->allocation->memory, base_offset + resource->offset);
+        }
+        if (vk_result != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not bind memory to aliased resource");
+            break;
+        }
+    }
+    if (vk_result != VK_SUCCESS)
+    {
+        destroy_resources(allocator, this->resources, resource_count);
+        jvm_deallocate(allocator, this->allocation);
+        jvm_free(allocator, placements);
+        jvm_free(allocator, this->resources);
+        jvm_free(allocator, this);
+        return vk_result;
+    }
+
+    jvm_free(allocator, placements);
+    this->allocator = allocator;
+    this->resource_count = resource_count;
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+void jvm_aliasing_group_destroy(jvm_aliasing_group* aliasing_group)
+{
+    jvm_allocator* const allocator = aliasing_group->allocator;
+    destroy_resources(allocator, aliasing_group->resources, aliasing_group->resource_count);
+    (void) jvm_deallocate(allocator, aliasing_group->allocation);
+    jvm_free(allocator, aliasing_group->resources);
+    jvm_free(allocator, aliasing_group);
+}
+
+VkResult jvm_aliasing_group_destroy_deferred(jvm_aliasing_group* aliasing_group, uint64_t retire_value)
+{
+    jvm_allocator* const allocator = aliasing_group->allocator;
+    //  Make sure the whole group can be queued, so that it is not left half destroyed
+    const VkResult res = jvm_reserve_deferred(allocator, aliasing_group->resource_count + 1);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    for (uint32_t i = 0; i < aliasing_group->resource_count; ++i)
+    {
+        const jvm_aliased_resource* const resource = aliasing_group->resources + i;
+        (void) jvm_defer_destruction(allocator, retire_value, resource->buffer, resource->image, NULL);
+    }
+    //  Memory goes last, so it is released after all of the resources which use it
+    (void) jvm_defer_destruction(allocator, retire_value, VK_NULL_HANDLE, VK_NULL_HANDLE, aliasing_group->allocation);
+    jvm_free(allocator, aliasing_group->resources);
+    jvm_free(allocator, aliasing_group);
+    return VK_SUCCESS;
+}
+
+VkBuffer jvm_aliasing_group_get_buffer(jvm_aliasing_group* aliasing_group, uint32_t index)
+{
+    return index < aliasing_group->resource_count ? aliasing_group->resources[index].buffer : VK_NULL_HANDLE;
+}
+
+VkImage jvm_aliasing_group_get_image(jvm_aliasing_group* aliasing_group, uint32_t index)
+{
+    return index < aliasing_group->resource_count ? aliasing_group->resources[index].image : VK_NULL_HANDLE;
+}
+
+VkDeviceSize jvm_aliasing_group_get_size(jvm_aliasing_group* aliasing_group)
+{
+    return aliasing_group->size;
+}
@@ -0,0 +1,334 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JVM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+//  Writes smaller than this are not worth aligning the destination for
+#define JVM_STREAMING_THRESHOLD 256
+
+//  Kernels for host cached memory, which the CPU caches as it would any other memory
+
+static void write_plain(void* dst, const void* src, size_t size)
+{
+    memcpy(dst, src, size);
+}
+
+static void fill_plain(void* dst, int value, size_t size)
+{
+    memset(dst, value, size);
+}
+
+#ifdef JVM_X86_KERNELS
+
+//  Kernels for write-combined memory. The destination is aligned to the vector size with a plain copy of the head,
+//  after which whole vectors are written with non-temporal stores, so that each fills a write-combining buffer which is
+//  sent over the bus at once, instead of being read into the cache first. The tail is once again a plain copy. Source
+//  loads are unaligned, since the source is ordinary host memory of any alignment
+
+//  Number of bytes needed to bring dst up to the given alignment, at most size
+static size_t head_size(const void* dst, size_t alignment, size_t size)
+{
+    const size_t head = (alignment - ((uintptr_t) dst & (alignment - 1))) & (alignment - 1);
+    return head < size ? head : size;
+}
+
+__attribute__((target("sse2")))
+static void write_sse2(void* dst, const void* src, size_t size)
+{
+    if (size < JVM_STREAMING_THRESHOLD)
+    {
+        memcpy(dst, src, size);
+        return;
+    }
+    uint8_t* d = dst;
+    const uint8_t* s = src;
+    const size_t head = head_size(d, 16, size);
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+    for (; size >= 64; size -= 64, d += 64, s += 64)
+    {
+        const __m128i v0 = _mm_loadu_si128((const __m128i*) (s + 0));
+        const __m128i v1 = _mm_loadu_si128((const __m128i*) (s + 16));
+        const __m128i v2 = _mm_loadu_si128((const __m128i*) (s + 32));
+        const __m128i v3 = _mm_loadu_si128((const __m128i*) (s + 48));
+        _mm_stream_si128((__m128i*) (d + 0), v0);
+        _mm_stream_si128((__m128i*) (d + 16), v1);
+        _mm_stream_si128((__m128i*) (d + 32), v2);
+        _mm_stream_si128((__m128i*) (d + 48), v3);
+    }
+    for (; size >= 16; size -= 16, d += 16, s += 16)
+    {
+        _mm_stream_si128((__m128i*) d, _mm_loadu_si128((const __m128i*) s));
+    }
+    memcpy(d, s, size);
+    //  Non-temporal stores are weakly ordered, so they must be fenced before anything else can observe them
+    _mm_sfence();
+}
+
+__attribute__((target("sse2")))
+static void fill_sse2(void* dst, int value, size_t size)
+{
+    if (size < JVM_STREAMING_THRESHOLD)
+    {
+        memset(dst, value, size);
+        return;
+    }
+    uint8_t* d = dst;
+    const size_t head = head_size(d, 16, size);
+    memset(d, value, head);
+    d += head;
+    size -= head;
+    const __m128i v = _mm_set1_epi8((char) value);
+    for (; size >= 64; size -= 64, d += 64)
+    {
+        _mm_stream_si128((__m128i*) (d + 0), v);
+        _mm_stream_si128((__m128i*) (d + 16), v);
+        _mm_stream_si128((__m128i*) (d + 32), v);
+        _mm_stream_si128((__m128i*) (d + 48), v);
+    }
+    for (; size >= 16; size -= 16, d += 16)
+    {
+        _mm_stream_si128((__m128i*) d, v);
+    }
+    memset(d, value, size);
+    _mm_sfence();
+}
+
+__attribute__((target("avx2")))
+static void write_avx2(void* dst, const void* src, size_t size)
+{
+    if (size < JVM_STREAMING_THRESHOLD)
+    {
+        memcpy(dst, src, size);
+        return;
+    }
+    uint8_t* d = dst;
+    const uint8_t* s = src;
+    const size_t head = head_size(d, 32, size);
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+    for (; size >= 128; size -= 128, d += 128, s += 128)
+    {
+        const __m256i v0 = _mm256_loadu_si256((const __m256i*) (s + 0));
+        const __m256i v1 = _mm256_loadu_si256((const __m256i*) (s + 32));
+        const __m256i v2 = _mm256_loadu_si256((const __m256i*) (s + 64));
+        const __m256i v3 = _mm256_loadu_si256((const __m256i*) (s + 96));
+        _mm256_stream_si256((__m256i*) (d + 0), v0);
+        _mm256_stream_si256((__m256i*) (d + 32), v1);
+        _mm256_stream_si256((__m256i*) (d + 64), v2);
+        _mm256_stream_si256((__m256i*) (d + 96), v3);
+    }
+    for (; size >= 32; size -= 32, d += 32, s += 32)
+    {
+        _mm256_stream_si256((__m256i*) d, _mm256_loadu_si256((const __m256i*) s));
+    }
+    memcpy(d, s, size);
+    _mm_sfence();
+}
+
+__attribute__((target("avx2")))
+static void fill_avx2(void* dst, int value, size_t size)
+{
+    if (size < JVM_STREAMING_THRESHOLD)
+    {
+        memset(dst, value, size);
+        return;
+    }
+    uint8_t* d = dst;
+    const size_t head = head_size(d, 32, size);
+    memset(d, value, head);
+    d += head;
+    size -= head;
+    const __m256i v = _mm256_set1_epi8((char) value);
+    for (; size >= 128; size -= 128, d += 128)
+    {
+        _mm256_stream_si256((__m256i*) (d + 0), v);
+        _mm256_stream_si256((__m256i*) (d + 32), v);
+        _mm256_stream_si256((__m256i*) (d + 64), v);
+        _mm256_stream_si256((__m256i*) (d + 96), v);
+    }
+    for (; size >= 32; size -= 32, d += 32)
+    {
+        _mm256_stream_si256((__m256i*) d, v);
+    }
+    memset(d, value, size);
+    _mm_sfence();
+}
+
+__attribute__((target("avx512f")))
+static void write_avx512(void* dst, const void* src, size_t size)
+{
+    if (size < JVM_STREAMING_THRESHOLD)
+    {
+        memcpy(dst, src, size);
+        return;
+    }
+    uint8_t* d = dst;
+    const uint8_t* s = src;
+    const size_t head = head_size(d, 64, size);
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+    for (; size >= 256; size -= 256, d += 256, s += 256)
+    {
+        const __m512i v0 = _mm512_loadu_si512((const void*) (s + 0));
+        const __m512i v1 = _mm512_loadu_si512((const void*) (s + 64));
+        const __m512i v2 = _mm512_loadu_si512((const void*) (s + 128));
+        const __m512i v3 = _mm512_loadu_si512((const void*) (s + 192));
+        _mm512_stream_si512((void*) (d + 0), v0);
+        _mm512_stream_si512((void*) (d + 64), v1);
+        _mm512_stream_si512((void*) (d + 128), v2);
+        _mm512_stream_si512((void*) (d + 192), v3);
+    }
+    for (; size >= 64; size -= 64, d += 64, s += 64)
+    {
+        _mm512_stream_si512((void*) d, _mm512_loadu_si512((const void*) s));
+    }
+    memcpy(d, s, size);
+    _mm_sfence();
+}
+
+__attribute__((target("avx512f")))
+static void fill_avx512(void* dst, int value, size_t size)
+{
+    if (size < JVM_STREAMING_THRESHOLD)
+    {
+        memset(dst, value, size);
+        return;
+    }
+    uint8_t* d = dst;
+    const size_t head = head_size(d, 64, size);
+    memset(d, value, head);
+    d += head;
+    size -= head;
+    const __m512i v = _mm512_set1_epi32((int) (0x01010101u * (uint8_t) value));
+    for (; size >= 256; size -= 256, d += 256)
+    {
+        _mm512_stream_si512((void*) (d + 0), v);
+        _mm512_stream_si512((void*) (d + 64), v);
+        _mm512_stream_si512((void*) (d + 128), v);
+        _mm512_stream_si512((void*) (d + 192), v);
+    }
+    for (; size >= 64; size -= 64, d += 64)
+    {
+        _mm512_stream_si512((void*) d, v);
+    }
+    memset(d, value, size);
+    _mm_sfence();
+}
+
+#endif
+
+unsigned jvm_supported_mapped_kernels(jvm_mapped_kernels* p_kernels)
+{
+    unsigned count = 0;
+    p_kernels[count++] = (jvm_mapped_kernels){.name = "plain", .write = write_plain, .fill = fill_plain};
+#ifdef JVM_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+    {
+        p_kernels[count++] = (jvm_mapped_kernels){.name = "sse2", .write = write_sse2, .fill = fill_sse2};
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        p_kernels[count++] = (jvm_mapped_kernels){.name = "avx2", .write = write_avx2, .fill = fill_avx2};
+    }
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        p_kernels[count++] = (jvm_mapped_kernels){.name = "avx512f", .write = write_avx512, .fill = fill_avx512};
+    }
+#endif
+    return count;
+}
+
+void jvm_select_mapped_kernels(jvm_allocator* allocator)
+{
+    jvm_mapped_kernels kernels[JVM_MAPPED_KERNEL_COUNT];
+    const unsigned count = jvm_supported_mapped_kernels(kernels);
+    allocator->write_kernel = kernels[count - 1].write;
+    allocator->fill_kernel = kernels[count - 1].fill;
+}
+
+//  Host cached memory is read into the cache on writes anyway, so streaming past it would only make things slower
+static VkBool32 is_write_combined(VkMemoryPropertyFlags flags)
+{
+    return !(flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+}
+
+void jvm_mapped_copy(
+        const jvm_allocator* allocator, VkMemoryPropertyFlags flags, void* dst, const void* src, size_t size)
+{
+    if (is_write_combined(flags))
+    {
+        allocator->write_kernel(dst, src, size);
+    }
+    else
+    {
+        memcpy(dst, src, size);
+    }
+}
+
+void jvm_mapped_set(const jvm_allocator* allocator, VkMemoryPropertyFlags flags, void* dst, int value, size_t size)
+{
+    if (is_write_combined(flags))
+    {
+        allocator->fill_kernel(dst, value, size);
+    }
+    else
+    {
+        memset(dst, value, size);
+    }
+}
+
+static VkResult check_mapped_range(
+        const jvm_buffer_allocation* buffer_allocation, VkDeviceSize offset, VkDeviceSize size)
+{
+    jvm_allocator* const allocator = buffer_allocation->allocator;
+    if (!(buffer_allocation->allocation->pool->memory_type_info.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+    {
+        JVM_ERROR(allocator, "Buffer memory is not host visible");
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+    if (offset > buffer_allocation->buffer_size || size > buffer_allocation->buffer_size - offset)
+    {
+        JVM_ERROR(allocator, "Range of %zu bytes at offset %zu does not fit into the buffer of size %zu", (size_t) size,
+                  (size_t) offset, (size_t) buffer_allocation->buffer_size);
+        return VK_ERROR_UNKNOWN;
+    }
+    return VK_SUCCESS;
+}
+
+VkResult jvm_mapped_write(
+        jvm_buffer_allocation* buffer_allocation, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+    const VkResult res = check_mapped_range(buffer_allocation, offset, size);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    return jvm_chunk_write(buffer_allocation->allocator, buffer_allocation->allocation, offset, data, size);
+}
+
+VkResult jvm_mapped_fill(
+        jvm_buffer_allocation* buffer_allocation, VkDeviceSize offset, uint8_t value, VkDeviceSize size)
+{
+    const VkResult res = check_mapped_range(buffer_allocation, offset, size);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    return jvm_chunk_fill(buffer_allocation->allocator, buffer_allocation->allocation, offset, value, size);
+}
@@ -0,0 +1,196 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include "../include/jvm.h"
+#include "internal.h"
+
+static VkResult evictable_add(
+        jvm_allocator* allocator, jvm_evictable** p_evictable, jvm_buffer_allocation* buffer_allocation,
+        jvm_image_allocation* image_allocation, jvm_eviction_callback callback, void* user_data)
+{
+    if (*p_evictable)
+    {
+        (*p_evictable)->callback = callback;
+        (*p_evictable)->user_data = user_data;
+        return VK_SUCCESS;
+    }
+    if (allocator->evictable_count == allocator->evictable_capacity)
+    {
+        const unsigned new_capacity = allocator->evictable_capacity ? allocator->evictable_capacity << 1 : 32;
+        jvm_evictable** const new_ptr = jvm_realloc(
+                allocator, allocator->evictable, sizeof(*allocator->evictable) * new_capacity);
+        if (!new_ptr)
+        {
+            JVM_ERROR(allocator, "Could not (re-)allocate evictable resource array");
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        allocator->evictable = new_ptr;
+        allocator->evictable_capacity = new_capacity;
+    }
+    jvm_evictable* const this = jvm_alloc(allocator, sizeof(*this));
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for eviction state");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    *this = (jvm_evictable)
+            {
+                    .buffer = buffer_allocation,
+                    .image = image_allocation,
+                    .callback = callback,
+                    .user_data = user_data,
+                    .last_use = 0,
+                    .pinned = 0,
+                    .index = allocator->evictable_count,
+            };
+    allocator->evictable[allocator->evictable_count++] = this;
+    *p_evictable = this;
+    return VK_SUCCESS;
+}
+
+void jvm_evictable_remove(jvm_allocator* allocator, jvm_evictable* evictable)
+{
+    //  Order does not matter, so the last one takes its place
+    jvm_evictable* const last = allocator->evictable[allocator->evictable_count - 1];
+    last->index = evictable->index;
+    allocator->evictable[evictable->index] = last;
+    allocator->evictable_count -= 1;
+    if (evictable->buffer)
+    {
+        evictable->buffer->evictable = NULL;
+    }
+    else
+    {
+        evictable->image->evictable = NULL;
+    }
+    jvm_free(allocator, evictable);
+}
+
+VkBool32 jvm_evict_lru(jvm_allocator* allocator, uint32_t heap_index)
+{
+    jvm_evictable* lru = NULL;
+    for (unsigned i = 0; i < allocator->evictable_count; ++i)
+    {
+        jvm_evictable* const evictable = allocator->evictable[i];
+        const jvm_chunk* const chunk = evictable->buffer ? evictable->buffer->allocation : evictable->image->allocation;
+        if (chunk->pool->memory_type_info.heapIndex != heap_index || evictable->last_use > allocator->completed_value ||
+            evictable->pinned)
+        {
+            //  Other heap, the device may still be using it, or it is being moved
+            continue;
+        }
+        if (!lru || evictable->last_use < lru->last_use)
+        {
+            lru = evictable;
+        }
+    }
+    if (!lru)
+    {
+        return 0;
+    }
+    jvm_buffer_allocation* const buffer_allocation = lru->buffer;
+    jvm_image_allocation* const image_allocation = lru->image;
+    lru->callback(lru->user_data, buffer_allocation, image_allocation);
+    if (buffer_allocation)
+    {
+        (void) jvm_buffer_destroy(buffer_allocation);
+    }
+    else
+    {
+        (void) jvm_image_destroy(image_allocation);
+    }
+    return 1;
+}
+
+VkResult jvm_buffer_set_evictable(
+        jvm_buffer_allocation* buffer_allocation, jvm_eviction_callback callback, void* user_data)
+{
+    jvm_allocator* const allocator = buffer_allocation->allocator;
+    if (!callback)
+    {
+        if (buffer_allocation->evictable)
+        {
+            jvm_evictable_remove(allocator, buffer_allocation->evictable);
+        }
+        return VK_SUCCESS;
+    }
+    return evictable_add(allocator, &buffer_allocation->evictable, buffer_allocation, NULL, callback, user_data);
+}
+
+VkResult jvm_image_set_evictable(jvm_image_allocation* image_allocation, jvm_eviction_callback callback, void* user_data)
+{
+    jvm_allocator* const allocator = image_allocation->allocator;
+    if (!callback)
+    {
+        if (image_allocation->evictable)
+        {
+            jvm_evictable_remove(allocator, image_allocation->evictable);
+        }
+        return VK_SUCCESS;
+    }
+    return evictable_add(allocator, &image_allocation->evictable, NULL, image_allocation, callback, user_data);
+}
+
+void jvm_buffer_touch(jvm_buffer_allocation* buffer_allocation, uint64_t use_value)
+{
+    jvm_evictable* const evictable = buffer_allocation->evictable;
+    if (evictable && use_value > evictable->last_use)
+    {
+        evictable->last_use = use_value;
+    }
+}
+
+void jvm_image_touch(jvm_image_allocation* image_allocation, uint64_t use_value)
+{
+    jvm_evictable* const evictable = image_allocation->evictable;
+    if (evictable && use_value > evictable->last_use)
+    {
+        evictable->last_use = use_value;
+    }
+}
+
+void jvm_allocator_set_heap_budget(jvm_allocator* allocator, uint32_t heap_index, VkDeviceSize budget)
+{
+    if (heap_index >= allocator->memory_properties.memoryHeapCount)
+    {
+        JVM_ERROR(allocator, "Heap index %u is out of range (device has %u heaps)", heap_index,
+                  allocator->memory_properties.memoryHeapCount);
+        return;
+    }
+    allocator->heap_budget[heap_index] = budget;
+}
+
+VkDeviceSize jvm_allocator_get_heap_usage(jvm_allocator* allocator, uint32_t heap_index)
+{
+    return heap_index < allocator->memory_properties.memoryHeapCount ? allocator->heap_usage[heap_index] : 0;
+}
+
+VkResult jvm_allocator_set_priority(jvm_allocator* allocator, float old_priority, float new_priority)
+{
+    if (!allocator->set_device_memory_priority)
+    {
+        JVM_ERROR(allocator, "Priority of memory can not be changed without pageable device local memory");
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+    if (!(new_priority > 0.0f && new_priority <= 1.0f))
+    {
+        JVM_ERROR(allocator, "Memory priority %g is not in range (0, 1]", (double) new_priority);
+        return VK_ERROR_UNKNOWN;
+    }
+    if (old_priority == 0.0f)
+    {
+        old_priority = JVM_DEFAULT_PRIORITY;
+    }
+    for (unsigned i = 0; i < allocator->pool_count; ++i)
+    {
+        jvm_allocation_pool* const pool = allocator->pools[i];
+        if (pool->priority != old_priority)
+        {
+            continue;
+        }
+        allocator->set_device_memory_priority(allocator->device, pool->memory, new_priority);
+        pool->priority = new_priority;
+    }
+    return VK_SUCCESS;
+}
@@ -0,0 +1,366 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <stdint.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+#undef jvm_buffer_import_fd
+#undef jvm_image_import_fd
+#undef jvm_buffer_create_from_host_pointer
+
+static VkResult export_chunk_fd(
+        jvm_allocator* allocator, const jvm_chunk* chunk, VkExternalMemoryHandleTypeFlagBits handle_type,
+        jvm_external_memory_info* p_out)
+{
+    if (!allocator->get_memory_fd)
+    {
+        JVM_ERROR(allocator, "Memory can not be exported without external memory file descriptors enabled");
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+    const jvm_allocation_pool* const pool = chunk->pool;
+    if (!(pool->export_handle_types & handle_type))
+    {
+        JVM_ERROR(allocator, "Memory was not allocated to be exported as handle type 0x%x", (unsigned) handle_type);
+        return VK_ERROR_INVALID_EXTERNAL_HANDLE;
+    }
+    const VkMemoryGetFdInfoKHR get_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+                    .memory = pool->memory,
+                    .handleType = handle_type,
+            };
+    int fd;
+    const VkResult res = allocator->get_memory_fd(allocator->device, &get_info, &fd);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not export memory: call to vkGetMemoryFdKHR failed");
+        return res;
+    }
+    *p_out = (jvm_external_memory_info)
+            {
+                    .handle_type = handle_type,
+                    .fd = fd,
+                    .memory_size = pool->size,
+                    .offset = chunk->chunk_offset + chunk->padding,
+                    .memory_type_index = pool->memory_type_index,
+                    .dedicated = pool->dedicated,
+            };
+    return VK_SUCCESS;
+}
+
+VkResult jvm_buffer_export_fd(
+        jvm_buffer_allocation* buffer_allocation, VkExternalMemoryHandleTypeFlagBits handle_type,
+        jvm_external_memory_info* p_out)
+{
+    return export_chunk_fd(buffer_allocation->allocator, buffer_allocation->allocation, handle_type, p_out);
+}
+
+VkResult jvm_image_export_fd(
+        jvm_image_allocation* image_allocation, VkExternalMemoryHandleTypeFlagBits handle_type,
+        jvm_external_memory_info* p_out)
+{
+    return export_chunk_fd(image_allocation->allocator, image_allocation->allocation, handle_type, p_out);
+}
+
+//  Checks the resource fits into the memory where it was exported, and chooses the memory type to import it as
+static VkResult choose_import_type(
+        jvm_allocator* allocator, const jvm_external_memory_info* memory, const VkMemoryRequirements* mem_req,
+        uint32_t* p_idx)
+{
+    if (!allocator->get_memory_fd_properties)
+    {
+        JVM_ERROR(allocator, "Memory can not be imported without external memory file descriptors enabled");
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+    if ((memory->offset & (mem_req->alignment - 1)) || memory->offset > memory->memory_size ||
+        mem_req->size > memory->memory_size - memory->offset)
+    {
+        JVM_ERROR(allocator, "Resource does not fit into imported memory of size %zu at offset %zu",
+                  (size_t) memory->memory_size, (size_t) memory->offset);
+        return VK_ERROR_INVALID_EXTERNAL_HANDLE;
+    }
+    uint32_t type_bits = mem_req->memoryTypeBits;
+    //  Properties of opaque file descriptors can not be queried, they only work with the type they were exported from
+    if (memory->handle_type != VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT)
+    {
+        VkMemoryFdPropertiesKHR fd_properties =
+                {
+                        .sType = VK_STRUCTURE_TYPE_MEMORY_FD_PROPERTIES_KHR,
+                };
+        const VkResult res = allocator->get_memory_fd_properties(
+                allocator->device, memory->handle_type, memory->fd, &fd_properties);
+        if (res != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not import memory: call to vkGetMemoryFdPropertiesKHR failed");
+            return res;
+        }
+        type_bits &= fd_properties.memoryTypeBits;
+    }
+    if (memory->memory_type_index < allocator->memory_properties.memoryTypeCount &&
+        (type_bits & (1u << memory->memory_type_index)))
+    {
+        *p_idx = memory->memory_type_index;
+        return VK_SUCCESS;
+    }
+    if (memory->handle_type == VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT || !type_bits)
+    {
+        JVM_ERROR(allocator, "No memory type can hold both the resource and the imported memory");
+        return VK_ERROR_INVALID_EXTERNAL_HANDLE;
+    }
+    *p_idx = jvm_lowest_bit(type_bits);
+    return VK_SUCCESS;
+}
+
+VkResult jvm_buffer_import_fd(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, const jvm_external_memory_info* memory,
+        jvm_buffer_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    jvm_buffer_allocation* const this = jvm_object_alloc(allocator, &allocator->buffer_objects);
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for buffer allocation");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    VkBuffer buffer;
+    VkResult vk_result = vkCreateBuffer(allocator->device, create_info, jvm_vk_callbacks(allocator), &buffer);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create new buffer: call to vkCreateBuffer failed");
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
+        return vk_result;
+    }
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    jvm_query_buffer_memory_requirements(allocator, buffer, &mem_req, &prefers_dedicated);
+    uint32_t idx;
+    vk_result = choose_import_type(allocator, memory, &mem_req, &idx);
+    if (vk_result != VK_SUCCESS)
+    {
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
+        return vk_result;
+    }
+    const VkImportMemoryFdInfoKHR import_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+                    .handleType = memory->handle_type,
+                    .fd = memory->fd,
+            };
+    const VkMemoryDedicatedAllocateInfo dedicated_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+                    .buffer = buffer,
+            };
+    vk_result = jvm_import_memory(
+            allocator, memory->memory_size, memory->offset, idx,
+            memory->dedicated && allocator->dedicated_allocation ? &dedicated_info : NULL, &import_info,
+            JVM_TILING_CLASS_LINEAR, &this->allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            );
+    if (vk_result != VK_SUCCESS)
+    {
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
+        return vk_result;
+    }
+    vk_result = vkBindBufferMemory(allocator->device, buffer, this->allocation->memory, memory->offset);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not bind imported memory to buffer");
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        jvm_deallocate(allocator, this->allocation);
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
+        return vk_result;
+    }
+    this->buffer_size = create_info->size;
+    this->buffer = buffer;
+    this->allocator = allocator;
+    this->evictable = NULL;
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_image_import_fd(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, const jvm_external_memory_info* memory,
+        jvm_image_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    jvm_image_allocation* const this = jvm_object_alloc(allocator, &allocator->image_objects);
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for image allocation");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    VkImage img;
+    VkResult vk_result = vkCreateImage(allocator->device, create_info, jvm_vk_callbacks(allocator), &img);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create new image");
+        jvm_object_free(allocator, &allocator->image_objects, this);
+        return vk_result;
+    }
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    jvm_query_image_memory_requirements(allocator, img, &mem_req, &prefers_dedicated);
+    uint32_t idx;
+    vk_result = choose_import_type(allocator, memory, &mem_req, &idx);
+    if (vk_result != VK_SUCCESS)
+    {
+        vkDestroyImage(allocator->device, img, jvm_vk_callbacks(allocator));
+        jvm_object_free(allocator, &allocator->image_objects, this);
+        return vk_result;
+    }
+    const VkImportMemoryFdInfoKHR import_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+                    .handleType = memory->handle_type,
+                    .fd = memory->fd,
+            };
+    const VkMemoryDedicatedAllocateInfo dedicated_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+                    .image = img,
+            };
+    vk_result = jvm_import_memory(
+            allocator, memory->memory_size, memory->offset, idx,
+            memory->dedicated && allocator->dedicated_allocation ? &dedicated_info : NULL, &import_info,
+            create_info->tiling == VK_IMAGE_TILING_LINEAR ? JVM_TILING_CLASS_LINEAR : JVM_TILING_CLASS_OPTIMAL,
+            &this->allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            );
+    if (vk_result != VK_SUCCESS)
+    {
+        vkDestroyImage(allocator->device, img, jvm_vk_callbacks(allocator));
+        jvm_object_free(allocator, &allocator->image_objects, this);
+        return vk_result;
+    }
+    vk_result = vkBindImageMemory(allocator->device, img, this->allocation->memory, memory->offset);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not bind imported memory to image");
+        vkDestroyImage(allocator->device, img, jvm_vk_callbacks(allocator));
+        jvm_deallocate(allocator, this->allocation);
+        jvm_object_free(allocator, &allocator->image_objects, this);
+        return vk_result;
+    }
+    this->image = img;
+    this->allocator = allocator;
+    this->extent = create_info->extent;
+    this->format = create_info->format;
+    this->evictable = NULL;
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_buffer_create_from_host_pointer(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, const void* host_pointer,
+        jvm_buffer_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    if (!allocator->get_memory_host_pointer_properties)
+    {
+        JVM_ERROR(allocator, "Host memory can not be imported without external memory host enabled");
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+    //  Imported range is widened to the alignment, and the buffer is bound at its offset within it
+    const VkDeviceSize alignment = allocator->min_imported_host_pointer_alignment;
+    const uintptr_t address = (uintptr_t) host_pointer;
+    void* const base = (void*) (address & ~(uintptr_t) (alignment - 1));
+    const VkDeviceSize offset = address - (uintptr_t) base;
+    const VkDeviceSize memory_size = (offset + create_info->size + alignment - 1) & ~(alignment - 1);
+
+    jvm_buffer_allocation* const this = jvm_object_alloc(allocator, &allocator->buffer_objects);
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for buffer allocation");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    const VkExternalMemoryBufferCreateInfo external_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+                    .pNext = create_info->pNext,
+                    .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+            };
+    VkBufferCreateInfo external_create_info = *create_info;
+    external_create_info.pNext = &external_info;
+    VkBuffer buffer;
+    VkResult vk_result = vkCreateBuffer(allocator->device, &external_create_info, jvm_vk_callbacks(allocator), &buffer);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create new buffer: call to vkCreateBuffer failed");
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
+        return vk_result;
+    }
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    jvm_query_buffer_memory_requirements(allocator, buffer, &mem_req, &prefers_dedicated);
+    VkMemoryHostPointerPropertiesEXT host_properties =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT,
+            };
+    vk_result = allocator->get_memory_host_pointer_properties(
+            allocator->device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, base, &host_properties);
+    uint32_t idx;
+    if (vk_result != VK_SUCCESS || (offset & (mem_req.alignment - 1)) ||
+        jvm_find_memory_type(
+                &allocator->memory_properties, mem_req.memoryTypeBits & host_properties.memoryTypeBits, 0, 0,
+                &idx) != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Host memory at %p can not be imported for the buffer", host_pointer);
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
+        return VK_ERROR_INVALID_EXTERNAL_HANDLE;
+    }
+    const VkImportMemoryHostPointerInfoEXT import_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT,
+                    .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+                    .pHostPointer = base,
+            };
+    vk_result = jvm_import_memory(
+            allocator, memory_size, offset, idx, NULL, &import_info, JVM_TILING_CLASS_LINEAR, &this->allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            );
+    if (vk_result != VK_SUCCESS)
+    {
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
+        return vk_result;
+    }
+    vk_result = vkBindBufferMemory(allocator->device, buffer, this->allocation->memory, offset);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not bind imported host memory to buffer");
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        jvm_deallocate(allocator, this->allocation);
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
+        return vk_result;
+    }
+    this->buffer_size = create_info->size;
+    this->buffer = buffer;
+    this->allocator = allocator;
+    this->evictable = NULL;
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
@@ -0,0 +1,155 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include "../include/jvm.h"
+#include "internal.h"
+
+//  Formats with consecutive values whose texel blocks are of the same size
+typedef struct jvm_format_range_T jvm_format_range;
+struct jvm_format_range_T
+{
+    VkFormat first;             //  first format of the range
+    VkFormat last;              //  last format of the range (inclusive)
+    VkDeviceSize block_size;    //  size of a texel block in bytes
+};
+
+//  Values of core formats are consecutive, so they are listed as ranges of the same block size. Multi-planar formats
+//  give the size of a texel of their first plane
+static const jvm_format_range FORMAT_RANGES[] =
+        {
+                {VK_FORMAT_R4G4_UNORM_PACK8, VK_FORMAT_R4G4_UNORM_PACK8, 1},
+                {VK_FORMAT_R4G4B4A4_UNORM_PACK16, VK_FORMAT_A1R5G5B5_UNORM_PACK16, 2},
+                {VK_FORMAT_R8_UNORM, VK_FORMAT_R8_SRGB, 1},
+                {VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8_SRGB, 2},
+                {VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_B8G8R8_SRGB, 3},
+                {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_A2B10G10R10_SINT_PACK32, 4},
+                {VK_FORMAT_R16_UNORM, VK_FORMAT_R16_SFLOAT, 2},
+                {VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16_SFLOAT, 4},
+                {VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16_SFLOAT, 6},
+                {VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT, 8},
+                {VK_FORMAT_R32_UINT, VK_FORMAT_R32_SFLOAT, 4},
+                {VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32_SFLOAT, 8},
+                {VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32_SFLOAT, 12},
+                {VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_R32G32B32A32_SFLOAT, 16},
+                {VK_FORMAT_R64_UINT, VK_FORMAT_R64_SFLOAT, 8},
+                {VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64_SFLOAT, 16},
+                {VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64_SFLOAT, 24},
+                {VK_FORMAT_R64G64B64A64_UINT, VK_FORMAT_R64G64B64A64_SFLOAT, 32},
+                {VK_FORMAT_B10G11R11_UFLOAT_PACK32, VK_FORMAT_E5B9G9R9_UFLOAT_PACK32, 4},
+                {VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK, 8},
+                {VK_FORMAT_BC2_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK, 16},
+                {VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC4_SNORM_BLOCK, 8},
+                {VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK, 16},
+                {VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK, 8},
+                {VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, 16},
+                {VK_FORMAT_EAC_R11_UNORM_BLOCK, VK_FORMAT_EAC_R11_SNORM_BLOCK, 8},
+                {VK_FORMAT_EAC_R11G11_UNORM_BLOCK, VK_FORMAT_EAC_R11G11_SNORM_BLOCK, 16},
+                {VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_12x12_SRGB_BLOCK, 16},
+                {VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK, VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK, 16},
+                {VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG, VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG, 8},
+                {VK_FORMAT_A4R4G4B4_UNORM_PACK16, VK_FORMAT_A4B4G4R4_UNORM_PACK16, 2},
+                {VK_FORMAT_G8B8G8R8_422_UNORM, VK_FORMAT_B8G8R8G8_422_UNORM, 4},
+                {VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM, VK_FORMAT_G8_B8_R8_3PLANE_444_UNORM, 1},
+                {VK_FORMAT_R10X6_UNORM_PACK16, VK_FORMAT_R10X6_UNORM_PACK16, 2},
+                {VK_FORMAT_R10X6G10X6_UNORM_2PACK16, VK_FORMAT_R10X6G10X6_UNORM_2PACK16, 4},
+                {VK_FORMAT_R10X6G10X6B10X6A10X6_UNORM_4PACK16, VK_FORMAT_B10X6G10X6R10X6G10X6_422_UNORM_4PACK16, 8},
+                {
+                        VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_420_UNORM_3PACK16,
+                        VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_444_UNORM_3PACK16, 2
+                },
+                {VK_FORMAT_R12X4_UNORM_PACK16, VK_FORMAT_R12X4_UNORM_PACK16, 2},
+                {VK_FORMAT_R12X4G12X4_UNORM_2PACK16, VK_FORMAT_R12X4G12X4_UNORM_2PACK16, 4},
+                {VK_FORMAT_R12X4G12X4B12X4A12X4_UNORM_4PACK16, VK_FORMAT_B12X4G12X4R12X4G12X4_422_UNORM_4PACK16, 8},
+                {
+                        VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_420_UNORM_3PACK16,
+                        VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_444_UNORM_3PACK16, 2
+                },
+                {VK_FORMAT_G16B16G16R16_422_UNORM, VK_FORMAT_B16G16R16G16_422_UNORM, 8},
+                {VK_FORMAT_G16_B16_R16_3PLANE_420_UNORM, VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM, 2},
+                {VK_FORMAT_G8_B8R8_2PLANE_444_UNORM, VK_FORMAT_G8_B8R8_2PLANE_444_UNORM, 1},
+                {VK_FORMAT_G10X6_B10X6R10X6_2PLANE_444_UNORM_3PACK16, VK_FORMAT_G16_B16R16_2PLANE_444_UNORM, 2},
+        };
+
+//  Second plane of two-plane formats holds both chroma components in each texel
+static VkBool32 is_two_plane(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_G8_B8R8_2PLANE_420_UNORM:
+    case VK_FORMAT_G8_B8R8_2PLANE_422_UNORM:
+    case VK_FORMAT_G8_B8R8_2PLANE_444_UNORM:
+    case VK_FORMAT_G10X6_B10X6R10X6_2PLANE_420_UNORM_3PACK16:
+    case VK_FORMAT_G10X6_B10X6R10X6_2PLANE_422_UNORM_3PACK16:
+    case VK_FORMAT_G10X6_B10X6R10X6_2PLANE_444_UNORM_3PACK16:
+    case VK_FORMAT_G12X4_B12X4R12X4_2PLANE_420_UNORM_3PACK16:
+    case VK_FORMAT_G12X4_B12X4R12X4_2PLANE_422_UNORM_3PACK16:
+    case VK_FORMAT_G12X4_B12X4R12X4_2PLANE_444_UNORM_3PACK16:
+    case VK_FORMAT_G16_B16R16_2PLANE_420_UNORM:
+    case VK_FORMAT_G16_B16R16_2PLANE_422_UNORM:
+    case VK_FORMAT_G16_B16R16_2PLANE_444_UNORM:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static VkBool32 is_depth_stencil(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+    case VK_FORMAT_S8_UINT:
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static VkDeviceSize greatest_common_divisor(VkDeviceSize a, VkDeviceSize b)
+{
+    while (b)
+    {
+        const VkDeviceSize r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+VkDeviceSize jvm_image_copy_alignment(VkDeviceSize base_alignment, VkFormat format, VkImageAspectFlags aspect)
+{
+    VkDeviceSize block_size = 0;
+    if (is_depth_stencil(format))
+    {
+        //  Offsets of depth and stencil copies only have to be a multiple of 4, whatever the size of a texel
+        block_size = 4;
+    }
+    else
+    {
+        for (unsigned i = 0; i < sizeof(FORMAT_RANGES) / sizeof(*FORMAT_RANGES); ++i)
+        {
+            if (format >= FORMAT_RANGES[i].first && format <= FORMAT_RANGES[i].last)
+            {
+                block_size = FORMAT_RANGES[i].block_size;
+                break;
+            }
+        }
+        if (block_size && (aspect & VK_IMAGE_ASPECT_PLANE_1_BIT) && is_two_plane(format))
+        {
+            block_size *= 2;
+        }
+    }
+    if (!block_size)
+    {
+        return 0;
+    }
+    //  Offset must be a multiple of 4 and of the block size, and should be one of the base alignment
+    const VkDeviceSize alignment = base_alignment < 4 ? 4 : base_alignment;
+    return alignment / greatest_common_divisor(alignment, block_size) * block_size;
+}
@@ -22,6 +22,11 @@ void jvm_free(const jvm_allocator* alc, void* ptr)
     alc->allocation_callbacks.free(alc->allocation_callbacks.state, ptr);
 }
 
+const VkAllocationCallbacks* jvm_vk_callbacks(const jvm_allocator* alc)
+{
+    return alc->has_vk_alloc ? &alc->vk_allocation_callbacks : NULL;
+}
+
 static void* default_alloc(void* state, uint64_t size)
 {
     assert((void*) 0xCafe == state);
@@ -20,8 +20,80 @@
 //      - alignment is equal or smaller than the allocation size
 //      - memory is externally synchronized
 
+//  Number of values of jvm_memory_usage
+#define JVM_MEMORY_USAGE_COUNT (JVM_MEMORY_USAGE_GPU_LAZY + 1)
+
+//  Priority of memory when none is given, as defined by VK_EXT_memory_priority
+#define JVM_DEFAULT_PRIORITY 0.5f
+
+//  Largest number of kernel sets for write-combined memory a CPU can support
+#define JVM_MAPPED_KERNEL_COUNT 4
+
+//  Index of the lowest set bit of a non-zero value
+static inline unsigned jvm_lowest_bit(uint64_t value)
+{
+#ifdef __GNUC__
+    return (unsigned) __builtin_ctzll(value);
+#else
+    unsigned i = 0;
+    while (!(value & 1))
+    {
+        value >>= 1;
+        i += 1;
+    }
+    return i;
+#endif
+}
+
+//  Index of the highest set bit of a non-zero value
+static inline unsigned jvm_highest_bit(uint64_t value)
+{
+#ifdef __GNUC__
+    return 63 - (unsigned) __builtin_clzll(value);
+#else
+    unsigned i = 0;
+    while (value >>= 1)
+    {
+        i += 1;
+    }
+    return i;
+#endif
+}
+
 typedef struct jvm_allocation_pool_T jvm_allocation_pool;
 typedef struct jvm_chunk_T jvm_chunk;
+typedef struct jvm_deferred_destruction_T jvm_deferred_destruction;
+typedef struct jvm_requirements_key_T jvm_requirements_key;
+typedef struct jvm_requirements_entry_T jvm_requirements_entry;
+typedef struct jvm_aliased_resource_T jvm_aliased_resource;
+typedef struct jvm_ring_segment_T jvm_ring_segment;
+typedef struct jvm_ring_T jvm_ring;
+typedef struct jvm_upload_copy_T jvm_upload_copy;
+typedef struct jvm_readback_slot_info_T jvm_readback_slot_info;
+typedef struct jvm_sparse_page_T jvm_sparse_page;
+typedef struct jvm_sparse_pages_T jvm_sparse_pages;
+typedef struct jvm_sparse_opaque_T jvm_sparse_opaque;
+typedef struct jvm_evictable_T jvm_evictable;
+typedef struct jvm_slot_T jvm_slot;
+typedef struct jvm_slab_T jvm_slab;
+typedef struct jvm_object_pool_T jvm_object_pool;
+typedef struct jvm_mapped_kernels_T jvm_mapped_kernels;
+
+//  Copies size bytes from src to dst, which is mapped device memory
+typedef void (*jvm_write_kernel)(void* dst, const void* src, size_t size);
+
+//  Sets size bytes of dst, which is mapped device memory, to value
+typedef void (*jvm_fill_kernel)(void* dst, int value, size_t size);
+
+//  Class of resource placed in a chunk, used to keep VkPhysicalDeviceLimits::bufferImageGranularity between linear and
+//  non-linear resources which are neighbours in the same memory
+typedef enum jvm_tiling_class_T
+{
+    JVM_TILING_CLASS_NONE = 0,      //  free chunk, or a resource which does not care about granularity
+    JVM_TILING_CLASS_LINEAR = 1,    //  buffers and images with VK_IMAGE_TILING_LINEAR
+    JVM_TILING_CLASS_OPTIMAL = 2,   //  images with any other tiling
+    JVM_TILING_CLASS_MIXED = 3,     //  both kinds of resources aliasing the same chunk
+} jvm_tiling_class;
 
 struct jvm_chunk_T
 {
@@ -31,6 +103,7 @@ struct jvm_chunk_T
 #endif
     VkBool32 mapped;         //  zero if not mapped
     VkBool32 used;           //  zero if not in use
+    jvm_tiling_class tiling; //  class of the resource in the chunk (JVM_TILING_CLASS_NONE when unused)
     VkDeviceSize size;           //  real size of the chunk (includes any padding and rounding)
     VkDeviceMemory memory;         //  memory handle of its pool
     VkDeviceSize chunk_offset;   //  where the chunk begins in the pool's memory
@@ -44,6 +117,7 @@ struct jvm_buffer_allocation_T
     jvm_chunk* allocation; //  The underlying memory allocation chunk
     VkBuffer buffer;     //  Vulkan buffer handle bound to memory
     VkDeviceSize buffer_size;   //  Size passed as VkBufferCreateInfo::size
+    jvm_evictable* evictable;   //  eviction state, or NULL if the buffer may not be evicted
 };
 
 struct jvm_image_allocation_T
@@ -52,6 +126,180 @@ struct jvm_image_allocation_T
     jvm_chunk* allocation; //  The underlying memory allocation chunk
     VkImage image;      //  Vulkan image handle bound to memory
     VkExtent3D extent;  //  Extent passed as VkImageCreateInfo::extent
+    VkFormat format;    //  Format passed as VkImageCreateInfo::format
+    jvm_evictable* evictable;   //  eviction state, or NULL if the image may not be evicted
+};
+
+struct jvm_memory_allocation_T
+{
+    jvm_allocator* allocator;  //  Allocator with which this was allocated with
+    jvm_chunk* allocation; //  The underlying memory allocation chunk
+    VkDeviceSize size;  //  Size from the memory requirements of the resource it was allocated for
+};
+
+//  Buffer or image which may be destroyed when its heap runs out of memory or goes over budget
+struct jvm_evictable_T
+{
+    jvm_buffer_allocation* buffer;      //  evictable buffer, or NULL if it is an image
+    jvm_image_allocation* image;        //  evictable image, or NULL if it is a buffer
+    jvm_eviction_callback callback;     //  called before the resource is destroyed
+    void* user_data;                    //  passed to the callback
+    uint64_t last_use;                  //  value after which the device no longer uses the resource
+    VkBool32 pinned;                    //  non-zero while the resource is being moved, so it may not be evicted
+    unsigned index;                     //  position in jvm_allocator::evictable
+};
+
+//  Kernels for write-combined memory which use the same instructions
+struct jvm_mapped_kernels_T
+{
+    const char* name;           //  name of the instruction set, for reports
+    jvm_write_kernel write;     //  copy kernel
+    jvm_fill_kernel fill;       //  fill kernel
+};
+
+struct jvm_aliased_resource_T
+{
+    VkBuffer buffer;        //  Vulkan buffer handle, or VK_NULL_HANDLE if the resource is an image
+    VkImage image;          //  Vulkan image handle, or VK_NULL_HANDLE if the resource is a buffer
+    VkDeviceSize offset;    //  Offset of the resource from the start of the group's memory
+};
+
+struct jvm_aliasing_group_T
+{
+    jvm_allocator* allocator;          //  Allocator with which this was allocated with
+    jvm_chunk* allocation;             //  The underlying memory allocation chunk shared by all resources
+    VkDeviceSize size;                 //  Memory needed by all resources together
+    uint32_t resource_count;           //  Number of resources in the group
+    jvm_aliased_resource* resources;   //  Resources in the order they were declared in
+};
+
+struct jvm_ring_segment_T
+{
+    uint64_t retire_value;      //  value after which the device no longer uses the segment
+    VkDeviceSize end;           //  offset where the segment ends
+    VkBool32 wrapped;           //  non-zero if the segment wraps around the end of the ring
+};
+
+//  Persistently mapped host-visible buffer, from which space is taken in order and returned in the same order once the
+//  device is done with it
+struct jvm_ring_T
+{
+    jvm_buffer_allocation* buffer;      //  buffer which holds the ring
+    uint8_t* ptr;                       //  mapping of the buffer
+    VkDeviceSize size;                  //  size of the buffer
+    VkMemoryPropertyFlags memory_flags; //  flags of the memory type the buffer was allocated from
+    VkDeviceSize begin;                 //  offset where data still in use begins
+    VkDeviceSize end;                   //  offset where data still in use ends
+    VkBool32 wrapped;                   //  non-zero if data in use wraps around the end of the ring
+    VkBool32 open;                      //  non-zero if there is data not yet in a segment
+    VkBool32 open_wrapped;              //  non-zero if data not yet in a segment wraps around the end of the ring
+    unsigned segment_count;             //  number of segments in use
+    unsigned segment_capacity;          //  maximum number of segments that can be held in jvm_ring::segments
+    jvm_ring_segment* segments;         //  segments in use, oldest first
+};
+
+//  Copy from the staging ring to either a buffer or an image, waiting to be recorded
+struct jvm_upload_copy_T
+{
+    VkBuffer buffer;                    //  destination buffer, or VK_NULL_HANDLE if the destination is an image
+    VkImage image;                      //  destination image, or VK_NULL_HANDLE if the destination is a buffer
+    VkImageLayout layout;               //  layout of the destination image at the time of the copy
+    VkBufferCopy buffer_region;         //  region to copy when the destination is a buffer
+    VkBufferImageCopy image_region;     //  region to copy when the destination is an image
+};
+
+struct jvm_uploader_T
+{
+    jvm_allocator* allocator;           //  Allocator with which this was created with
+    jvm_ring ring;                      //  staging ring
+    VkDeviceSize buffer_alignment;      //  alignment of staged data copied to buffers, and at least 4
+    unsigned copy_count;                //  number of copies waiting to be recorded
+    unsigned copy_capacity;             //  maximum number of copies that can be held in jvm_uploader::copies
+    jvm_upload_copy* copies;            //  copies waiting to be recorded, in order they were made in
+    VkBufferCopy* buffer_regions;       //  scratch array of copy_capacity regions passed to vkCmdCopyBuffer
+    VkBufferImageCopy* image_regions;   //  scratch array of copy_capacity regions passed to vkCmdCopyBufferToImage
+};
+
+struct jvm_readback_slot_info_T
+{
+    jvm_readback_slot slot;             //  handle given out for the slot, also used as its ring segment's retire value
+    VkDeviceSize offset;                //  offset of the slot in the ring
+    VkDeviceSize size;                  //  size of the data
+    uint64_t retire_value;              //  value after which the copy to the slot is done
+    VkBool32 ready;                     //  non-zero once the copy is done and visible to the host
+    VkBool32 released;                  //  non-zero once the slot is no longer needed
+};
+
+struct jvm_readback_T
+{
+    jvm_allocator* allocator;           //  Allocator with which this was created with
+    jvm_ring ring;                      //  readback ring
+    VkDeviceSize buffer_alignment;      //  alignment of slots copied to from buffers, and at least 4
+    VkDeviceSize atom_size;             //  VkPhysicalDeviceLimits::nonCoherentAtomSize
+    jvm_readback_slot next_slot;        //  handle of the next slot to be given out
+    VkBool32 copied;                    //  non-zero once any copy to the ring was recorded
+    uint64_t last_retire_value;         //  largest retire value of any copy to the ring
+    unsigned slot_count;                //  number of slots not yet returned to the ring
+    unsigned slot_capacity;             //  maximum number of slots that can be held in jvm_readback::slots
+    jvm_readback_slot_info* slots;      //  slots not yet returned to the ring, oldest first
+    VkMappedMemoryRange* ranges;        //  scratch array of slot_capacity ranges passed to vkInvalidateMappedMemoryRanges
+};
+
+struct jvm_sparse_page_T
+{
+    jvm_chunk* chunk;                   //  memory backing the page, or NULL if it is not resident
+    VkBool32 dirty;                     //  non-zero if the page changed since it was last bound
+};
+
+//  Pages of a sparse resource, all of the same size and from the same memory type
+struct jvm_sparse_pages_T
+{
+    jvm_allocator* allocator;           //  Allocator with which the resource was created with
+#ifdef JVM_TRACK_ALLOCATIONS
+    const char* file;                   //  where the resource was created, given to its pages
+    int line;
+#endif
+    uint32_t memory_type_index;         //  memory type of all pages
+    float priority;                     //  priority of all pages
+    VkDeviceSize page_size;             //  size of a single page, which is the sparse block size
+    jvm_tiling_class tiling;            //  class of the resource, given to its pages
+    uint32_t page_count;                //  number of pages of the resource
+    jvm_sparse_page* pages;             //  all pages of the resource
+    uint32_t dirty_count;               //  number of pages which need to be bound
+    uint32_t* dirty;                    //  indices of pages which need to be bound, with room for all pages
+    uint32_t resident_count;            //  number of resident pages
+};
+
+//  Range of an image bound opaquely for its whole lifetime, such as the mip tail or metadata
+struct jvm_sparse_opaque_T
+{
+    VkDeviceSize resource_offset;       //  offset of the range in the image
+    VkDeviceSize size;                  //  size of the range
+    VkSparseMemoryBindFlags flags;      //  flags of the bind
+    jvm_chunk* chunk;                   //  memory backing the range
+};
+
+struct jvm_sparse_buffer_T
+{
+    jvm_sparse_pages pages;             //  pages of the buffer
+    VkBuffer buffer;                    //  Vulkan buffer handle
+    VkDeviceSize buffer_size;           //  Size passed as VkBufferCreateInfo::size
+};
+
+struct jvm_sparse_image_T
+{
+    jvm_sparse_pages pages;             //  tiles of the image
+    VkImage image;                      //  Vulkan image handle
+    VkExtent3D extent;                  //  Extent passed as VkImageCreateInfo::extent
+    uint32_t array_layers;              //  VkImageCreateInfo::arrayLayers
+    VkImageAspectFlags aspect;          //  aspect of the image which is bound tile by tile
+    VkExtent3D granularity;             //  extent of a single tile in texels
+    uint32_t tail_first_lod;            //  first mip level in the mip tail, which is bound opaquely
+    uint32_t pages_per_layer;           //  number of tiles in a single array layer
+    uint32_t* mip_first_page;           //  index of the first tile of each mip level outside the mip tail within a layer
+    uint32_t opaque_count;              //  number of opaquely bound ranges
+    jvm_sparse_opaque* opaque;          //  opaquely bound ranges
+    VkBool32 opaque_dirty;              //  non-zero if the opaque ranges were not yet bound
 };
 
 struct jvm_allocation_pool_T
@@ -63,9 +311,79 @@ struct jvm_allocation_pool_T
     unsigned map_count;          //  How many chunks in the pool are currently mapped
     void* map_ptr;            //  Pointer to the memory mapping
     jvm_chunk** chunks;             //  Array of all chunks in the pool. At no point in time should two adjacent ones be unused (merge them)
+    VkDeviceSize* chunk_offsets;     //  offset of each chunk, kept packed next to each other so searches stay in cache
+    VkDeviceSize* chunk_sizes;       //  size of each chunk, packed the same way
+    uint64_t* unused_chunks;         //  bit i is set if chunk i is unused, all bits past the last chunk are clear
     VkMemoryType memory_type_info;   //  Memory type of the memory pool
     VkDeviceSize size;               //  Size of the pool
+    VkBool32 dedicated;              //  non-zero if the pool was made for a single resource and may not be shared
+    unsigned search_hint;            //  index of the chunk after the last one allocated, where fastest search begins
+    VkDeviceSize page_size;          //  size of a page if the pool is split into pages instead of chunks, zero otherwise
+    uint32_t page_count;             //  number of pages of a page pool
+    uint32_t free_page_count;        //  number of unused pages of a page pool
+    uint64_t* free_pages;            //  bit i is set if page i of a page pool is unused, all bits past the last are clear
+    jvm_tiling_class page_tiling;    //  class of all resources in a page pool with pages below bufferImageGranularity
+    float priority;                  //  priority the memory was allocated with, only allocations of equal one share it
+    jvm_allocation_lifetime lifetime;    //  expected lifetime of all allocations in the pool
+    VkExternalMemoryHandleTypeFlags export_handle_types; //  handle types the memory can be exported as, zero if none
+};
+//  Header in front of every object in a slab
+struct jvm_slot_T
+{
+    jvm_slot* next_free;     //  next free slot, only valid while this one is free
+    uint64_t generation;     //  incremented each time the slot is allocated or freed, so it is odd while in use
+};
+
+struct jvm_slab_T
+{
+    jvm_slab* next;          //  slab allocated before this one, or NULL
 };
+
+//  Objects of the same size, kept in slabs which are only freed with the allocator, so that allocating and freeing them
+//  needs no calls to allocation callbacks once enough slabs exist
+struct jvm_object_pool_T
+{
+    size_t slot_size;        //  size of the slot header together with the object, rounded up to the header alignment
+    unsigned slab_slots;     //  number of slots in each slab
+    jvm_slab* slabs;         //  most recently allocated slab
+    jvm_slot* free_slots;    //  list of free slots, least recently freed first
+    jvm_slot* free_tail;     //  most recently freed slot, at the end of the list, or NULL if there are none
+};
+
+struct jvm_deferred_destruction_T
+{
+    uint64_t retire_value;   //  timeline value or frame index after which the device no longer uses the resources
+    VkBuffer buffer;         //  buffer to destroy, or VK_NULL_HANDLE
+    VkImage image;           //  image to destroy, or VK_NULL_HANDLE
+    jvm_chunk* chunk;          //  chunk to return to its pool, or NULL
+};
+
+//  Normalized creation parameters which determine memory requirements of a buffer or an image. Zero-initialized before
+//  it is filled, so that it can be hashed and compared as raw bytes
+struct jvm_requirements_key_T
+{
+    uint32_t is_image;          //  zero for buffers, non-zero for images
+    VkFlags flags;              //  VkBufferCreateInfo::flags or VkImageCreateInfo::flags
+    VkFlags usage;              //  VkBufferCreateInfo::usage or VkImageCreateInfo::usage
+    uint32_t sharing_mode;      //  VkBufferCreateInfo::sharingMode or VkImageCreateInfo::sharingMode
+    VkDeviceSize size;          //  VkBufferCreateInfo::size (zero for images)
+    uint32_t image_type;        //  VkImageCreateInfo::imageType (zero for buffers)
+    uint32_t format;            //  VkImageCreateInfo::format (zero for buffers)
+    VkExtent3D extent;          //  VkImageCreateInfo::extent (zero for buffers)
+    uint32_t mip_levels;        //  VkImageCreateInfo::mipLevels (zero for buffers)
+    uint32_t array_layers;      //  VkImageCreateInfo::arrayLayers (zero for buffers)
+    uint32_t samples;           //  VkImageCreateInfo::samples (zero for buffers)
+    uint32_t tiling;            //  VkImageCreateInfo::tiling (zero for buffers)
+};
+
+struct jvm_requirements_entry_T
+{
+    uint64_t hash;                      //  hash of the key, zero if the entry is empty
+    jvm_requirements_key key;           //  creation parameters
+    VkMemoryRequirements requirements;  //  requirements reported by the driver
+    VkBool32 prefers_dedicated;         //  non-zero if the driver prefers or requires a dedicated allocation
+};
+
 struct jvm_allocator_T
 {
     jvm_allocation_callbacks allocation_callbacks;       //  Allocation callbacks and associated state
@@ -76,15 +394,60 @@ struct jvm_allocator_T
     VkPhysicalDevice physical_device;            //  physical device associated with the logical device
     VkDevice device;                     //  logical device interface to the Vulkan device
     VkPhysicalDeviceMemoryProperties memory_properties;          //  physical memory properties
+    uint32_t usage_type_counts[JVM_MEMORY_USAGE_COUNT];        //  number of memory types usable for each usage
+    uint32_t usage_types[JVM_MEMORY_USAGE_COUNT][VK_MAX_MEMORY_TYPES];  //  memory types for each usage, best first
 
     VkDeviceSize min_pool_size;              //  minimum size of individual pools
     VkBool32 automatically_free_unused;  //  if non-zero, a pool with only one unused chunk get freed ASAP
     VkDeviceSize min_allocation_size;        //  smallest memory allocation that can be made
     size_t min_map_alignment;          //  minimum alignment needed to be able to map memory
+    VkDeviceSize non_coherent_atom_size;   //  VkPhysicalDeviceLimits::nonCoherentAtomSize, at least one
+    VkDeviceSize optimal_buffer_copy_offset_alignment;   //  VkPhysicalDeviceLimits::optimalBufferCopyOffsetAlignment
+    jvm_write_kernel write_kernel;     //  copy into write-combined memory, chosen for the CPU at creation
+    jvm_fill_kernel fill_kernel;       //  fill of write-combined memory, chosen for the CPU at creation
+    VkDeviceSize buffer_image_granularity;   //  granularity at which linear and optimal resources may not share memory
+    VkBool32 separate_linear_and_optimal;   //  if non-zero, optimal tiling resources are placed from the end of pools
+    jvm_allocation_strategy default_strategy;   //  strategy used by allocations which do not specify one
+
+    VkBool32 dedicated_allocation;             //  non-zero if VkMemoryDedicatedAllocateInfo can be used
+    PFN_vkGetBufferMemoryRequirements2 get_buffer_memory_requirements2;  //  NULL if dedicated allocations are not enabled
+    PFN_vkGetImageMemoryRequirements2 get_image_memory_requirements2;    //  NULL if dedicated allocations are not enabled
+    PFN_vkGetDeviceBufferMemoryRequirements get_device_buffer_memory_requirements;  //  NULL if maintenance4 is not enabled
+    PFN_vkGetDeviceImageMemoryRequirements get_device_image_memory_requirements;    //  NULL if maintenance4 is not enabled
+    VkBool32 memory_priority;                  //  non-zero if VkMemoryPriorityAllocateInfoEXT can be used
+    VkDeviceSize page_size;                    //  size of pages of page pools for regular allocations, zero if not used
+    uint32_t page_memory_type_bits;            //  memory types of which regular allocations go to page pools
+    PFN_vkSetDeviceMemoryPriorityEXT set_device_memory_priority;         //  NULL if pageable memory is not enabled
+    PFN_vkBindBufferMemory2 bind_buffer_memory2;     //  NULL if neither Vulkan 1.1 nor VK_KHR_bind_memory2 is there
+    PFN_vkBindImageMemory2 bind_image_memory2;       //  NULL if neither Vulkan 1.1 nor VK_KHR_bind_memory2 is there
+    PFN_vkGetMemoryFdKHR get_memory_fd;              //  NULL if external memory file descriptors are not enabled
+    PFN_vkGetMemoryFdPropertiesKHR get_memory_fd_properties;             //  NULL if external memory file descriptors are not enabled
+    PFN_vkGetMemoryHostPointerPropertiesEXT get_memory_host_pointer_properties;  //  NULL if host memory import is not enabled
+    VkDeviceSize min_imported_host_pointer_alignment;   //  alignment of imported host memory, zero if not enabled
 
     unsigned pool_count;                 //  current number of memory pools
     unsigned pool_capacity;              //  maximum number of memory pools that can be put in the pool
     jvm_allocation_pool** pools;                      //  array of memory pools
+
+    unsigned deferred_count;             //  current number of queued deferred destructions
+    unsigned deferred_capacity;          //  maximum number of deferred destructions that can be held in the queue
+    jvm_deferred_destruction* deferred;                 //  queue of destructions waiting for the device to finish
+
+    uint64_t completed_value;            //  largest value passed to jvm_allocator_report_progress
+    VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS];    //  size of all pools on each heap
+    VkDeviceSize heap_budget[VK_MAX_MEMORY_HEAPS];   //  size of pools on each heap to stay under, zero if unlimited
+    unsigned evictable_count;            //  number of evictable resources
+    unsigned evictable_capacity;         //  maximum number of evictable resources that can be held in the array
+    jvm_evictable** evictable;                          //  all evictable resources, in no particular order
+
+    jvm_object_pool chunk_objects;       //  slabs of jvm_chunk
+    jvm_object_pool buffer_objects;      //  slabs of jvm_buffer_allocation
+    jvm_object_pool image_objects;       //  slabs of jvm_image_allocation
+    jvm_object_pool memory_objects;      //  slabs of jvm_memory_allocation
+
+    unsigned requirements_count;         //  number of entries in the memory requirements cache
+    unsigned requirements_capacity;      //  size of the memory requirements cache hash table (zero or a power of two)
+    jvm_requirements_entry* requirements;               //  open addressing hash table of known memory requirements
 };
 
 //  General functions (internal use)
@@ -92,7 +455,7 @@ struct jvm_allocator_T
 JVM_INTERNAL_SYMBOL
 VkResult jvm_allocate(
         jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize alignment, uint32_t type_bits,
-        VkMemoryPropertyFlags desired_flags, VkMemoryPropertyFlags undesired_flags, jvm_chunk** p_out
+        const jvm_allocation_create_info* allocation_info, jvm_tiling_class tiling, jvm_chunk** p_out
 #ifdef JVM_TRACK_ALLOCATIONS
         ,const char* file, int line
 #endif
@@ -101,15 +464,104 @@ VkResult jvm_allocate(
 JVM_INTERNAL_SYMBOL
 VkResult jvm_allocate_dedicated(
         jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize alignment, uint32_t type_bits,
-        VkMemoryPropertyFlags desired_flags, VkMemoryPropertyFlags undesired_flags, jvm_chunk** p_out
+        const jvm_allocation_create_info* allocation_info, jvm_tiling_class tiling,
+        const VkMemoryDedicatedAllocateInfo* dedicated_info, jvm_chunk** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+//  Allocates memory of the given size from a file descriptor or a host pointer described by import_info, as a pool of
+//  its own. The chunk covers all the memory, with its padding set to where the resource is
+JVM_INTERNAL_SYMBOL
+VkResult jvm_import_memory(
+        jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize offset, uint32_t idx,
+        const VkMemoryDedicatedAllocateInfo* dedicated_info, const void* import_info, jvm_tiling_class tiling,
+        jvm_chunk** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+);
+
+//  Allocates memory for pages of a sparse resource. These come from page pools, and all of the resource's pages are of
+//  the same memory type, so it is chosen by the caller
+JVM_INTERNAL_SYMBOL
+VkResult jvm_allocate_sparse_page(
+        jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize alignment, uint32_t memory_type_index,
+        jvm_tiling_class tiling, float priority, jvm_chunk** p_out
 #ifdef JVM_TRACK_ALLOCATIONS
         ,const char* file, int line
 #endif
 );
 
+//  Returns priority with which memory of the allocation is allocated. This is the same for all allocations if memory
+//  priority is not enabled, so that they can all share pools
+JVM_INTERNAL_SYMBOL
+float jvm_allocation_priority(const jvm_allocator* allocator, const jvm_allocation_create_info* allocation_info);
+
+//  Finds the memory type index which is allowed by type_bits, has all desired and none of the undesired flags. Returns
+//  VK_ERROR_OUT_OF_DEVICE_MEMORY if there is none. Only depends on memory properties, so it needs no device
+JVM_INTERNAL_SYMBOL
+VkResult jvm_find_memory_type(
+        const VkPhysicalDeviceMemoryProperties* memory_properties, uint32_t type_bits, VkMemoryPropertyFlags desired_flags,
+        VkMemoryPropertyFlags undesired_flags, uint32_t* p_index);
+
+//  Ranks memory types for each usage, best first, leaving out those which must not be used for it. Only depends on
+//  device properties, so it needs no device
+JVM_INTERNAL_SYMBOL
+void jvm_rank_memory_types(
+        const VkPhysicalDeviceMemoryProperties* memory_properties, VkPhysicalDeviceType device_type,
+        uint32_t type_counts[JVM_MEMORY_USAGE_COUNT], uint32_t types[JVM_MEMORY_USAGE_COUNT][VK_MAX_MEMORY_TYPES]);
+
+//  Chooses the memory type for an allocation based on its usage, desired and undesired flags. Lazily allocated memory is
+//  only chosen if allow_lazy is non-zero
+JVM_INTERNAL_SYMBOL
+VkResult jvm_choose_memory_type(
+        const jvm_allocator* allocator, uint32_t type_bits, const jvm_allocation_create_info* allocation_info,
+        VkBool32 allow_lazy, uint32_t* p_index);
+
+//  Adjusts flags of an image with VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, so that it goes to non-mappable lazily
+//  allocated memory, or to device local memory if the device has none. Returns non-zero if lazily allocated memory is
+//  used, in which case the allocation must be dedicated
+JVM_INTERNAL_SYMBOL
+VkBool32 jvm_transient_attachment_flags(
+        const VkPhysicalDeviceMemoryProperties* memory_properties, uint32_t type_bits,
+        VkMemoryPropertyFlags* p_desired_flags, VkMemoryPropertyFlags* p_undesired_flags);
+
+//  Resources which would take up most of a pool are better off on their own
+JVM_INTERNAL_SYMBOL
+VkBool32 jvm_should_be_dedicated(const jvm_allocator* allocator, VkDeviceSize size, VkBool32 prefers_dedicated);
+
 JVM_INTERNAL_SYMBOL
 VkResult jvm_deallocate(jvm_allocator* allocator, jvm_chunk* chunk);
 
+//  Sets up the chunk arrays of a pool of given size as a single unused chunk. Returns zero when memory allocation fails
+JVM_INTERNAL_SYMBOL
+int jvm_init_pool_chunks(jvm_allocator* allocator, jvm_allocation_pool* pool, VkDeviceSize size);
+
+//  Frees all chunks of the pool and its arrays, but not its memory
+JVM_INTERNAL_SYMBOL
+void jvm_free_pool_metadata(jvm_allocator* allocator, jvm_allocation_pool* pool);
+
+//  Places a resource into one of the pool's unused chunks. Returns 0 when found, > 0 when no chunk was good, < 0 when
+//  memory allocation fails
+JVM_INTERNAL_SYMBOL
+int jvm_allocate_from_pool(
+        jvm_allocator* allocator, jvm_allocation_pool* pool, VkDeviceSize size, VkDeviceSize alignment,
+        jvm_tiling_class tiling, jvm_allocation_strategy strategy, jvm_chunk** p_out);
+
+//  Marks the chunk as unused and merges it with its unused neighbours. Returns 0 when successful, non-zero when the
+//  chunk is not from the pool
+JVM_INTERNAL_SYMBOL
+int jvm_deallocate_from_pool(jvm_allocator* allocator, jvm_allocation_pool* pool, jvm_chunk* chunk);
+
+JVM_INTERNAL_SYMBOL
+VkResult jvm_reserve_deferred(jvm_allocator* allocator, unsigned count);
+
+JVM_INTERNAL_SYMBOL
+VkResult jvm_defer_destruction(
+        jvm_allocator* allocator, uint64_t retire_value, VkBuffer buffer, VkImage image, jvm_chunk* chunk);
+
 JVM_INTERNAL_SYMBOL
 VkResult jvm_chunk_map(jvm_allocator* allocator, jvm_chunk* chunk, size_t* p_size, void** p_out);
 
@@ -122,6 +574,164 @@ VkResult jvm_chunk_mapped_flush(jvm_allocator* allocator, jvm_chunk* chunk);
 JVM_INTERNAL_SYMBOL
 VkResult jvm_chunk_mapped_invalidate(jvm_allocator* allocator, jvm_chunk* chunk);
 
+//  Writes directly to memory of a chunk, which must be host-visible. Offset is relative to the start of the resource
+JVM_INTERNAL_SYMBOL
+VkResult jvm_chunk_write(
+        jvm_allocator* allocator, jvm_chunk* chunk, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+//  Fills memory of a chunk, which must be host-visible, with a byte value. Offset is relative to the start of the
+//  resource
+JVM_INTERNAL_SYMBOL
+VkResult jvm_chunk_fill(
+        jvm_allocator* allocator, jvm_chunk* chunk, VkDeviceSize offset, uint8_t value, VkDeviceSize size);
+
+
+//  Page pools (pages.c)
+
+//  Splits a newly created pool into pages of the given size, all of them unused. Returns zero when memory allocation fails
+JVM_INTERNAL_SYMBOL
+int jvm_page_pool_init(jvm_allocator* allocator, jvm_allocation_pool* pool, VkDeviceSize page_size);
+
+//  Finds the first run of count unused pages in the pool. Returns non-zero and the index of its first page if found
+JVM_INTERNAL_SYMBOL
+int jvm_page_pool_find(const jvm_allocation_pool* pool, uint32_t count, uint32_t* p_first);
+
+//  Marks the run of pages as used and returns a chunk describing it, or NULL when memory allocation fails. The chunk is
+//  not part of the pool's chunk arrays
+JVM_INTERNAL_SYMBOL
+jvm_chunk* jvm_page_pool_take(
+        jvm_allocator* allocator, jvm_allocation_pool* pool, uint32_t first, uint32_t count, jvm_tiling_class tiling);
+
+//  Marks pages of the chunk as unused and frees the chunk
+JVM_INTERNAL_SYMBOL
+void jvm_page_pool_give_back(jvm_allocator* allocator, jvm_chunk* chunk);
+
+//  Extends the chunk to count pages by taking the pages right after it, if they are all unused. Returns non-zero if the
+//  chunk has at least count pages afterwards. If commit is zero, only checks whether it could be extended
+JVM_INTERNAL_SYMBOL
+int jvm_page_pool_grow(jvm_allocation_pool* pool, jvm_chunk* chunk, uint32_t count, VkBool32 commit);
+
+//  Slabs (slab.c)
+
+//  Prepares a pool of objects of the given size, without allocating any slabs yet
+JVM_INTERNAL_SYMBOL
+void jvm_object_pool_init(jvm_object_pool* pool, size_t object_size, unsigned slab_slots);
+
+//  Frees all slabs of the pool, including any objects which are still in use
+JVM_INTERNAL_SYMBOL
+void jvm_object_pool_release(jvm_allocator* allocator, jvm_object_pool* pool);
+
+//  Takes a free object from the pool, allocating a new slab if there is none. Returns NULL if that fails
+JVM_INTERNAL_SYMBOL
+void* jvm_object_alloc(jvm_allocator* allocator, jvm_object_pool* pool);
+
+//  Returns an object to the pool. Objects which are not in use (freed twice) are reported and ignored, as long as their
+//  slot was not handed out again since
+JVM_INTERNAL_SYMBOL
+void jvm_object_free(jvm_allocator* allocator, jvm_object_pool* pool, void* object);
+
+//  Eviction (eviction.c)
+
+//  Destroys the least recently used evictable resource on the heap, which the device is done with. Returns non-zero if
+//  there was such a resource
+JVM_INTERNAL_SYMBOL
+VkBool32 jvm_evict_lru(jvm_allocator* allocator, uint32_t heap_index);
+
+//  Stops tracking the resource for eviction
+JVM_INTERNAL_SYMBOL
+void jvm_evictable_remove(jvm_allocator* allocator, jvm_evictable* evictable);
+
+
+//  Ring buffers (ring.c)
+
+//  Creates a ring buffer of given size in host-visible memory best suited to the memory usage
+JVM_INTERNAL_SYMBOL
+VkResult jvm_ring_create(
+        jvm_allocator* allocator, VkDeviceSize size, VkBufferUsageFlags usage, jvm_memory_usage memory_usage,
+        jvm_ring* p_ring);
+
+//  Destroys the ring buffer, once retire_value is reached if the device may still be using it
+JVM_INTERNAL_SYMBOL
+void jvm_ring_destroy(jvm_allocator* allocator, jvm_ring* ring, VkBool32 in_use, uint64_t retire_value);
+
+//  Takes space from the ring at an offset which is a multiple of alignment, which need not be a power of two. Returns
+//  VK_NOT_READY if there is currently not enough free space, or VK_ERROR_OUT_OF_DEVICE_MEMORY if the ring is too small
+//  to ever have it
+JVM_INTERNAL_SYMBOL
+VkResult jvm_ring_acquire(jvm_ring* ring, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* p_offset);
+
+//  Puts all space taken since the last call into a segment, which is returned once retire_value is reached
+JVM_INTERNAL_SYMBOL
+VkResult jvm_ring_close(jvm_allocator* allocator, jvm_ring* ring, uint64_t retire_value);
+
+//  Returns space of all segments with retire value up to and including completed_value
+JVM_INTERNAL_SYMBOL
+void jvm_ring_retire(jvm_ring* ring, uint64_t completed_value);
+
+
+//  Formats (format.c)
+
+//  Returns the alignment of a buffer offset for copies between buffers and the aspect of images of the format. It is
+//  a multiple of base_alignment, 4 and the texel block size, or zero if the block size of the format is not known
+JVM_INTERNAL_SYMBOL
+VkDeviceSize jvm_image_copy_alignment(VkDeviceSize base_alignment, VkFormat format, VkImageAspectFlags aspect);
+
+
+//  Writes to mapped memory (copy.c)
+
+//  Writes all kernels for write-combined memory the CPU supports to p_kernels, slowest first, and returns their number,
+//  which is at most JVM_MAPPED_KERNEL_COUNT
+JVM_INTERNAL_SYMBOL
+unsigned jvm_supported_mapped_kernels(jvm_mapped_kernels* p_kernels);
+
+//  Picks the fastest kernels for write-combined memory the CPU supports
+JVM_INTERNAL_SYMBOL
+void jvm_select_mapped_kernels(jvm_allocator* allocator);
+
+//  Copies into mapped memory of a type with the given flags, streaming past the cache unless the memory is host cached
+JVM_INTERNAL_SYMBOL
+void jvm_mapped_copy(
+        const jvm_allocator* allocator, VkMemoryPropertyFlags flags, void* dst, const void* src, size_t size);
+
+//  Fills mapped memory of a type with the given flags, streaming past the cache unless the memory is host cached
+JVM_INTERNAL_SYMBOL
+void jvm_mapped_set(const jvm_allocator* allocator, VkMemoryPropertyFlags flags, void* dst, int value, size_t size);
+
+
+//  Memory requirement queries (requirements.c)
+
+JVM_INTERNAL_SYMBOL
+void jvm_query_buffer_memory_requirements(
+        const jvm_allocator* allocator, VkBuffer buffer, VkMemoryRequirements* p_req, VkBool32* p_prefers_dedicated);
+
+JVM_INTERNAL_SYMBOL
+void jvm_query_image_memory_requirements(
+        const jvm_allocator* allocator, VkImage image, VkMemoryRequirements* p_req, VkBool32* p_prefers_dedicated);
+
+//  Returns non-zero if the requirements could be found without creating the buffer
+JVM_INTERNAL_SYMBOL
+VkBool32 jvm_find_buffer_memory_requirements(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, VkMemoryRequirements* p_req,
+        VkBool32* p_prefers_dedicated);
+
+//  Returns non-zero if the requirements could be found without creating the image
+JVM_INTERNAL_SYMBOL
+VkBool32 jvm_find_image_memory_requirements(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, VkMemoryRequirements* p_req,
+        VkBool32* p_prefers_dedicated);
+
+JVM_INTERNAL_SYMBOL
+void jvm_cache_buffer_memory_requirements(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, const VkMemoryRequirements* req,
+        VkBool32 prefers_dedicated);
+
+JVM_INTERNAL_SYMBOL
+void jvm_cache_image_memory_requirements(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, const VkMemoryRequirements* req,
+        VkBool32 prefers_dedicated);
+
+JVM_INTERNAL_SYMBOL
+const VkAllocationCallbacks* jvm_vk_callbacks(const jvm_allocator* alc);
 
 JVM_INTERNAL_SYMBOL
 void* jvm_alloc(const jvm_allocator* alc, uint64_t size);
@@ -9,25 +9,96 @@
 
 #undef jvm_buffer_create
 #undef jvm_image_create
+#undef jvm_buffer_create2
+#undef jvm_image_create2
+#undef jvm_buffer_resize
 
-static const VkAllocationCallbacks* allocator_vk_callbacks(const jvm_allocator* this)
+//  Grows arrays of chunk information of the pool to hold new_capacity chunks. Returns zero when memory allocation fails,
+//  in which case the capacity stays the same
+static int grow_chunk_arrays(jvm_allocator* this, jvm_allocation_pool* pool, unsigned new_capacity)
 {
-    return this->has_vk_alloc ? &this->vk_allocation_callbacks : NULL;
+    const unsigned old_words = (pool->chunk_capacity + 63) / 64;
+    const unsigned new_words = (new_capacity + 63) / 64;
+    jvm_chunk** const chunks = jvm_realloc(this, pool->chunks, sizeof(*chunks) * new_capacity);
+    if (!chunks)
+    {
+        return 0;
+    }
+    pool->chunks = chunks;
+    VkDeviceSize* const offsets = jvm_realloc(this, pool->chunk_offsets, sizeof(*offsets) * new_capacity);
+    if (!offsets)
+    {
+        return 0;
+    }
+    pool->chunk_offsets = offsets;
+    VkDeviceSize* const sizes = jvm_realloc(this, pool->chunk_sizes, sizeof(*sizes) * new_capacity);
+    if (!sizes)
+    {
+        return 0;
+    }
+    pool->chunk_sizes = sizes;
+    uint64_t* const unused = jvm_realloc(this, pool->unused_chunks, sizeof(*unused) * new_words);
+    if (!unused)
+    {
+        return 0;
+    }
+    memset(unused + old_words, 0, sizeof(*unused) * (new_words - old_words));
+    pool->unused_chunks = unused;
+    pool->chunk_capacity = new_capacity;
+    return 1;
 }
 
-static void free_pool(jvm_allocator* this, jvm_allocation_pool* pool)
+static void free_chunk_arrays(jvm_allocator* this, jvm_allocation_pool* pool)
+{
+    jvm_free(this, pool->unused_chunks);
+    jvm_free(this, pool->chunk_sizes);
+    jvm_free(this, pool->chunk_offsets);
+    jvm_free(this, pool->chunks);
+}
+
+//  Frees all chunks of the pool and its arrays, but not its memory
+void jvm_free_pool_metadata(jvm_allocator* this, jvm_allocation_pool* pool)
 {
     for (unsigned i = 0; i < pool->chunk_count; ++i)
     {
-        jvm_free(this, pool->chunks[i]);
+        jvm_object_free(this, &this->chunk_objects, pool->chunks[i]);
     }
-    jvm_free(this, pool->chunks);
-    vkFreeMemory(this->device, pool->memory, allocator_vk_callbacks(this));
+    free_chunk_arrays(this, pool);
+    jvm_free(this, pool->free_pages);
+}
+
+//  Returns non-zero if nothing is allocated from the pool
+static int pool_is_unused(const jvm_allocation_pool* pool)
+{
+    return pool->page_size ? pool->free_page_count == pool->page_count
+                           : pool->chunk_count == 1 && !pool->chunks[0]->used;
+}
+
+//  Returns non-zero if the pool should be released as soon as it is unused
+static int pool_released_when_unused(const jvm_allocator* allocator, const jvm_allocation_pool* pool)
+{
+    return pool->dedicated || pool->lifetime == JVM_ALLOCATION_LIFETIME_LEVEL ||
+           (allocator->automatically_free_unused && pool->lifetime != JVM_ALLOCATION_LIFETIME_FRAME);
+}
+
+static void free_pool(jvm_allocator* this, jvm_allocation_pool* pool)
+{
+    jvm_free_pool_metadata(this, pool);
+    vkFreeMemory(this->device, pool->memory, jvm_vk_callbacks(this));
     jvm_free(this, pool);
 }
 
 void jvm_allocator_destroy(jvm_allocator* allocator)
 {
+    //  Allocator is destroyed after the device is idle, so anything still queued can go
+    (void) jvm_allocator_report_progress(allocator, UINT64_MAX);
+    jvm_free(allocator, allocator->deferred);
+    jvm_free(allocator, allocator->requirements);
+    for (unsigned i = 0; i < allocator->evictable_count; ++i)
+    {
+        jvm_free(allocator, allocator->evictable[i]);
+    }
+    jvm_free(allocator, allocator->evictable);
     for (unsigned i = 0; i < allocator->pool_count; ++i)
     {
         jvm_allocation_pool* const pool = allocator->pools[i];
@@ -36,6 +107,11 @@ void jvm_allocator_destroy(jvm_allocator* allocator)
         {
             JVM_ERROR(allocator, "Pool at index %u has %u chunks left, which were not free-d yet", i, chunks_left);
         }
+        if (pool->free_page_count != pool->page_count)
+        {
+            JVM_ERROR(allocator, "Pool at index %u has %u pages left, which were not free-d yet", i,
+                      pool->page_count - pool->free_page_count);
+        }
 #ifdef JVM_TRACK_ALLOCATIONS
         for (unsigned j = 0; j < pool->chunk_count; ++j)
         {
@@ -50,10 +126,50 @@ void jvm_allocator_destroy(jvm_allocator* allocator)
         free_pool(allocator, pool);
     }
     jvm_free(allocator, allocator->pools);
+    jvm_object_pool_release(allocator, &allocator->chunk_objects);
+    jvm_object_pool_release(allocator, &allocator->buffer_objects);
+    jvm_object_pool_release(allocator, &allocator->image_objects);
+    jvm_object_pool_release(allocator, &allocator->memory_objects);
     jvm_free(allocator, allocator);
 }
 
-static VkResult create_new_pool(jvm_allocator* this, VkDeviceSize mem_size, uint32_t idx, VkMemoryType mem_info)
+int jvm_init_pool_chunks(jvm_allocator* this, jvm_allocation_pool* pool, VkDeviceSize size)
+{
+    if (!grow_chunk_arrays(this, pool, 32))
+    {
+        JVM_ERROR(this, "Could not allocate memory for the pool chunk arrays");
+        free_chunk_arrays(this, pool);
+        return 0;
+    }
+    jvm_chunk* const whole_chunk = jvm_object_alloc(this, &this->chunk_objects);
+    if (!whole_chunk)
+    {
+        JVM_ERROR(this, "Could not allocate memory for the pool's initial chunk");
+        free_chunk_arrays(this, pool);
+        return 0;
+    }
+    *whole_chunk = (jvm_chunk)
+            {
+                    .chunk_offset = 0,
+                    .size = size,
+                    .padding = 0,
+                    .used = 0,
+                    .tiling = JVM_TILING_CLASS_NONE,
+                    .mapped = 0,
+                    .pool = pool,
+            };
+    pool->chunk_count = 1;
+    pool->chunks[0] = whole_chunk;
+    pool->chunk_offsets[0] = 0;
+    pool->chunk_sizes[0] = size;
+    pool->unused_chunks[0] = 1;
+    return 1;
+}
+
+static VkResult create_new_pool(
+        jvm_allocator* this, VkDeviceSize mem_size, uint32_t idx, VkMemoryType mem_info, VkBool32 dedicated,
+        const VkMemoryDedicatedAllocateInfo* dedicated_info, float priority, VkDeviceSize page_size,
+        const void* external_info)
 {
     jvm_allocation_pool* const pool = jvm_alloc(this, sizeof(*pool));
     if (!pool)
@@ -75,23 +191,36 @@ static VkResult create_new_pool(jvm_allocator* this, VkDeviceSize mem_size, uint
         this->pools = new_ptr;
         this->pool_capacity = new_capacity;
     }
-    pool->chunk_count = 1;
-    pool->chunk_capacity = 32;
-    pool->chunks = jvm_alloc(this, sizeof(*pool->chunks) * pool->chunk_capacity);
-    if (!pool->chunks)
+    pool->chunk_count = 0;
+    pool->chunk_capacity = 0;
+    pool->chunks = NULL;
+    pool->chunk_offsets = NULL;
+    pool->chunk_sizes = NULL;
+    pool->unused_chunks = NULL;
+    pool->page_size = 0;
+    pool->page_count = 0;
+    pool->free_page_count = 0;
+    pool->free_pages = NULL;
+    pool->page_tiling = JVM_TILING_CLASS_NONE;
+    pool->lifetime = JVM_ALLOCATION_LIFETIME_DEFAULT;
+    pool->export_handle_types = 0;
+    pool->size = mem_size;
+    if (page_size)
     {
-        JVM_ERROR(this, "Could not allocate memory for the pool chunk array");
-        jvm_free(this, pool);
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
+        //  Page pools have no chunks, only a bitmap of their pages
+        if (!jvm_page_pool_init(this, pool, page_size))
+        {
+            jvm_free(this, pool);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
     }
-
-    jvm_chunk* const whole_chunk = jvm_alloc(this, sizeof(*whole_chunk));
-    if (!whole_chunk)
+    else
     {
-        JVM_ERROR(this, "Could not allocate memory for the pool's initial chunk");
-        jvm_free(this, pool->chunks);
-        jvm_free(this, pool);
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
+        if (!jvm_init_pool_chunks(this, pool, mem_size))
+        {
+            jvm_free(this, pool);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
     }
 
     pool->map_count = 0;
@@ -99,35 +228,48 @@ static VkResult create_new_pool(jvm_allocator* this, VkDeviceSize mem_size, uint
 
     pool->memory_type_index = idx;
     pool->memory_type_info = mem_info;
-    pool->size = mem_size;
+    pool->dedicated = dedicated;
+    pool->search_hint = 0;
+    pool->priority = priority;
 
+    //  Chained as priority -> dedicated -> export or import, leaving out what is not used
+    VkMemoryDedicatedAllocateInfo dedicated_next;
+    const void* next = external_info;
+    if (dedicated_info)
+    {
+        dedicated_next = *dedicated_info;
+        dedicated_next.pNext = next;
+        next = &dedicated_next;
+    }
+    const VkMemoryPriorityAllocateInfoEXT priority_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT,
+                    .pNext = next,
+                    .priority = priority,
+            };
     VkMemoryAllocateInfo allocate_info =
             {
                     .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                    .pNext = this->memory_priority ? (const void*) &priority_info : next,
                     .allocationSize = mem_size,
                     .memoryTypeIndex = idx,
             };
     VkDeviceMemory mem = VK_NULL_HANDLE;
-    VkResult res = vkAllocateMemory(this->device, &allocate_info, allocator_vk_callbacks(this), &mem);
+    VkResult res = vkAllocateMemory(this->device, &allocate_info, jvm_vk_callbacks(this), &mem);
     if (res != VK_SUCCESS)
     {
-        JVM_ERROR(this, "Could not allocate device memory");
+        //  Reported by the caller, which may still recover from it
+        jvm_free_pool_metadata(this, pool);
         jvm_free(this, pool);
         return res;
     }
-    *whole_chunk = (jvm_chunk)
-            {
-                    .chunk_offset = 0,
-                    .size = mem_size,
-                    .padding = 0,
-                    .used = 0,
-                    .mapped = 0,
-                    .memory = mem,
-                    .pool = pool,
-            };
-    pool->chunks[0] = whole_chunk;
+    if (pool->chunk_count)
+    {
+        pool->chunks[0]->memory = mem;
+    }
 
     pool->memory = mem;
+    this->heap_usage[mem_info.heapIndex] += mem_size;
 
     this->pools[this->pool_count] = pool;
     this->pool_count += 1;
@@ -137,9 +279,9 @@ static VkResult create_new_pool(jvm_allocator* this, VkDeviceSize mem_size, uint
 //  Returns 0 on success, -1 when pool is not from this allocator, -2 when there are still chunks within the pool
 static int remove_pool(jvm_allocator* this, jvm_allocation_pool* pool)
 {
-    if (pool->chunk_count > 1 || pool->chunks[0]->used)
+    if (!pool_is_unused(pool))
     {
-        JVM_ERROR(this, "Pool still has %u allocated chunks left", pool->chunk_count);
+        JVM_ERROR(this, "Pool still has allocations left");
         return -2;
     }
     unsigned pos;
@@ -162,13 +304,24 @@ static int remove_pool(jvm_allocator* this, jvm_allocation_pool* pool)
         memmove(this->pools + pos, this->pools + pos + 1, sizeof(jvm_allocation_pool*) * (this->pool_count - 1 - pos));
     }
     this->pool_count -= 1;
-    vkFreeMemory(this->device, pool->memory, allocator_vk_callbacks(this));
-    jvm_free(this, *pool->chunks);
-    jvm_free(this, pool->chunks);
+    this->heap_usage[pool->memory_type_info.heapIndex] -= pool->size;
+    vkFreeMemory(this->device, pool->memory, jvm_vk_callbacks(this));
+    jvm_free_pool_metadata(this, pool);
     jvm_free(this, pool);
     return 0;
 }
 
+//  Loads a device function by its core name, falling back to the name of the extension which introduced it
+static PFN_vkVoidFunction load_device_function(VkDevice device, const char* core_name, const char* extension_name)
+{
+    PFN_vkVoidFunction fn = vkGetDeviceProcAddr(device, core_name);
+    if (!fn && extension_name)
+    {
+        fn = vkGetDeviceProcAddr(device, extension_name);
+    }
+    return fn;
+}
+
 VkResult jvm_allocator_create(
         jvm_allocator_create_info create_info, const VkAllocationCallbacks* vk_allocation_callbacks,
         jvm_allocator** p_out)
@@ -196,15 +349,27 @@ VkResult jvm_allocator_create(
         this->vk_allocation_callbacks = *vk_allocation_callbacks;
     }
 
+    this->physical_device = info.physical_device;
     this->device = info.device;
 
     this->pool_capacity = 0;
     this->pool_count = 0;
     this->pools = NULL;
 
+    this->deferred_capacity = 0;
+    this->deferred_count = 0;
+    this->deferred = NULL;
+
     VkPhysicalDeviceProperties props;
     vkGetPhysicalDeviceProperties(info.physical_device, &props);
     this->min_map_alignment = props.limits.minMemoryMapAlignment;
+    this->non_coherent_atom_size = props.limits.nonCoherentAtomSize ? props.limits.nonCoherentAtomSize : 1;
+    jvm_select_mapped_kernels(this);
+    this->optimal_buffer_copy_offset_alignment = props.limits.optimalBufferCopyOffsetAlignment;
+    this->buffer_image_granularity = props.limits.bufferImageGranularity;
+    this->separate_linear_and_optimal = info.separate_linear_and_optimal;
+    this->default_strategy = info.default_strategy != JVM_ALLOCATION_STRATEGY_DEFAULT
+                             ? info.default_strategy : JVM_ALLOCATION_STRATEGY_FIRST_FIT;
     this->automatically_free_unused = info.automatically_free_unused;
     if (info.min_allocation_size == 0)
     {
@@ -218,310 +383,794 @@ VkResult jvm_allocator_create(
     this->min_pool_size = info.min_pool_size;
 
     vkGetPhysicalDeviceMemoryProperties(info.physical_device, &this->memory_properties);
+    jvm_rank_memory_types(&this->memory_properties, props.deviceType, this->usage_type_counts, this->usage_types);
+
+    this->dedicated_allocation = info.dedicated_allocation;
+    this->get_buffer_memory_requirements2 = NULL;
+    this->get_image_memory_requirements2 = NULL;
+    if (info.dedicated_allocation)
+    {
+        this->get_buffer_memory_requirements2 = (PFN_vkGetBufferMemoryRequirements2) load_device_function(
+                info.device, "vkGetBufferMemoryRequirements2", "vkGetBufferMemoryRequirements2KHR");
+        this->get_image_memory_requirements2 = (PFN_vkGetImageMemoryRequirements2) load_device_function(
+                info.device, "vkGetImageMemoryRequirements2", "vkGetImageMemoryRequirements2KHR");
+        if (!this->get_buffer_memory_requirements2 || !this->get_image_memory_requirements2)
+        {
+            JVM_ERROR(this, "Dedicated allocations were requested, but vkGet*MemoryRequirements2 could not be loaded");
+            this->dedicated_allocation = 0;
+            this->get_buffer_memory_requirements2 = NULL;
+            this->get_image_memory_requirements2 = NULL;
+        }
+    }
 
-    *p_out = this;
-    return VK_SUCCESS;
-}
-
-//  returns 0 when found, > 0 when no chunk was good, < 0 when memory allocation fails
-int allocate_from_pool(
-        jvm_allocator* allocator, jvm_allocation_pool* const pool, VkDeviceSize size, VkDeviceSize alignment,
-        jvm_chunk** p_out)
-{
-    for (unsigned i = 0; i < pool->chunk_count; ++i)
+    this->get_device_buffer_memory_requirements = NULL;
+    this->get_device_image_memory_requirements = NULL;
+    if (info.maintenance4)
     {
-        jvm_chunk* chunk = pool->chunks[i];
-        if (chunk->used == 1)
+        this->get_device_buffer_memory_requirements = (PFN_vkGetDeviceBufferMemoryRequirements) load_device_function(
+                info.device, "vkGetDeviceBufferMemoryRequirements", "vkGetDeviceBufferMemoryRequirementsKHR");
+        this->get_device_image_memory_requirements = (PFN_vkGetDeviceImageMemoryRequirements) load_device_function(
+                info.device, "vkGetDeviceImageMemoryRequirements", "vkGetDeviceImageMemoryRequirementsKHR");
+        if (!this->get_device_buffer_memory_requirements || !this->get_device_image_memory_requirements)
         {
-            //  Chunk is in use
-            continue;
+            JVM_ERROR(this, "Maintenance4 was requested, but vkGetDevice*MemoryRequirements could not be loaded");
+            this->get_device_buffer_memory_requirements = NULL;
+            this->get_device_image_memory_requirements = NULL;
         }
-        VkDeviceSize padding = alignment - (
-                chunk->chunk_offset & (
-                        alignment - 1));   //  Based on assumption alignment is a power of two
-        if (padding == alignment)
+    }
+
+    this->memory_priority = info.memory_priority;
+    this->page_size = info.page_size;
+    this->page_memory_type_bits = info.page_size ? info.page_memory_type_bits : 0;
+    this->set_device_memory_priority = NULL;
+    if (info.pageable_device_local_memory)
+    {
+        this->set_device_memory_priority = (PFN_vkSetDeviceMemoryPriorityEXT) load_device_function(
+                info.device, "vkSetDeviceMemoryPriorityEXT", NULL);
+        if (!this->set_device_memory_priority)
         {
-            padding = 0;
+            JVM_ERROR(this, "Pageable device local memory was requested, but vkSetDeviceMemoryPriorityEXT could not be"
+                            " loaded");
         }
-        if (chunk->size < padding + size)
+    }
+
+    this->bind_buffer_memory2 = (PFN_vkBindBufferMemory2) load_device_function(
+            info.device, "vkBindBufferMemory2", "vkBindBufferMemory2KHR");
+    this->bind_image_memory2 = (PFN_vkBindImageMemory2) load_device_function(
+            info.device, "vkBindImageMemory2", "vkBindImageMemory2KHR");
+
+    this->get_memory_fd = NULL;
+    this->get_memory_fd_properties = NULL;
+    if (info.external_memory_fd)
+    {
+        this->get_memory_fd = (PFN_vkGetMemoryFdKHR) load_device_function(info.device, "vkGetMemoryFdKHR", NULL);
+        this->get_memory_fd_properties = (PFN_vkGetMemoryFdPropertiesKHR) load_device_function(
+                info.device, "vkGetMemoryFdPropertiesKHR", NULL);
+        if (!this->get_memory_fd || !this->get_memory_fd_properties)
         {
-            //  Chunk is not large enough
-            continue;
+            JVM_ERROR(this, "External memory file descriptors were requested, but vkGetMemoryFd*KHR could not be loaded");
+            this->get_memory_fd = NULL;
+            this->get_memory_fd_properties = NULL;
         }
-        const VkDeviceSize left_over = chunk->size - (padding + size);
-        if (left_over > allocator->min_allocation_size)
-        {
-            //  Chunk is large enough to split into two and only use one
+    }
 
-            if (pool->chunk_count == pool->chunk_capacity)
-            {
-                const unsigned new_capacity = (pool->chunk_capacity ? pool->chunk_capacity : 8) << 1;
-                jvm_chunk** const new_ptr = jvm_realloc(allocator, pool->chunks, sizeof(*pool->chunks) * new_capacity);
-                if (!new_ptr)
-                {
-                    JVM_ERROR(allocator, "Could not (re-)allocate chunk list for the memory pool");
-                    return -1;
-                }
-                pool->chunks = new_ptr;
-                pool->chunk_capacity = new_capacity;
-            }
-            jvm_chunk* const new_allocation = jvm_alloc(allocator, sizeof(*new_allocation));
-            if (!new_allocation)
-            {
-                JVM_ERROR(allocator, "Could not allocate memory for new chunk");
-                return -1;
-            }
-            *new_allocation = (jvm_chunk)
+    this->get_memory_host_pointer_properties = NULL;
+    this->min_imported_host_pointer_alignment = 0;
+    if (info.external_memory_host)
+    {
+        this->get_memory_host_pointer_properties = (PFN_vkGetMemoryHostPointerPropertiesEXT) load_device_function(
+                info.device, "vkGetMemoryHostPointerPropertiesEXT", NULL);
+        if (this->get_memory_host_pointer_properties)
+        {
+            VkPhysicalDeviceExternalMemoryHostPropertiesEXT host_props =
                     {
-                            .size = left_over,
-                            .chunk_offset = chunk->chunk_offset + padding + size,
-                            .pool = pool,
-                            .memory = pool->memory,
-                            .used = 0,
-                            .padding = 0,
-                            .mapped = 0,
+                            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT,
                     };
-            if (pool->chunk_count - 1 > i)
-            {
-                //  There are some chunks after this one
-                memmove(
-                        pool->chunks + i + 2, pool->chunks + i + 1,
-                        sizeof(*pool->chunks) * (pool->chunk_count - 1 - i));
-                assert(memcmp(pool->chunks + i + 1, pool->chunks + i + 2, sizeof(jvm_chunk*)) == 0);
-            }
-            pool->chunk_count += 1;
-            pool->chunks[i + 1] = new_allocation;
-            chunk->size = size + padding;
+            VkPhysicalDeviceProperties2 props2 =
+                    {
+                            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                            .pNext = &host_props,
+                    };
+            vkGetPhysicalDeviceProperties2(info.physical_device, &props2);
+            this->min_imported_host_pointer_alignment = host_props.minImportedHostPointerAlignment;
+        }
+        else
+        {
+            JVM_ERROR(this, "Host memory import was requested, but vkGetMemoryHostPointerPropertiesEXT could not be"
+                            " loaded");
         }
-        chunk->padding = padding;
-        chunk->used = 1;
-
-        *p_out = chunk;
-        return 0;
     }
-    return +1;
-}
 
-//  returns 0 when they don't merge, non-zero when they do
-int merge_chunks(jvm_allocator* allocator, jvm_allocation_pool* pool, const unsigned i, const unsigned j)
-{
-    assert(i < pool->chunk_count);
-    assert(j < pool->chunk_count);
-    assert(i + 1 == j);
+    this->requirements_count = 0;
+    this->requirements_capacity = 0;
+    this->requirements = NULL;
 
-    if (pool->chunks[i]->used || pool->chunks[j]->used)
-    {
-        return 0;
-    }
+    this->completed_value = 0;
+    memset(this->heap_usage, 0, sizeof(this->heap_usage));
+    memset(this->heap_budget, 0, sizeof(this->heap_budget));
+    this->evictable_count = 0;
+    this->evictable_capacity = 0;
+    this->evictable = NULL;
 
-    jvm_chunk* const c1 = pool->chunks[i];
-    jvm_chunk* const c2 = pool->chunks[j];
+    jvm_object_pool_init(&this->chunk_objects, sizeof(jvm_chunk), 256);
+    jvm_object_pool_init(&this->buffer_objects, sizeof(jvm_buffer_allocation), 64);
+    jvm_object_pool_init(&this->image_objects, sizeof(jvm_image_allocation), 64);
+    jvm_object_pool_init(&this->memory_objects, sizeof(jvm_memory_allocation), 64);
 
-    assert(c1->chunk_offset + c1->size == c2->chunk_offset);
+    *p_out = this;
+    return VK_SUCCESS;
+}
 
-    c1->size += c2->size;
-    memmove(pool->chunks + j, pool->chunks + j + 1, sizeof(*pool->chunks) * (pool->chunk_count - j - 1));
-    pool->chunk_count -= 1;
-    jvm_free(allocator, c2);
+//  Inserts a set bit at index idx of a bit array with count bits, moving the bits after it up by one
+static void insert_bit(uint64_t* bits, unsigned count, unsigned idx)
+{
+    const unsigned word = idx / 64;
+    for (unsigned w = count / 64; w > word; --w)
+    {
+        bits[w] = (bits[w] << 1) | (bits[w - 1] >> 63);
+    }
+    const uint64_t below = ((uint64_t) 1 << (idx % 64)) - 1;
+    bits[word] = (bits[word] & below) | ((bits[word] & ~below) << 1) | (below + 1);
+}
 
-    return 1;
+//  Removes the bit at index idx of a bit array with count bits, moving the bits after it down by one
+static void remove_bit(uint64_t* bits, unsigned count, unsigned idx)
+{
+    const unsigned word = idx / 64;
+    const uint64_t below = ((uint64_t) 1 << (idx % 64)) - 1;
+    bits[word] = (bits[word] & below) | ((bits[word] >> 1) & ~below);
+    for (unsigned w = word; w < (count - 1) / 64; ++w)
+    {
+        bits[w] |= bits[w + 1] << 63;
+        bits[w + 1] >>= 1;
+    }
 }
 
-//  returns 0 when successful, > 0 when chunk is not from pool
-int deallocate_from_pool(jvm_allocator* allocator, jvm_allocation_pool* const pool, jvm_chunk* chunk)
+//  Returns the index of the first unused chunk at or after i, or the chunk count if there is none
+static unsigned next_unused_chunk(const jvm_allocation_pool* pool, unsigned i)
 {
-    assert(chunk->pool == pool);
-    unsigned idx;
-    for (idx = 0; idx < pool->chunk_count; ++idx)
+    if (i >= pool->chunk_count)
     {
-        if (pool->chunks[idx] == chunk)
+        return pool->chunk_count;
+    }
+    const unsigned words = (pool->chunk_count + 63) / 64;
+    unsigned w = i / 64;
+    uint64_t bits = pool->unused_chunks[w] & (~(uint64_t) 0 << (i % 64));
+    while (!bits)
+    {
+        if (++w == words)
         {
-            break;
+            return pool->chunk_count;
         }
+        bits = pool->unused_chunks[w];
     }
-    if (idx == pool->chunk_count)
+    return w * 64 + jvm_lowest_bit(bits);
+}
+
+//  Returns the index of the last unused chunk before i, or the chunk count if there is none
+static unsigned previous_unused_chunk(const jvm_allocation_pool* pool, unsigned i)
+{
+    if (i == 0)
     {
-        return -1;
+        return pool->chunk_count;
     }
-    chunk->used = 0;
-    chunk->padding = 0;
-
-    //  Merge with blocks after
-    while ((idx < pool->chunk_count - 1))
+    i -= 1;
+    unsigned w = i / 64;
+    uint64_t bits = pool->unused_chunks[w] & (~(uint64_t) 0 >> (63 - i % 64));
+    while (!bits)
     {
-        assert(pool->chunks[idx]->chunk_offset + pool->chunks[idx]->size == pool->chunks[idx + 1]->chunk_offset);
-        if (!merge_chunks(allocator, pool, idx, idx + 1))
+        if (w-- == 0)
         {
-            break;
+            return pool->chunk_count;
         }
+        bits = pool->unused_chunks[w];
     }
+    return w * 64 + jvm_highest_bit(bits);
+}
 
-    //  Merge with blocks before
-    while (idx)
+//  Inserts a new unused chunk at the given index of the pool's chunk list. Returns NULL when memory allocation fails
+static jvm_chunk* insert_free_chunk(
+        jvm_allocator* allocator, jvm_allocation_pool* const pool, unsigned idx, VkDeviceSize offset, VkDeviceSize size)
+{
+    if (pool->chunk_count == pool->chunk_capacity &&
+        !grow_chunk_arrays(allocator, pool, (pool->chunk_capacity ? pool->chunk_capacity : 8) << 1))
     {
-        assert(pool->chunks[idx - 1]->chunk_offset + pool->chunks[idx - 1]->size == pool->chunks[idx]->chunk_offset);
-        if (!merge_chunks(allocator, pool, idx - 1, idx))
-        {
-            break;
-        }
-        idx -= 1;
+        JVM_ERROR(allocator, "Could not (re-)allocate chunk arrays for the memory pool");
+        return NULL;
+    }
+    jvm_chunk* const new_allocation = jvm_object_alloc(allocator, &allocator->chunk_objects);
+    if (!new_allocation)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for new chunk");
+        return NULL;
     }
+    *new_allocation = (jvm_chunk)
+            {
+                    .size = size,
+                    .chunk_offset = offset,
+                    .pool = pool,
+                    .memory = pool->memory,
+                    .used = 0,
+                    .tiling = JVM_TILING_CLASS_NONE,
+                    .padding = 0,
+                    .mapped = 0,
+            };
+    if (pool->chunk_count > idx)
+    {
+        //  There are some chunks after this one
+        const unsigned after = pool->chunk_count - idx;
+        memmove(pool->chunks + idx + 1, pool->chunks + idx, sizeof(*pool->chunks) * after);
+        memmove(pool->chunk_offsets + idx + 1, pool->chunk_offsets + idx, sizeof(*pool->chunk_offsets) * after);
+        memmove(pool->chunk_sizes + idx + 1, pool->chunk_sizes + idx, sizeof(*pool->chunk_sizes) * after);
+    }
+    insert_bit(pool->unused_chunks, pool->chunk_count, idx);
+    pool->chunk_count += 1;
+    pool->chunks[idx] = new_allocation;
+    pool->chunk_offsets[idx] = offset;
+    pool->chunk_sizes[idx] = size;
+    return new_allocation;
+}
 
-    return 0;
+//  Returns non-zero if resources of the two classes must not share a bufferImageGranularity sized page
+static int tiling_conflicts(const jvm_allocator* allocator, jvm_tiling_class c1, jvm_tiling_class c2)
+{
+    return allocator->buffer_image_granularity > 1 && c1 != JVM_TILING_CLASS_NONE && c2 != JVM_TILING_CLASS_NONE &&
+           (c1 != c2 || c1 == JVM_TILING_CLASS_MIXED);
 }
 
-VkResult jvm_allocate(
-        jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize alignment, uint32_t type_bits,
-        VkMemoryPropertyFlags desired_flags, VkMemoryPropertyFlags undesired_flags, jvm_chunk** p_out
-#ifdef JVM_TRACK_ALLOCATIONS
-        ,const char* file, int line
-#endif
-)
+//  Finds the range [*p_begin, *p_end) of an unused chunk, in which a resource of the given class can be placed without
+//  sharing a bufferImageGranularity page with the chunk's neighbours
+static void chunk_usable_range(
+        const jvm_allocator* allocator, const jvm_allocation_pool* pool, unsigned i, jvm_tiling_class tiling,
+        VkDeviceSize* p_begin, VkDeviceSize* p_end)
 {
-    if (size < allocator->min_allocation_size)
+    const VkDeviceSize granularity = allocator->buffer_image_granularity;   //  Also a power of two
+    VkDeviceSize begin = pool->chunk_offsets[i];
+    VkDeviceSize end = pool->chunk_offsets[i] + pool->chunk_sizes[i];
+    if (i != 0 && pool->chunks[i - 1]->used && tiling_conflicts(allocator, pool->chunks[i - 1]->tiling, tiling))
     {
-        //  Should be at least this size
-        size = allocator->min_allocation_size;
+        //  Start on the page after the one where the previous chunk ends
+        begin = (begin + granularity - 1) & ~(granularity - 1);
     }
-
-    if (size < alignment)
+    if (i + 1 < pool->chunk_count && pool->chunks[i + 1]->used &&
+        tiling_conflicts(allocator, pool->chunks[i + 1]->tiling, tiling))
     {
-        size = alignment;
+        //  End before the page where the next chunk begins
+        end &= ~(granularity - 1);
     }
+    *p_begin = begin;
+    *p_end = end;
+}
 
-    //  Reset scores
-    const uint32_t mem_type_count = allocator->memory_properties.memoryTypeCount;
-    int64_t scores[VK_MAX_MEMORY_TYPES] = { 0 };
-    for (unsigned i = 0; i < mem_type_count; ++i)
+//  Checks if the resource fits into the unused chunk i. If it does, returns non-zero and the offset where it would be
+//  placed, either at the beginning or at the end of the chunk
+static int chunk_fits(
+        const jvm_allocator* allocator, const jvm_allocation_pool* pool, unsigned i, VkDeviceSize size,
+        VkDeviceSize alignment, jvm_tiling_class tiling, VkBool32 from_end, VkDeviceSize* p_offset)
+{
+    VkDeviceSize begin, end;
+    chunk_usable_range(allocator, pool, i, tiling, &begin, &end);
+    //  Based on assumption alignment is a power of two
+    if (from_end)
     {
-        scores[i] = 1;
+        if (end < size || ((end - size) & ~(alignment - 1)) < begin)
+        {
+            return 0;
+        }
+        *p_offset = (end - size) & ~(alignment - 1);
+        return 1;
     }
-    //  Check for unwanted flags
-    unsigned valid_count = 0;
-    if (undesired_flags)
+    const VkDeviceSize offset = (begin + alignment - 1) & ~(alignment - 1);
+    if (offset + size > end)
     {
-        for (unsigned i = 0; i < mem_type_count; ++i)
+        return 0;
+    }
+    *p_offset = offset;
+    return 1;
+}
+
+//  Optimal tiling resources go from the end of pools, unless pools should be packed towards their start
+static VkBool32 places_from_end(const jvm_allocator* allocator, jvm_tiling_class tiling, jvm_allocation_strategy strategy)
+{
+    return allocator->separate_linear_and_optimal && tiling == JVM_TILING_CLASS_OPTIMAL &&
+           strategy != JVM_ALLOCATION_STRATEGY_MIN_OFFSET;
+}
+
+//  Finds the unused chunk where the resource should be placed according to the strategy. Returns non-zero if found
+static int find_chunk(
+        const jvm_allocator* allocator, const jvm_allocation_pool* pool, VkDeviceSize size, VkDeviceSize alignment,
+        jvm_tiling_class tiling, jvm_allocation_strategy strategy, unsigned* p_idx, VkDeviceSize* p_offset)
+{
+    const unsigned count = pool->chunk_count;
+    const VkBool32 from_end = places_from_end(allocator, tiling, strategy);
+    //  Only unused chunks are visited, and those which are too small are skipped by their size alone
+    if (strategy == JVM_ALLOCATION_STRATEGY_BEST_FIT)
+    {
+        //  Smallest chunk which is large enough, so that large chunks stay available for large resources
+        int found = 0;
+        for (unsigned i = next_unused_chunk(pool, 0); i < count; i = next_unused_chunk(pool, i + 1))
         {
-            if (allocator->memory_properties.memoryTypes[i].propertyFlags & undesired_flags)
+            VkDeviceSize offset;
+            if (pool->chunk_sizes[i] < size || (found && pool->chunk_sizes[i] >= pool->chunk_sizes[*p_idx]) ||
+                !chunk_fits(allocator, pool, i, size, alignment, tiling, from_end, &offset))
             {
-                scores[i] = 0;
+                continue;
             }
-            valid_count += 1;
-        }
-        if (valid_count == 0)
-        {
-            JVM_ERROR(allocator, "Out of %u available memory types, none contained none of the undesired flags",
-                      mem_type_count);
-            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+            found = 1;
+            *p_idx = i;
+            *p_offset = offset;
         }
+        return found;
     }
 
-    //  Check for allowed memory types
-    for (unsigned i = 0; i < mem_type_count; ++i)
+    if (from_end)
     {
-        //  If the type does not have the flag bit set, then it can not be used
-        if (!(type_bits & (1 << i)))
+        for (unsigned i = previous_unused_chunk(pool, count); i < count; i = previous_unused_chunk(pool, i))
         {
-            scores[i] = 0;
+            if (pool->chunk_sizes[i] >= size && chunk_fits(allocator, pool, i, size, alignment, tiling, 1, p_offset))
+            {
+                *p_idx = i;
+                return 1;
+            }
         }
+        return 0;
     }
 
-    valid_count = 0;
-    for (unsigned i = 0; i < mem_type_count; ++i)
+    //  Fastest continues where the last allocation from the pool was made and wraps around, others start at the
+    //  beginning
+    const unsigned start = strategy == JVM_ALLOCATION_STRATEGY_FASTEST && pool->search_hint < count
+                           ? pool->search_hint : 0;
+    for (unsigned i = next_unused_chunk(pool, start); i < count; i = next_unused_chunk(pool, i + 1))
     {
-        if (scores[i] == -1)
+        if (pool->chunk_sizes[i] >= size && chunk_fits(allocator, pool, i, size, alignment, tiling, 0, p_offset))
         {
-            //  Has undesired flags
-            continue;
-        }
-        if ((allocator->memory_properties.memoryTypes[i].propertyFlags & desired_flags) == desired_flags)
-        {
-            //  Has (at least) all desired flags
-            scores[i] *= (int64_t) (
-                    allocator->memory_properties.memoryHeaps[allocator->memory_properties.memoryTypes[i].heapIndex].size
-                            >> 10);
-            valid_count += (scores[i] != 0);
+            *p_idx = i;
+            return 1;
         }
     }
-    if (valid_count == 0)
-    {
-        JVM_ERROR(allocator, "There was no memory type with desired memory flags");
-        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
-    }
-
-    int64_t best_score = 0;
-    uint32_t idx = mem_type_count;
-    for (unsigned i = 0; i < mem_type_count; ++i)
+    for (unsigned i = next_unused_chunk(pool, 0); i < start; i = next_unused_chunk(pool, i + 1))
     {
-        if (scores[i] > best_score)
+        if (pool->chunk_sizes[i] >= size && chunk_fits(allocator, pool, i, size, alignment, tiling, 0, p_offset))
         {
-            best_score = scores[i];
-            idx = (uint32_t) i;
+            *p_idx = i;
+            return 1;
         }
     }
-    if (best_score == 0)
-    {
-        JVM_ERROR(allocator, "There was no available memory type to support allocation given the nature of the allocation,"
-                             " the desired, and the undesired flags");
-        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
-    }
+    return 0;
+}
 
-    //  Check for need to map
-    if ((allocator->memory_properties.memoryTypes[idx].propertyFlags & desired_flags) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+//  Places the resource into the unused chunk i at the given offset, splitting off what remains of the chunk. Returns 0
+//  when successful, < 0 when memory allocation fails
+static int place_in_chunk(
+        jvm_allocator* allocator, jvm_allocation_pool* const pool, unsigned i, VkDeviceSize offset, VkDeviceSize size,
+        jvm_tiling_class tiling, VkBool32 from_end, jvm_chunk** p_out)
+{
+    jvm_chunk* chunk = pool->chunks[i];
+    if (from_end)
     {
-        if (alignment < allocator->min_map_alignment)
+        const VkDeviceSize left_over = offset - chunk->chunk_offset;
+        if (left_over > allocator->min_allocation_size)
         {
-            alignment = allocator->min_map_alignment;
+            //  Chunk is large enough to split into two and only use the second one
+            if (!insert_free_chunk(allocator, pool, i, chunk->chunk_offset, left_over))
+            {
+                return -1;
+            }
+            chunk->chunk_offset = offset;
+            chunk->size -= left_over;
+            i += 1;
         }
-        if (size < alignment)
+    }
+    else
+    {
+        const VkDeviceSize padding = offset - chunk->chunk_offset;
+        const VkDeviceSize left_over = chunk->size - (padding + size);
+        if (left_over > allocator->min_allocation_size)
         {
-            size = alignment;
+            //  Chunk is large enough to split into two and only use one
+            if (!insert_free_chunk(allocator, pool, i + 1, offset + size, left_over))
+            {
+                return -1;
+            }
+            chunk->size = size + padding;
         }
     }
+    chunk->padding = offset - chunk->chunk_offset;
+    chunk->used = 1;
+    chunk->tiling = tiling;
+    pool->chunk_offsets[i] = chunk->chunk_offset;
+    pool->chunk_sizes[i] = chunk->size;
+    pool->unused_chunks[i / 64] &= ~((uint64_t) 1 << (i % 64));
+    pool->search_hint = i + 1;
 
-    for (unsigned i = 0; i < allocator->pool_count; ++i)
+    *p_out = chunk;
+    return 0;
+}
+
+//  returns 0 when found, > 0 when no chunk was good, < 0 when memory allocation fails
+int jvm_allocate_from_pool(
+        jvm_allocator* allocator, jvm_allocation_pool* const pool, VkDeviceSize size, VkDeviceSize alignment,
+        jvm_tiling_class tiling, jvm_allocation_strategy strategy, jvm_chunk** p_out)
+{
+    unsigned idx;
+    VkDeviceSize offset;
+    if (!find_chunk(allocator, pool, size, alignment, tiling, strategy, &idx, &offset))
     {
-        jvm_allocation_pool* const pool = allocator->pools[i];
-        if (pool->memory_type_index != idx)
+        return +1;
+    }
+    return place_in_chunk(
+            allocator, pool, idx, offset, size, tiling, places_from_end(allocator, tiling, strategy), p_out);
+}
+
+//  Removes chunk i from the pool's chunk list and frees it, after its memory was given to a neighbour
+static void remove_chunk(jvm_allocator* allocator, jvm_allocation_pool* pool, const unsigned i)
+{
+    jvm_chunk* const chunk = pool->chunks[i];
+    const unsigned after = pool->chunk_count - i - 1;
+    memmove(pool->chunks + i, pool->chunks + i + 1, sizeof(*pool->chunks) * after);
+    memmove(pool->chunk_offsets + i, pool->chunk_offsets + i + 1, sizeof(*pool->chunk_offsets) * after);
+    memmove(pool->chunk_sizes + i, pool->chunk_sizes + i + 1, sizeof(*pool->chunk_sizes) * after);
+    remove_bit(pool->unused_chunks, pool->chunk_count, i);
+    pool->chunk_count -= 1;
+    jvm_object_free(allocator, &allocator->chunk_objects, chunk);
+}
+
+//  returns 0 when they don't merge, non-zero when they do
+int merge_chunks(jvm_allocator* allocator, jvm_allocation_pool* pool, const unsigned i, const unsigned j)
+{
+    assert(i < pool->chunk_count);
+    assert(j < pool->chunk_count);
+    assert(i + 1 == j);
+
+    if (pool->chunks[i]->used || pool->chunks[j]->used)
+    {
+        return 0;
+    }
+
+    jvm_chunk* const c1 = pool->chunks[i];
+    jvm_chunk* const c2 = pool->chunks[j];
+
+    assert(c1->chunk_offset + c1->size == c2->chunk_offset);
+
+    c1->size += c2->size;
+    pool->chunk_sizes[i] = c1->size;
+    remove_chunk(allocator, pool, j);
+
+    return 1;
+}
+
+//  Returns the index of the chunk in the pool's chunk list, or the chunk count if it is not there
+static unsigned chunk_index(const jvm_allocation_pool* pool, const jvm_chunk* chunk)
+{
+    //  Chunks are sorted by their offsets
+    unsigned idx = 0, end = pool->chunk_count;
+    while (idx < end)
+    {
+        const unsigned mid = idx + (end - idx) / 2;
+        if (pool->chunk_offsets[mid] < chunk->chunk_offset)
+        {
+            idx = mid + 1;
+        }
+        else
+        {
+            end = mid;
+        }
+    }
+    return idx < pool->chunk_count && pool->chunks[idx] == chunk ? idx : pool->chunk_count;
+}
+
+//  returns 0 when successful, > 0 when chunk is not from pool
+int jvm_deallocate_from_pool(jvm_allocator* allocator, jvm_allocation_pool* const pool, jvm_chunk* chunk)
+{
+    assert(chunk->pool == pool);
+    if (pool->page_size)
+    {
+        jvm_page_pool_give_back(allocator, chunk);
+        return 0;
+    }
+    unsigned idx = chunk_index(pool, chunk);
+    if (idx == pool->chunk_count)
+    {
+        return -1;
+    }
+    chunk->used = 0;
+    chunk->padding = 0;
+    chunk->tiling = JVM_TILING_CLASS_NONE;
+    pool->unused_chunks[idx / 64] |= (uint64_t) 1 << (idx % 64);
+
+    //  Merge with blocks after
+    while ((idx < pool->chunk_count - 1))
+    {
+        assert(pool->chunks[idx]->chunk_offset + pool->chunks[idx]->size == pool->chunks[idx + 1]->chunk_offset);
+        if (!merge_chunks(allocator, pool, idx, idx + 1))
+        {
+            break;
+        }
+    }
+
+    //  Merge with blocks before
+    while (idx)
+    {
+        assert(pool->chunks[idx - 1]->chunk_offset + pool->chunks[idx - 1]->size == pool->chunks[idx]->chunk_offset);
+        if (!merge_chunks(allocator, pool, idx - 1, idx))
+        {
+            break;
+        }
+        idx -= 1;
+    }
+
+    return 0;
+}
+
+//  Grows the used chunk so that size bytes fit after its padding, by taking memory from the unused chunk or pages right
+//  after it. Returns non-zero if the chunk is large enough afterwards. If commit is zero, nothing is changed and only
+//  whether the chunk could be grown is returned
+static int grow_chunk_in_place(jvm_allocator* allocator, jvm_chunk* chunk, VkDeviceSize size, VkBool32 commit)
+{
+    jvm_allocation_pool* const pool = chunk->pool;
+    if (pool->dedicated)
+    {
+        //  Dedicated memory belongs to the old buffer alone, so nothing else can be bound to it, however large it is
+        return 0;
+    }
+    const VkDeviceSize needed = chunk->padding + size;
+    if (needed <= chunk->size)
+    {
+        return 1;
+    }
+    if (pool->page_size)
+    {
+        return jvm_page_pool_grow(
+                pool, chunk, (uint32_t) ((needed + pool->page_size - 1) / pool->page_size), commit);
+    }
+    const unsigned i = chunk_index(pool, chunk);
+    assert(i < pool->chunk_count);
+    if (i + 1 == pool->chunk_count || pool->chunks[i + 1]->used)
+    {
+        return 0;
+    }
+    VkDeviceSize begin, end;
+    chunk_usable_range(allocator, pool, i + 1, chunk->tiling, &begin, &end);
+    if (chunk->chunk_offset + needed > end)
+    {
+        return 0;
+    }
+    if (!commit)
+    {
+        return 1;
+    }
+    jvm_chunk* const next = pool->chunks[i + 1];
+    const VkDeviceSize taken = chunk->chunk_offset + needed - next->chunk_offset;
+    if (next->size - taken > allocator->min_allocation_size)
+    {
+        //  What remains of the next chunk stays unused
+        next->chunk_offset += taken;
+        next->size -= taken;
+        pool->chunk_offsets[i + 1] = next->chunk_offset;
+        pool->chunk_sizes[i + 1] = next->size;
+        chunk->size = needed;
+    }
+    else
+    {
+        chunk->size += next->size;
+        remove_chunk(allocator, pool, i + 1);
+    }
+    pool->chunk_sizes[i] = chunk->size;
+    return 1;
+}
+
+VkResult jvm_find_memory_type(
+        const VkPhysicalDeviceMemoryProperties* memory_properties, uint32_t type_bits, VkMemoryPropertyFlags desired_flags,
+        VkMemoryPropertyFlags undesired_flags, uint32_t* p_index)
+{
+    //  Out of all types with desired and without undesired flags, the one with the largest heap is chosen
+    VkDeviceSize best_score = 0;
+    uint32_t idx = memory_properties->memoryTypeCount;
+    for (uint32_t i = 0; i < memory_properties->memoryTypeCount; ++i)
+    {
+        const VkMemoryPropertyFlags flags = memory_properties->memoryTypes[i].propertyFlags;
+        if (!(type_bits & (1 << i)) || (flags & desired_flags) != desired_flags || (flags & undesired_flags))
         {
-            //  Not correct type
             continue;
         }
+        const VkDeviceSize score = (memory_properties->memoryHeaps[memory_properties->memoryTypes[i].heapIndex].size
+                >> 10) + 1;
+        if (score > best_score)
+        {
+            best_score = score;
+            idx = i;
+        }
+    }
+    if (best_score == 0)
+    {
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+    *p_index = idx;
+    return VK_SUCCESS;
+}
+
+VkBool32 jvm_transient_attachment_flags(
+        const VkPhysicalDeviceMemoryProperties* memory_properties, uint32_t type_bits,
+        VkMemoryPropertyFlags* p_desired_flags, VkMemoryPropertyFlags* p_undesired_flags)
+{
+    uint32_t idx;
+    if (jvm_find_memory_type(
+            memory_properties, type_bits, *p_desired_flags | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+            *p_undesired_flags | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, &idx) == VK_SUCCESS)
+    {
+        *p_desired_flags |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        *p_undesired_flags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        return 1;
+    }
+    //  Device has no lazily allocated memory, so fall back to device local memory if that is possible
+    if (jvm_find_memory_type(
+            memory_properties, type_bits, *p_desired_flags | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            *p_undesired_flags | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &idx) == VK_SUCCESS)
+    {
+        *p_desired_flags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    }
+    return 0;
+}
+
+//  Returns non-zero if a new pool of the given size would put the heap of the memory type over its budget
+static int over_budget(const jvm_allocator* allocator, uint32_t idx, VkDeviceSize size)
+{
+    const uint32_t heap = allocator->memory_properties.memoryTypes[idx].heapIndex;
+    return allocator->heap_budget[heap] && allocator->heap_usage[heap] + size > allocator->heap_budget[heap];
+}
+
+//  Makes the next attempt at creating a pool of the memory type more likely to succeed. Pools on its heap which are empty
+//  are released first. If there are none, the size of the new pool is halved, down to exactly min_size. Only when it can
+//  not be made any smaller is the least recently used evictable resource evicted. Returns zero if nothing could be done
+static int relieve_pressure(jvm_allocator* allocator, uint32_t idx, VkDeviceSize min_size, VkDeviceSize* p_pool_size)
+{
+    const uint32_t heap = allocator->memory_properties.memoryTypes[idx].heapIndex;
+    int freed = 0;
+    for (unsigned i = allocator->pool_count; i > 0; --i)
+    {
+        jvm_allocation_pool* const pool = allocator->pools[i - 1];
+        if (pool->memory_type_info.heapIndex == heap && pool_is_unused(pool) &&
+            remove_pool(allocator, pool) == 0)
+        {
+            freed = 1;
+        }
+    }
+    if (freed)
+    {
+        return 1;
+    }
+    if (*p_pool_size > min_size)
+    {
+        *p_pool_size = *p_pool_size / 2 > min_size ? *p_pool_size / 2 : min_size;
+        return 1;
+    }
+    return jvm_evict_lru(allocator, heap);
+}
 
-        jvm_chunk* allocation;
-        const int alloc_res = allocate_from_pool(allocator, pool, size, alignment, &allocation);
-        if (alloc_res == 0)
+//  Allocates from an existing pool of the memory type, or from a new one if none has space. If page_size is non-zero, the
+//  allocation is made from pools split into pages of that size (of which alignment may not be larger), otherwise from
+//  pools split into chunks
+static VkResult allocate_from_memory_type(
+        jvm_allocator* allocator, uint32_t idx, VkDeviceSize size, VkDeviceSize alignment, jvm_tiling_class tiling,
+        jvm_allocation_strategy strategy, VkDeviceSize page_size, float priority, jvm_allocation_lifetime lifetime,
+        VkExternalMemoryHandleTypeFlags export_handle_types, jvm_chunk** p_out)
+{
+    const uint32_t page_run = page_size ? (uint32_t) ((size + page_size - 1) / page_size) : 0;
+    //  Pages smaller than bufferImageGranularity can not be placed next to pages of any other class
+    const jvm_tiling_class page_tiling = page_size && page_size < allocator->buffer_image_granularity
+                                         ? tiling : JVM_TILING_CLASS_NONE;
+    if (page_size)
+    {
+        size = page_size * page_run;
+    }
+    VkDeviceSize new_pool_size = allocator->min_pool_size < size ? size : allocator->min_pool_size;
+    uint32_t first_page = 0;
+    for (;;)
+    {
+        jvm_allocation_pool* best_pool = NULL;
+        unsigned best_idx = 0;
+        VkDeviceSize best_offset = 0;
+        for (unsigned i = 0; i < allocator->pool_count; ++i)
         {
+            jvm_allocation_pool* const pool = allocator->pools[i];
+            if (pool->memory_type_index != idx || pool->dedicated || pool->page_size != page_size ||
+                pool->page_tiling != page_tiling || pool->priority != priority || pool->lifetime != lifetime ||
+                pool->export_handle_types != export_handle_types)
+            {
+                //  Not correct type, pages, priority, lifetime or export types, or can not be shared
+                continue;
+            }
+            if (page_size)
+            {
+                //  Any run of pages is as good as any other
+                if (jvm_page_pool_find(pool, page_run, &first_page))
+                {
+                    best_pool = pool;
+                    break;
+                }
+                continue;
+            }
+
+            unsigned chunk_idx;
+            VkDeviceSize offset;
+            if (!find_chunk(allocator, pool, size, alignment, tiling, strategy, &chunk_idx, &offset))
+            {
+                continue;
+            }
+            if (!best_pool || pool->chunk_sizes[chunk_idx] < best_pool->chunk_sizes[best_idx])
+            {
+                best_pool = pool;
+                best_idx = chunk_idx;
+                best_offset = offset;
+            }
+            if (strategy != JVM_ALLOCATION_STRATEGY_BEST_FIT)
+            {
+                //  Only best fit needs to look at all pools
+                break;
+            }
+        }
+        if (best_pool && page_size)
+        {
+            *p_out = jvm_page_pool_take(allocator, best_pool, first_page, page_run, tiling);
+            return *p_out ? VK_SUCCESS : VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        if (best_pool)
+        {
+            const int alloc_res = place_in_chunk(
+                    allocator, best_pool, best_idx, best_offset, size, tiling,
+                    places_from_end(allocator, tiling, strategy), p_out);
+            if (alloc_res < 0)
+            {
+                //  Could not allocate memory for pool internally
+                return VK_ERROR_OUT_OF_HOST_MEMORY;
+            }
             //  Allocating from the pool was possible
-#ifdef JVM_TRACK_ALLOCATIONS
-            allocation->file = file;
-            allocation->line = line;
-#endif
-            *p_out = allocation;
             return VK_SUCCESS;
         }
-        else if (alloc_res < 0)
+
+        //  No pool was good enough, time to allocate a new one. If the heap is over budget or out of memory, pressure on
+        //  it is relieved and pools are searched again, since that might have made room in them. The budget is
+        //  exceeded only once there is nothing left to do
+        if (over_budget(allocator, idx, new_pool_size) && relieve_pressure(allocator, idx, size, &new_pool_size))
         {
-            //  Could not allocate memory for pool internally
-            return VK_ERROR_OUT_OF_HOST_MEMORY;
+            continue;
+        }
+        if (page_size)
+        {
+            new_pool_size = (new_pool_size + page_size - 1) / page_size * page_size;
+        }
+        const VkExportMemoryAllocateInfo export_info =
+                {
+                        .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+                        .handleTypes = export_handle_types,
+                };
+        const VkResult vk_result = create_new_pool(
+                allocator,
+                new_pool_size,
+                idx, allocator->memory_properties.memoryTypes[idx], 0, NULL, priority, page_size,
+                export_handle_types ? &export_info : NULL);
+        if (vk_result == VK_ERROR_OUT_OF_DEVICE_MEMORY && relieve_pressure(allocator, idx, size, &new_pool_size))
+        {
+            continue;
+        }
+        if (vk_result != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not allocate new memory pool of size %zu", (size_t) new_pool_size);
+            return vk_result;
         }
+        break;
     }
-
-    //  No pool was good enough, time to allocate a new one
-    const VkDeviceSize new_pool_size = allocator->min_pool_size < size ? size : allocator->min_pool_size;
-    VkResult vk_result = create_new_pool(
-            allocator,
-            new_pool_size,
-            idx, allocator->memory_properties.memoryTypes[idx]);
-    if (vk_result != VK_SUCCESS)
+    jvm_allocation_pool* const new_pool = allocator->pools[allocator->pool_count - 1];
+    new_pool->lifetime = lifetime;
+    new_pool->export_handle_types = export_handle_types;
+    if (page_size)
     {
-        JVM_ERROR(allocator, "Could not allocate new memory pool of size %zu", (size_t) new_pool_size);
-        return vk_result;
+        new_pool->page_tiling = page_tiling;
+        *p_out = jvm_page_pool_take(allocator, new_pool, 0, page_run, tiling);
+        return *p_out ? VK_SUCCESS : VK_ERROR_OUT_OF_HOST_MEMORY;
     }
 
-    jvm_chunk* allocation;
-    const int alloc_res = allocate_from_pool(
-            allocator, allocator->pools[allocator->pool_count - 1], size, alignment, &allocation);
+    const int alloc_res = jvm_allocate_from_pool(allocator, new_pool, size, alignment, tiling, strategy, p_out);
     assert(alloc_res <= 0);
     if (alloc_res != 0)
     {
@@ -529,6 +1178,133 @@ VkResult jvm_allocate(
         return VK_ERROR_OUT_OF_HOST_MEMORY;
     }
     //  Allocating from the pool was possible
+    return VK_SUCCESS;
+}
+
+//  Raises the size and alignment of an allocation from a host visible memory type, so that it can be mapped
+static void adjust_for_mapping(
+        const jvm_allocator* allocator, uint32_t idx, VkDeviceSize* p_size, VkDeviceSize* p_alignment)
+{
+    if (allocator->memory_properties.memoryTypes[idx].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (*p_alignment < allocator->min_map_alignment)
+        {
+            *p_alignment = allocator->min_map_alignment;
+        }
+        if (*p_size < *p_alignment)
+        {
+            *p_size = *p_alignment;
+        }
+    }
+}
+
+//  Chooses the next best memory type after the one which ran out of memory, if the allocation allows falling back to
+//  one. Returns zero if it does not, or if no other type is suitable
+static int choose_fallback_type(
+        const jvm_allocator* allocator, const jvm_allocation_create_info* allocation_info, VkBool32 allow_lazy,
+        uint32_t* p_type_bits, uint32_t* p_idx)
+{
+    if (!allocation_info->allow_fallback)
+    {
+        return 0;
+    }
+    *p_type_bits &= ~(1u << *p_idx);
+    return jvm_choose_memory_type(allocator, *p_type_bits, allocation_info, allow_lazy, p_idx) == VK_SUCCESS;
+}
+
+VkResult jvm_allocate(
+        jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize alignment, uint32_t type_bits,
+        const jvm_allocation_create_info* allocation_info, jvm_tiling_class tiling, jvm_chunk** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    if (size < allocator->min_allocation_size)
+    {
+        //  Should be at least this size
+        size = allocator->min_allocation_size;
+    }
+
+    if (size < alignment)
+    {
+        size = alignment;
+    }
+
+    //  Lazily allocated memory is only ever given to single resources which asked for it
+    uint32_t idx;
+    const VkResult type_res = jvm_choose_memory_type(allocator, type_bits, allocation_info, 0, &idx);
+    if (type_res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "There was no available memory type to support allocation given the nature of the allocation,"
+                             " the desired, and the undesired flags");
+        return type_res;
+    }
+
+    jvm_allocation_strategy strategy = allocation_info->strategy;
+    if (strategy == JVM_ALLOCATION_STRATEGY_DEFAULT)
+    {
+        switch (allocation_info->lifetime)
+        {
+        case JVM_ALLOCATION_LIFETIME_STATIC:
+            strategy = JVM_ALLOCATION_STRATEGY_BEST_FIT;
+            break;
+        case JVM_ALLOCATION_LIFETIME_LEVEL:
+            strategy = JVM_ALLOCATION_STRATEGY_MIN_OFFSET;
+            break;
+        case JVM_ALLOCATION_LIFETIME_FRAME:
+            strategy = JVM_ALLOCATION_STRATEGY_FASTEST;
+            break;
+        default:
+            strategy = allocator->default_strategy;
+            break;
+        }
+    }
+    const float priority = jvm_allocation_priority(allocator, allocation_info);
+    jvm_chunk* allocation;
+    VkResult res;
+    do
+    {
+        VkDeviceSize type_size = size;
+        VkDeviceSize type_alignment = alignment;
+        adjust_for_mapping(allocator, idx, &type_size, &type_alignment);
+        //  Page pools are only used for memory types which asked for them, and resources which fit their alignment
+        const VkDeviceSize page_size = (allocator->page_memory_type_bits & (1u << idx)) &&
+                                       type_alignment <= allocator->page_size ? allocator->page_size : 0;
+        res = allocate_from_memory_type(
+                allocator, idx, type_size, type_alignment, tiling, strategy, page_size, priority,
+                allocation_info->lifetime, allocation_info->export_handle_types, &allocation);
+    } while (res == VK_ERROR_OUT_OF_DEVICE_MEMORY &&
+             choose_fallback_type(allocator, allocation_info, 0, &type_bits, &idx));
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+#ifdef JVM_TRACK_ALLOCATIONS
+    allocation->file = file;
+    allocation->line = line;
+#endif
+    *p_out = allocation;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_allocate_sparse_page(
+        jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize alignment, uint32_t memory_type_index,
+        jvm_tiling_class tiling, float priority, jvm_chunk** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    //  Pages are the sparse block size, which is also the alignment
+    jvm_chunk* allocation;
+    const VkResult res = allocate_from_memory_type(
+            allocator, memory_type_index, size, alignment, tiling, JVM_ALLOCATION_STRATEGY_FIRST_FIT, alignment,
+            priority, JVM_ALLOCATION_LIFETIME_DEFAULT, 0, &allocation);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
 #ifdef JVM_TRACK_ALLOCATIONS
     allocation->file = file;
     allocation->line = line;
@@ -537,6 +1313,17 @@ VkResult jvm_allocate(
     return VK_SUCCESS;
 }
 
+float jvm_allocation_priority(const jvm_allocator* allocator, const jvm_allocation_create_info* allocation_info)
+{
+    return allocator->memory_priority && allocation_info->priority > 0 ? allocation_info->priority
+                                                                        : JVM_DEFAULT_PRIORITY;
+}
+
+VkBool32 jvm_should_be_dedicated(const jvm_allocator* allocator, VkDeviceSize size, VkBool32 prefers_dedicated)
+{
+    return prefers_dedicated || size > allocator->min_pool_size / 2;
+}
+
 VkResult jvm_buffer_create(
         jvm_allocator* allocator, const VkBufferCreateInfo* create_info, VkMemoryPropertyFlags desired_flags,
         VkMemoryPropertyFlags undesired_flags, VkBool32 dedicated, jvm_buffer_allocation** p_out
@@ -545,31 +1332,82 @@ VkResult jvm_buffer_create(
 #endif
 )
 {
-    jvm_buffer_allocation* const this = jvm_alloc(allocator, sizeof(*this));
+    const jvm_allocation_create_info allocation_info =
+            {
+                    .usage = JVM_MEMORY_USAGE_UNKNOWN,
+                    .desired_flags = desired_flags,
+                    .undesired_flags = undesired_flags,
+                    .dedicated = dedicated,
+            };
+    return jvm_buffer_create2(
+            allocator, create_info, &allocation_info, p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            );
+}
+
+VkResult jvm_buffer_create2(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info,
+        const jvm_allocation_create_info* allocation_info, jvm_buffer_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    const jvm_allocation_create_info info = *allocation_info;
+    VkBool32 dedicated = info.dedicated;
+    jvm_buffer_allocation* const this = jvm_object_alloc(allocator, &allocator->buffer_objects);
     if (!this)
     {
         JVM_ERROR(allocator, "Could not allocate memory for buffer allocation");
         return VK_ERROR_OUT_OF_HOST_MEMORY;
     }
 
-    VkBuffer buffer;
-    VkResult vk_result = vkCreateBuffer(allocator->device, create_info, allocator_vk_callbacks(allocator), &buffer);
-    if (vk_result != VK_SUCCESS)
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkResult vk_result;
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    if (!jvm_find_buffer_memory_requirements(allocator, create_info, &mem_req, &prefers_dedicated))
     {
-        JVM_ERROR(allocator, "Could not create new buffer: call to vkCreateBuffer failed");
-        jvm_free(allocator, this);
-        return vk_result;
+        //  Requirements are not known yet, so the buffer has to be created to get them
+        vk_result = vkCreateBuffer(allocator->device, create_info, jvm_vk_callbacks(allocator), &buffer);
+        if (vk_result != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not create new buffer: call to vkCreateBuffer failed");
+            jvm_object_free(allocator, &allocator->buffer_objects, this);
+            return vk_result;
+        }
+        jvm_query_buffer_memory_requirements(allocator, buffer, &mem_req, &prefers_dedicated);
+        jvm_cache_buffer_memory_requirements(allocator, create_info, &mem_req, prefers_dedicated);
     }
-
-    VkMemoryRequirements mem_req;
-    vkGetBufferMemoryRequirements(allocator->device, buffer, &mem_req);
+    if (!dedicated)
+    {
+        dedicated = jvm_should_be_dedicated(allocator, mem_req.size, prefers_dedicated);
+    }
+    if (buffer == VK_NULL_HANDLE && dedicated && allocator->dedicated_allocation)
+    {
+        //  Dedicated allocation has to name the buffer it is for
+        vk_result = vkCreateBuffer(allocator->device, create_info, jvm_vk_callbacks(allocator), &buffer);
+        if (vk_result != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not create new buffer: call to vkCreateBuffer failed");
+            jvm_object_free(allocator, &allocator->buffer_objects, this);
+            return vk_result;
+        }
+    }
+    const VkMemoryDedicatedAllocateInfo dedicated_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+                    .buffer = buffer,
+            };
 
     vk_result = !dedicated ? jvm_allocate(
             allocator,
             mem_req.size,
             mem_req.alignment, mem_req.memoryTypeBits,
-            desired_flags,
-            undesired_flags,
+            &info,
+            JVM_TILING_CLASS_LINEAR,
             &this->allocation
 #ifdef JVM_TRACK_ALLOCATIONS
             ,file, line
@@ -579,8 +1417,9 @@ VkResult jvm_buffer_create(
                     allocator,
                     mem_req.size,
                     mem_req.alignment, mem_req.memoryTypeBits,
-                    desired_flags,
-                    undesired_flags,
+                    &info,
+                    JVM_TILING_CLASS_LINEAR,
+                    allocator->dedicated_allocation ? &dedicated_info : NULL,
                     &this->allocation
 #ifdef JVM_TRACK_ALLOCATIONS
                     ,file, line
@@ -589,24 +1428,40 @@ VkResult jvm_buffer_create(
     if (vk_result != VK_SUCCESS)
     {
         JVM_ERROR(allocator, "Could not allocate memory required for the buffer");
-        vkDestroyBuffer(allocator->device, buffer, allocator_vk_callbacks(allocator));
-        jvm_free(allocator, this);
+        if (buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        }
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
         return vk_result;
     }
+    if (buffer == VK_NULL_HANDLE)
+    {
+        //  Memory was found before the buffer was created
+        vk_result = vkCreateBuffer(allocator->device, create_info, jvm_vk_callbacks(allocator), &buffer);
+        if (vk_result != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not create new buffer: call to vkCreateBuffer failed");
+            jvm_deallocate(allocator, this->allocation);
+            jvm_object_free(allocator, &allocator->buffer_objects, this);
+            return vk_result;
+        }
+    }
     vk_result = vkBindBufferMemory(
             allocator->device, buffer, this->allocation->memory,
             this->allocation->chunk_offset + this->allocation->padding);
     if (vk_result != VK_SUCCESS)
     {
         JVM_ERROR(allocator, "Could not bind memory to buffer");
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
         jvm_deallocate(allocator, this->allocation);
-        vkDestroyBuffer(allocator->device, buffer, allocator_vk_callbacks(allocator));
-        jvm_free(allocator, this);
+        jvm_object_free(allocator, &allocator->buffer_objects, this);
         return vk_result;
     }
     this->buffer_size = create_info->size;
     this->buffer = buffer;
     this->allocator = allocator;
+    this->evictable = NULL;
 
     *p_out = this;
     return VK_SUCCESS;
@@ -615,13 +1470,13 @@ VkResult jvm_buffer_create(
 VkResult jvm_deallocate(jvm_allocator* allocator, jvm_chunk* chunk)
 {
     jvm_allocation_pool* const pool = chunk->pool;
-    const int dealloc_res = deallocate_from_pool(allocator, pool, chunk);
+    const int dealloc_res = jvm_deallocate_from_pool(allocator, pool, chunk);
     if (dealloc_res < 0)
     {
         JVM_ERROR(allocator, "Could not deallocate chunk");
         return VK_ERROR_UNKNOWN;
     }
-    if (pool->chunk_count == 1 && allocator->automatically_free_unused)
+    if (pool_is_unused(pool) && pool_released_when_unused(allocator, pool))
     {
         const int remove_res = remove_pool(allocator, pool);
         if (remove_res < 0)
@@ -768,126 +1623,135 @@ VkResult jvm_chunk_mapped_invalidate(jvm_allocator* allocator, jvm_chunk* chunk)
     return vkInvalidateMappedMemoryRanges(allocator->device, 1, &range);
 }
 
-VkResult jvm_allocate_dedicated(
-        jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize alignment, uint32_t type_bits,
-        VkMemoryPropertyFlags desired_flags, VkMemoryPropertyFlags undesired_flags, jvm_chunk** p_out
-#ifdef JVM_TRACK_ALLOCATIONS
-        ,const char* file, int line
-#endif
-)
+//  Copies data into the chunk, or fills it with value if data is NULL, and flushes it if needed
+static VkResult write_to_chunk(
+        jvm_allocator* allocator, jvm_chunk* chunk, VkDeviceSize offset, const void* data, int value, VkDeviceSize size)
 {
-    if (size < allocator->min_allocation_size)
+    uint8_t* pool_ptr;
+    int first_map;
+    VkResult res = map_pool_memory(allocator, chunk->pool, &pool_ptr, &first_map);
+    if (res != VK_SUCCESS)
     {
-        //  Should be at least this size
-        size = allocator->min_allocation_size;
+        JVM_ERROR(allocator, "Could not map pool memory");
+        return res;
     }
-
-    if (size < alignment)
+    const VkMemoryPropertyFlags flags = chunk->pool->memory_type_info.propertyFlags;
+    uint8_t* const dst = pool_ptr + chunk->chunk_offset + chunk->padding + offset;
+    if (data)
     {
-        size = alignment;
+        jvm_mapped_copy(allocator, flags, dst, data, size);
     }
-
-    //  Reset scores
-    const uint32_t mem_type_count = allocator->memory_properties.memoryTypeCount;
-    int64_t scores[VK_MAX_MEMORY_TYPES] = { 0 };
-    //  Check for unwanted flags
-    unsigned valid_count = 0;
-    if (undesired_flags)
+    else
     {
-        for (unsigned i = 0; i < mem_type_count; ++i)
-        {
-            if (allocator->memory_properties.memoryTypes[i].propertyFlags & undesired_flags)
-            {
-                scores[i] = -1;
-            }
-            valid_count += 1;
-        }
-        if (valid_count == 0)
-        {
-            JVM_ERROR(allocator, "Out of %u available memory types, none contained none of the undesired flags",
-                      mem_type_count);
-            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
-        }
+        jvm_mapped_set(allocator, flags, dst, value, size);
     }
-
-    //  Check for allowed memory types
-    for (unsigned i = 0; i < mem_type_count; ++i)
+    if (!(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
     {
-        //  If the type does not have the flag bit set, then it can not be used
-        if (!(type_bits & (1 << i)))
-        {
-            scores[i] = -2;
-        }
+        res = jvm_chunk_mapped_flush(allocator, chunk);
     }
+    int last_unmap;
+    const VkResult unmap_res = unmap_pool_memory(allocator, chunk->pool, &last_unmap);
+    return res != VK_SUCCESS ? res : unmap_res;
+}
+
+VkResult jvm_chunk_write(
+        jvm_allocator* allocator, jvm_chunk* chunk, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+    return write_to_chunk(allocator, chunk, offset, data, 0, size);
+}
 
-    valid_count = 0;
-    for (unsigned i = 0; i < mem_type_count; ++i)
+VkResult jvm_chunk_fill(
+        jvm_allocator* allocator, jvm_chunk* chunk, VkDeviceSize offset, uint8_t value, VkDeviceSize size)
+{
+    return write_to_chunk(allocator, chunk, offset, NULL, value, size);
+}
+
+VkResult jvm_allocate_dedicated(
+        jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize alignment, uint32_t type_bits,
+        const jvm_allocation_create_info* allocation_info, jvm_tiling_class tiling,
+        const VkMemoryDedicatedAllocateInfo* dedicated_info, jvm_chunk** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    //  Memory allocated with VkMemoryDedicatedAllocateInfo must be exactly VkMemoryRequirements::size, so it is only
+    //  rounded up when it is not tied to its resource
+    if (!dedicated_info)
     {
-        if (scores[i] == -1)
+        if (size < allocator->min_allocation_size)
         {
-            //  Has undesired flags
-            continue;
+            //  Should be at least this size
+            size = allocator->min_allocation_size;
         }
-        if ((allocator->memory_properties.memoryTypes[i].propertyFlags & desired_flags) == desired_flags)
-        {
-            //  Has (at least) all desired flags
-            valid_count += 1;
-            scores[i] = (int64_t) (
-                    allocator->memory_properties.memoryHeaps[allocator->memory_properties.memoryTypes[i].heapIndex].size
-                            >> 10);
-        }
-    }
-    if (valid_count == 0)
-    {
-        JVM_ERROR(allocator, "There was no memory type with desired memory flags");
-        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
-    }
 
-    int64_t best_score = 0;
-    uint32_t idx = mem_type_count;
-    for (unsigned i = 0; i < mem_type_count; ++i)
-    {
-        if (scores[i] > best_score)
+        if (size < alignment)
         {
-            best_score = scores[i];
-            idx = (uint32_t) i;
+            size = alignment;
         }
     }
-    if (best_score == 0)
+
+    uint32_t idx;
+    const VkBool32 allow_lazy = (allocation_info->desired_flags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) ||
+                                allocation_info->usage == JVM_MEMORY_USAGE_GPU_LAZY;
+    const VkResult type_res = jvm_choose_memory_type(allocator, type_bits, allocation_info, allow_lazy, &idx);
+    if (type_res != VK_SUCCESS)
     {
         JVM_ERROR(allocator, "There was no available memory type to support allocation given the nature of the allocation,"
                              " the desired, and the undesired flags");
-        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        return type_res;
     }
 
-    //  Check for need to map
-    if ((allocator->memory_properties.memoryTypes[idx].propertyFlags & desired_flags) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    //  Dedicated allocation requires a new pool, for which memory is freed up the same way as in jvm_allocate. Its size
+    //  can not be reduced, so the only other option is falling back to another memory type
+    VkDeviceSize new_pool_size;
+    VkDeviceSize type_alignment;
+    VkResult vk_result;
+    const VkExportMemoryAllocateInfo export_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+                    .handleTypes = allocation_info->export_handle_types,
+            };
+    do
     {
-        if (alignment < allocator->min_map_alignment)
+        new_pool_size = size;
+        type_alignment = alignment;
+        if (!dedicated_info)
         {
-            alignment = allocator->min_map_alignment;
+            adjust_for_mapping(allocator, idx, &new_pool_size, &type_alignment);
         }
-        if (size < alignment)
+        for (;;)
         {
-            size = alignment;
+            if (over_budget(allocator, idx, new_pool_size) &&
+                relieve_pressure(allocator, idx, new_pool_size, &new_pool_size))
+            {
+                continue;
+            }
+            vk_result = create_new_pool(
+                    allocator,
+                    new_pool_size,
+                    idx, allocator->memory_properties.memoryTypes[idx], 1, dedicated_info,
+                    jvm_allocation_priority(allocator, allocation_info), 0,
+                    allocation_info->export_handle_types ? &export_info : NULL);
+            if (vk_result != VK_ERROR_OUT_OF_DEVICE_MEMORY ||
+                !relieve_pressure(allocator, idx, new_pool_size, &new_pool_size))
+            {
+                break;
+            }
         }
-    }
-
-    //  Dedicated allocation requires a new pool
-    const VkDeviceSize new_pool_size = size;
-    VkResult vk_result = create_new_pool(
-            allocator,
-            new_pool_size,
-            idx, allocator->memory_properties.memoryTypes[idx]);
+    } while (vk_result == VK_ERROR_OUT_OF_DEVICE_MEMORY &&
+             choose_fallback_type(allocator, allocation_info, allow_lazy, &type_bits, &idx));
     if (vk_result != VK_SUCCESS)
     {
         JVM_ERROR(allocator, "Could not allocate new memory pool of size %zu", (size_t) new_pool_size);
         return vk_result;
     }
 
+    jvm_allocation_pool* const new_pool = allocator->pools[allocator->pool_count - 1];
+    new_pool->export_handle_types = allocation_info->export_handle_types;
     jvm_chunk* allocation;
-    const int alloc_res = allocate_from_pool(
-            allocator, allocator->pools[allocator->pool_count - 1], size, alignment, &allocation);
+    const int alloc_res = jvm_allocate_from_pool(
+            allocator, new_pool, new_pool_size, type_alignment, tiling, JVM_ALLOCATION_STRATEGY_FIRST_FIT, &allocation);
     assert(alloc_res <= 0);
     if (alloc_res != 0)
     {
@@ -903,6 +1767,48 @@ VkResult jvm_allocate_dedicated(
     return VK_SUCCESS;
 }
 
+VkResult jvm_import_memory(
+        jvm_allocator* allocator, VkDeviceSize size, VkDeviceSize offset, uint32_t idx,
+        const VkMemoryDedicatedAllocateInfo* dedicated_info, const void* import_info, jvm_tiling_class tiling,
+        jvm_chunk** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    //  Imported memory gets a pool of its own, since its size is given and it can not be shared with other resources
+    const VkResult vk_result = create_new_pool(
+            allocator, size, idx, allocator->memory_properties.memoryTypes[idx], 1, dedicated_info,
+            JVM_DEFAULT_PRIORITY, 0, import_info);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not import memory of size %zu", (size_t) size);
+        return vk_result;
+    }
+    jvm_allocation_pool* const pool = allocator->pools[allocator->pool_count - 1];
+    jvm_chunk* allocation;
+    const int alloc_res = jvm_allocate_from_pool(
+            allocator, pool, size, 1, tiling, JVM_ALLOCATION_STRATEGY_FIRST_FIT, &allocation);
+    assert(alloc_res <= 0);
+    if (alloc_res != 0)
+    {
+        //  Could not allocate memory for pool internally. Memory was already imported, so freeing it releases what was
+        //  imported as well
+        const int remove_res = remove_pool(allocator, pool);
+        (void) remove_res;
+        assert(remove_res == 0);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    //  Chunk covers all the memory, and the resource is where the exporter put it
+    allocation->padding = offset;
+#ifdef JVM_TRACK_ALLOCATIONS
+    allocation->file = file;
+    allocation->line = line;
+#endif
+    *p_out = allocation;
+    return VK_SUCCESS;
+}
+
 VkResult jvm_buffer_mapped_flush(jvm_buffer_allocation* buffer_allocation)
 {
     return jvm_chunk_mapped_flush(buffer_allocation->allocator, buffer_allocation->allocation);
@@ -926,16 +1832,309 @@ VkResult jvm_image_mapped_invalidate(jvm_image_allocation* image_allocation)
 VkResult jvm_buffer_destroy(jvm_buffer_allocation* buffer_allocation)
 {
     jvm_allocator* const allocator = buffer_allocation->allocator;
-    vkDestroyBuffer(allocator->device, buffer_allocation->buffer, allocator_vk_callbacks(allocator));
+    if (buffer_allocation->evictable)
+    {
+        jvm_evictable_remove(allocator, buffer_allocation->evictable);
+    }
+    vkDestroyBuffer(allocator->device, buffer_allocation->buffer, jvm_vk_callbacks(allocator));
     jvm_chunk* const chunk = buffer_allocation->allocation;
     if (chunk->mapped)
     {
         (void) jvm_chunk_unmap(allocator, chunk);
     }
-    jvm_free(allocator, buffer_allocation);
+    jvm_object_free(allocator, &allocator->buffer_objects, buffer_allocation);
     return jvm_deallocate(allocator, chunk);
 }
 
+VkResult jvm_reserve_deferred(jvm_allocator* allocator, unsigned count)
+{
+    if (allocator->deferred_count + count > allocator->deferred_capacity)
+    {
+        unsigned new_capacity = (allocator->deferred_capacity ? allocator->deferred_capacity : 32) << 1;
+        while (new_capacity < allocator->deferred_count + count)
+        {
+            new_capacity <<= 1;
+        }
+        jvm_deferred_destruction* const new_ptr = jvm_realloc(
+                allocator, allocator->deferred, sizeof(*allocator->deferred) * new_capacity);
+        if (!new_ptr)
+        {
+            JVM_ERROR(allocator, "Could not (re-)allocate deferred destruction queue");
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        allocator->deferred = new_ptr;
+        allocator->deferred_capacity = new_capacity;
+    }
+    return VK_SUCCESS;
+}
+
+VkResult jvm_defer_destruction(
+        jvm_allocator* allocator, uint64_t retire_value, VkBuffer buffer, VkImage image, jvm_chunk* chunk)
+{
+    const VkResult res = jvm_reserve_deferred(allocator, 1);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    allocator->deferred[allocator->deferred_count] = (jvm_deferred_destruction)
+            {
+                    .retire_value = retire_value,
+                    .buffer = buffer,
+                    .image = image,
+                    .chunk = chunk,
+            };
+    allocator->deferred_count += 1;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_buffer_destroy_deferred(jvm_buffer_allocation* buffer_allocation, uint64_t retire_value)
+{
+    jvm_allocator* const allocator = buffer_allocation->allocator;
+    jvm_chunk* const chunk = buffer_allocation->allocation;
+    const VkResult res = jvm_defer_destruction(allocator, retire_value, buffer_allocation->buffer, VK_NULL_HANDLE, chunk);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    if (buffer_allocation->evictable)
+    {
+        jvm_evictable_remove(allocator, buffer_allocation->evictable);
+    }
+    if (chunk->mapped)
+    {
+        (void) jvm_chunk_unmap(allocator, chunk);
+    }
+    jvm_object_free(allocator, &allocator->buffer_objects, buffer_allocation);
+    return VK_SUCCESS;
+}
+
+//  Copies the first size bytes of one host visible chunk into another
+static VkResult copy_chunk_on_host(jvm_allocator* allocator, jvm_chunk* src, jvm_chunk* dst, VkDeviceSize size)
+{
+    uint8_t* src_ptr;
+    uint8_t* dst_ptr;
+    int first;
+    VkResult res = map_pool_memory(allocator, src->pool, &src_ptr, &first);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    res = map_pool_memory(allocator, dst->pool, &dst_ptr, &first);
+    if (res != VK_SUCCESS)
+    {
+        (void) unmap_pool_memory(allocator, src->pool, &first);
+        return res;
+    }
+    res = jvm_chunk_mapped_invalidate(allocator, src);
+    if (res == VK_SUCCESS)
+    {
+        memcpy(dst_ptr + dst->chunk_offset + dst->padding, src_ptr + src->chunk_offset + src->padding, (size_t) size);
+        res = jvm_chunk_mapped_flush(allocator, dst);
+    }
+    (void) unmap_pool_memory(allocator, dst->pool, &first);
+    (void) unmap_pool_memory(allocator, src->pool, &first);
+    return res;
+}
+
+VkResult jvm_buffer_resize(
+        jvm_buffer_allocation* buffer_allocation, const VkBufferCreateInfo* create_info, VkCommandBuffer command_buffer,
+        uint64_t retire_value, VkBool32* p_moved
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    jvm_allocator* const allocator = buffer_allocation->allocator;
+    //  Reserved up front, so that the old buffer can always be queued once the new one is in place
+    VkResult res = jvm_reserve_deferred(allocator, 1);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    VkBuffer buffer;
+    res = vkCreateBuffer(allocator->device, create_info, jvm_vk_callbacks(allocator), &buffer);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create new buffer: call to vkCreateBuffer failed");
+        return res;
+    }
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    if (!jvm_find_buffer_memory_requirements(allocator, create_info, &mem_req, &prefers_dedicated))
+    {
+        jvm_query_buffer_memory_requirements(allocator, buffer, &mem_req, &prefers_dedicated);
+        jvm_cache_buffer_memory_requirements(allocator, create_info, &mem_req, prefers_dedicated);
+    }
+
+    jvm_chunk* const chunk = buffer_allocation->allocation;
+    jvm_allocation_pool* const pool = chunk->pool;
+    const VkDeviceSize offset = chunk->chunk_offset + chunk->padding;
+    if ((mem_req.memoryTypeBits & (1u << pool->memory_type_index)) && !(offset & (mem_req.alignment - 1)) &&
+        grow_chunk_in_place(allocator, chunk, mem_req.size, 0))
+    {
+        //  Contents stay where they are, only the buffer covering them changes. It is bound before the chunk takes the
+        //  memory after it, so that the pool is left as it was if binding fails
+        res = vkBindBufferMemory(allocator->device, buffer, chunk->memory, offset);
+        if (res != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not bind memory to buffer");
+            vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+            return res;
+        }
+        const int grown = grow_chunk_in_place(allocator, chunk, mem_req.size, 1);
+        (void) grown;
+        assert(grown);
+        (void) jvm_defer_destruction(allocator, retire_value, buffer_allocation->buffer, VK_NULL_HANDLE, NULL);
+        buffer_allocation->buffer = buffer;
+        buffer_allocation->buffer_size = create_info->size;
+        if (p_moved)
+        {
+            *p_moved = 0;
+        }
+        return VK_SUCCESS;
+    }
+
+    //  Moved to memory of the same type if the new requirements allow it, with the same priority and lifetime. Memory
+    //  must also be exportable as the same handle types, since those are what the buffer was created for
+    const jvm_allocation_create_info info =
+            {
+                    .usage = JVM_MEMORY_USAGE_UNKNOWN,
+                    .desired_flags = pool->memory_type_info.propertyFlags,
+                    .priority = pool->priority,
+                    .lifetime = pool->lifetime,
+                    .export_handle_types = pool->export_handle_types,
+            };
+    const uint32_t type_bits = mem_req.memoryTypeBits & (1u << pool->memory_type_index) ? 1u << pool->memory_type_index
+                                                                                       : mem_req.memoryTypeBits;
+    const VkMemoryDedicatedAllocateInfo dedicated_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+                    .buffer = buffer,
+            };
+    //  Making room for the new memory may evict resources on the heap, but the buffer being moved must survive it
+    jvm_evictable* const evictable = buffer_allocation->evictable;
+    if (evictable)
+    {
+        evictable->pinned = 1;
+    }
+    jvm_chunk* allocation;
+    res = !pool->dedicated && !jvm_should_be_dedicated(allocator, mem_req.size, prefers_dedicated)
+          ? jvm_allocate(
+                    allocator, mem_req.size, mem_req.alignment, type_bits, &info, JVM_TILING_CLASS_LINEAR, &allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+                    ,file, line
+#endif
+            )
+          : jvm_allocate_dedicated(
+                    allocator, mem_req.size, mem_req.alignment, type_bits, &info, JVM_TILING_CLASS_LINEAR,
+                    allocator->dedicated_allocation ? &dedicated_info : NULL, &allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+                    ,file, line
+#endif
+            );
+    if (evictable)
+    {
+        evictable->pinned = 0;
+    }
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory required for the resized buffer");
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        return res;
+    }
+    res = vkBindBufferMemory(allocator->device, buffer, allocation->memory, allocation->chunk_offset + allocation->padding);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not bind memory to buffer");
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        jvm_deallocate(allocator, allocation);
+        return res;
+    }
+
+    const VkDeviceSize copy_size = buffer_allocation->buffer_size < create_info->size ? buffer_allocation->buffer_size
+                                                                                       : create_info->size;
+    if (command_buffer != VK_NULL_HANDLE)
+    {
+        const VkBufferCopy region = {.srcOffset = 0, .dstOffset = 0, .size = copy_size};
+        vkCmdCopyBuffer(command_buffer, buffer_allocation->buffer, buffer, 1, &region);
+    }
+    else if ((pool->memory_type_info.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+             (allocation->pool->memory_type_info.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+    {
+        res = copy_chunk_on_host(allocator, chunk, allocation, copy_size);
+        if (res != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not copy contents of the buffer on the host");
+            vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+            jvm_deallocate(allocator, allocation);
+            return res;
+        }
+    }
+    if (chunk->mapped)
+    {
+        (void) jvm_chunk_unmap(allocator, chunk);
+    }
+    (void) jvm_defer_destruction(allocator, retire_value, buffer_allocation->buffer, VK_NULL_HANDLE, chunk);
+    buffer_allocation->allocation = allocation;
+    buffer_allocation->buffer = buffer;
+    buffer_allocation->buffer_size = create_info->size;
+    if (p_moved)
+    {
+        *p_moved = 1;
+    }
+    return VK_SUCCESS;
+}
+
+VkResult jvm_allocator_report_progress(jvm_allocator* allocator, uint64_t completed_value)
+{
+    VkResult res = VK_SUCCESS;
+    unsigned kept = 0;
+    if (completed_value > allocator->completed_value)
+    {
+        allocator->completed_value = completed_value;
+    }
+    //  Destroy all Vulkan objects first and return their memory, then release pools which became empty all at once
+    for (unsigned i = 0; i < allocator->deferred_count; ++i)
+    {
+        const jvm_deferred_destruction entry = allocator->deferred[i];
+        if (entry.retire_value > completed_value)
+        {
+            allocator->deferred[kept++] = entry;
+            continue;
+        }
+        if (entry.buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(allocator->device, entry.buffer, jvm_vk_callbacks(allocator));
+        }
+        if (entry.image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(allocator->device, entry.image, jvm_vk_callbacks(allocator));
+        }
+        if (entry.chunk && jvm_deallocate_from_pool(allocator, entry.chunk->pool, entry.chunk) < 0)
+        {
+            JVM_ERROR(allocator, "Could not deallocate chunk");
+            res = VK_ERROR_UNKNOWN;
+        }
+    }
+    const unsigned released = allocator->deferred_count - kept;
+    allocator->deferred_count = kept;
+
+    if (released)
+    {
+        for (unsigned i = allocator->pool_count; i > 0; --i)
+        {
+            jvm_allocation_pool* const pool = allocator->pools[i - 1];
+            if (pool_is_unused(pool) && pool_released_when_unused(allocator, pool))
+            {
+                const int remove_res = remove_pool(allocator, pool);
+                (void) remove_res;
+                assert(remove_res == 0);
+            }
+        }
+    }
+    return res;
+}
+
 VkResult jvm_image_create(
         jvm_allocator* allocator, const VkImageCreateInfo* create_info, VkMemoryPropertyFlags desired_flags,
         VkMemoryPropertyFlags undesired_flags, VkBool32 dedicated, jvm_image_allocation** p_out
@@ -944,31 +2143,92 @@ VkResult jvm_image_create(
 #endif
 )
 {
-    jvm_image_allocation* const this = jvm_alloc(allocator, sizeof(*this));
+    const jvm_allocation_create_info allocation_info =
+            {
+                    .usage = JVM_MEMORY_USAGE_UNKNOWN,
+                    .desired_flags = desired_flags,
+                    .undesired_flags = undesired_flags,
+                    .dedicated = dedicated,
+            };
+    return jvm_image_create2(
+            allocator, create_info, &allocation_info, p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            );
+}
+
+VkResult jvm_image_create2(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info,
+        const jvm_allocation_create_info* allocation_info, jvm_image_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    jvm_allocation_create_info info = *allocation_info;
+    VkBool32 dedicated = info.dedicated;
+    jvm_image_allocation* const this = jvm_object_alloc(allocator, &allocator->image_objects);
     if (!this)
     {
         JVM_ERROR(allocator, "Could not allocate memory for image allocation");
         return VK_ERROR_OUT_OF_HOST_MEMORY;
     }
 
-    VkImage img;
-    VkResult vk_result = vkCreateImage(allocator->device, create_info, allocator_vk_callbacks(allocator), &img);
-    if (vk_result != VK_SUCCESS)
+    VkImage img = VK_NULL_HANDLE;
+    VkResult vk_result;
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    if (!jvm_find_image_memory_requirements(allocator, create_info, &mem_req, &prefers_dedicated))
     {
-        JVM_ERROR(allocator, "Could not create new image");
-        jvm_free(allocator, this);
-        return vk_result;
+        //  Requirements are not known yet, so the image has to be created to get them
+        vk_result = vkCreateImage(allocator->device, create_info, jvm_vk_callbacks(allocator), &img);
+        if (vk_result != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not create new image");
+            jvm_object_free(allocator, &allocator->image_objects, this);
+            return vk_result;
+        }
+        jvm_query_image_memory_requirements(allocator, img, &mem_req, &prefers_dedicated);
+        jvm_cache_image_memory_requirements(allocator, create_info, &mem_req, prefers_dedicated);
+    }
+    if ((create_info->usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT || info.usage == JVM_MEMORY_USAGE_GPU_LAZY) &&
+        jvm_transient_attachment_flags(
+                &allocator->memory_properties, mem_req.memoryTypeBits, &info.desired_flags, &info.undesired_flags))
+    {
+        //  Lazily allocated memory must not be shared with other resources
+        dedicated = 1;
+    }
+    if (!dedicated)
+    {
+        dedicated = jvm_should_be_dedicated(allocator, mem_req.size, prefers_dedicated);
+    }
+    if (img == VK_NULL_HANDLE && dedicated && allocator->dedicated_allocation)
+    {
+        //  Dedicated allocation has to name the image it is for
+        vk_result = vkCreateImage(allocator->device, create_info, jvm_vk_callbacks(allocator), &img);
+        if (vk_result != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not create new image");
+            jvm_object_free(allocator, &allocator->image_objects, this);
+            return vk_result;
+        }
     }
+    const VkMemoryDedicatedAllocateInfo dedicated_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+                    .image = img,
+            };
 
-    VkMemoryRequirements mem_req;
-    vkGetImageMemoryRequirements(allocator->device, img, &mem_req);
+    const jvm_tiling_class tiling =
+            create_info->tiling == VK_IMAGE_TILING_LINEAR ? JVM_TILING_CLASS_LINEAR : JVM_TILING_CLASS_OPTIMAL;
 
     vk_result = !dedicated ? jvm_allocate(
             allocator,
             mem_req.size,
             mem_req.alignment, mem_req.memoryTypeBits,
-            desired_flags,
-            undesired_flags,
+            &info,
+            tiling,
             &this->allocation
 #ifdef JVM_TRACK_ALLOCATIONS
             ,file, line
@@ -978,8 +2238,9 @@ VkResult jvm_image_create(
                     allocator,
                     mem_req.size,
                     mem_req.alignment, mem_req.memoryTypeBits,
-                    desired_flags,
-                    undesired_flags,
+                    &info,
+                    tiling,
+                    allocator->dedicated_allocation ? &dedicated_info : NULL,
                     &this->allocation
 #ifdef JVM_TRACK_ALLOCATIONS
                     ,file, line
@@ -988,24 +2249,41 @@ VkResult jvm_image_create(
     if (vk_result != VK_SUCCESS)
     {
         JVM_ERROR(allocator, "Could not allocate memory required for the image");
-        vkDestroyImage(allocator->device, img, allocator_vk_callbacks(allocator));
-        jvm_free(allocator, this);
+        if (img != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(allocator->device, img, jvm_vk_callbacks(allocator));
+        }
+        jvm_object_free(allocator, &allocator->image_objects, this);
         return vk_result;
     }
+    if (img == VK_NULL_HANDLE)
+    {
+        //  Memory was found before the image was created
+        vk_result = vkCreateImage(allocator->device, create_info, jvm_vk_callbacks(allocator), &img);
+        if (vk_result != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not create new image");
+            jvm_deallocate(allocator, this->allocation);
+            jvm_object_free(allocator, &allocator->image_objects, this);
+            return vk_result;
+        }
+    }
     vk_result = vkBindImageMemory(
             allocator->device, img, this->allocation->memory,
             this->allocation->chunk_offset + this->allocation->padding);
     if (vk_result != VK_SUCCESS)
     {
         JVM_ERROR(allocator, "Could not bind memory to image");
+        vkDestroyImage(allocator->device, img, jvm_vk_callbacks(allocator));
         jvm_deallocate(allocator, this->allocation);
-        vkDestroyImage(allocator->device, img, allocator_vk_callbacks(allocator));
-        jvm_free(allocator, this);
+        jvm_object_free(allocator, &allocator->image_objects, this);
         return vk_result;
     }
     this->image = img;
     this->allocator = allocator;
     this->extent = create_info->extent;
+    this->format = create_info->format;
+    this->evictable = NULL;
 
     *p_out = this;
     return VK_SUCCESS;
@@ -1015,16 +2293,41 @@ VkResult
 jvm_image_destroy(jvm_image_allocation* image_allocation)
 {
     jvm_allocator* const allocator = image_allocation->allocator;
-    vkDestroyImage(allocator->device, image_allocation->image, allocator_vk_callbacks(allocator));
+    if (image_allocation->evictable)
+    {
+        jvm_evictable_remove(allocator, image_allocation->evictable);
+    }
+    vkDestroyImage(allocator->device, image_allocation->image, jvm_vk_callbacks(allocator));
     jvm_chunk* const chunk = image_allocation->allocation;
     if (chunk->mapped)
     {
         (void) jvm_chunk_unmap(allocator, chunk);
     }
-    jvm_free(allocator, image_allocation);
+    jvm_object_free(allocator, &allocator->image_objects, image_allocation);
     return jvm_deallocate(allocator, chunk);
 }
 
+VkResult jvm_image_destroy_deferred(jvm_image_allocation* image_allocation, uint64_t retire_value)
+{
+    jvm_allocator* const allocator = image_allocation->allocator;
+    jvm_chunk* const chunk = image_allocation->allocation;
+    const VkResult res = jvm_defer_destruction(allocator, retire_value, VK_NULL_HANDLE, image_allocation->image, chunk);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    if (image_allocation->evictable)
+    {
+        jvm_evictable_remove(allocator, image_allocation->evictable);
+    }
+    if (chunk->mapped)
+    {
+        (void) jvm_chunk_unmap(allocator, chunk);
+    }
+    jvm_object_free(allocator, &allocator->image_objects, image_allocation);
+    return VK_SUCCESS;
+}
+
 VkBuffer jvm_buffer_allocation_get_buffer(jvm_buffer_allocation* buffer_allocation)
 {
     return buffer_allocation->buffer;
@@ -1047,22 +2350,17 @@ jvm_allocator* jvm_image_allocation_get_allocator(jvm_image_allocation* image_al
 
 void jvm_allocator_free_unused(jvm_allocator* allocator)
 {
-#ifdef NDEBUG
-    if (allocator->automatically_free_unused)
-    {
-        return;
-    }
-#endif
-    for (unsigned i = 0; i < allocator->pool_count; ++i)
+    //  Going backwards, so that removing a pool does not skip the one after it
+    for (unsigned i = allocator->pool_count; i-- > 0;)
     {
         jvm_allocation_pool* const pool = allocator->pools[i];
-        if (pool->chunk_count > 1 || pool->chunks[0]->used)
+        if (!pool_is_unused(pool))
         {
-            //  Chunk has more than one chunk, or it is in use
+            //  Pool has more than one chunk, or it is in use
             continue;
         }
 #ifndef NDEBUG
-        if (allocator->automatically_free_unused)
+        if (pool_released_when_unused(allocator, pool))
         {
             JVM_ERROR(allocator, "Allocator should have freed block at index %u", i);
         }
@@ -1082,3 +2380,13 @@ VkExtent3D jvm_image_allocation_get_extent(jvm_image_allocation* image_allocatio
 {
     return image_allocation->extent;
 }
+
+VkMemoryPropertyFlags jvm_buffer_allocation_get_memory_flags(jvm_buffer_allocation* buffer_allocation)
+{
+    return buffer_allocation->allocation->pool->memory_type_info.propertyFlags;
+}
+
+VkMemoryPropertyFlags jvm_image_allocation_get_memory_flags(jvm_image_allocation* image_allocation)
+{
+    return image_allocation->allocation->pool->memory_type_info.propertyFlags;
+}
@@ -0,0 +1,277 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include "../include/jvm.h"
+#include "internal.h"
+
+#undef jvm_allocate_for_buffer
+#undef jvm_allocate_for_image
+
+//  Binds are passed to vkBind*Memory2 in batches of this many, so that no host memory has to be allocated for them
+#define JVM_BIND_BATCH_SIZE 32
+
+static VkResult allocate_for_resource(
+        jvm_allocator* allocator, const VkMemoryRequirements* mem_req, VkBool32 prefers_dedicated,
+        const jvm_allocation_create_info* allocation_info, jvm_tiling_class tiling, VkBool32 dedicated,
+        const VkMemoryDedicatedAllocateInfo* dedicated_info, jvm_memory_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    jvm_memory_allocation* const this = jvm_object_alloc(allocator, &allocator->memory_objects);
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for memory allocation");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    if (!dedicated)
+    {
+        dedicated = allocation_info->dedicated || jvm_should_be_dedicated(allocator, mem_req->size, prefers_dedicated);
+    }
+    const VkResult res = !dedicated ? jvm_allocate(
+            allocator, mem_req->size, mem_req->alignment, mem_req->memoryTypeBits, allocation_info, tiling,
+            &this->allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            )
+                                    : jvm_allocate_dedicated(
+                    allocator, mem_req->size, mem_req->alignment, mem_req->memoryTypeBits, allocation_info, tiling,
+                    allocator->dedicated_allocation ? dedicated_info : NULL, &this->allocation
+#ifdef JVM_TRACK_ALLOCATIONS
+                    ,file, line
+#endif
+            );
+    if (res != VK_SUCCESS)
+    {
+        jvm_object_free(allocator, &allocator->memory_objects, this);
+        return res;
+    }
+    this->allocator = allocator;
+    this->size = mem_req->size;
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_allocate_for_buffer(
+        jvm_allocator* allocator, VkBuffer buffer, const jvm_allocation_create_info* allocation_info,
+        jvm_memory_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    jvm_query_buffer_memory_requirements(allocator, buffer, &mem_req, &prefers_dedicated);
+    const VkMemoryDedicatedAllocateInfo dedicated_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+                    .buffer = buffer,
+            };
+    const VkResult res = allocate_for_resource(
+            allocator, &mem_req, prefers_dedicated, allocation_info, JVM_TILING_CLASS_LINEAR, 0, &dedicated_info,
+            p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            );
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory required for the buffer");
+    }
+    return res;
+}
+
+VkResult jvm_allocate_for_image(
+        jvm_allocator* allocator, VkImage image, VkImageTiling tiling, const jvm_allocation_create_info* allocation_info,
+        jvm_memory_allocation** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    jvm_query_image_memory_requirements(allocator, image, &mem_req, &prefers_dedicated);
+    jvm_allocation_create_info info = *allocation_info;
+    //  Lazily allocated memory must not be shared with other resources
+    const VkBool32 lazy = info.usage == JVM_MEMORY_USAGE_GPU_LAZY && jvm_transient_attachment_flags(
+            &allocator->memory_properties, mem_req.memoryTypeBits, &info.desired_flags, &info.undesired_flags);
+    const VkMemoryDedicatedAllocateInfo dedicated_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+                    .image = image,
+            };
+    const VkResult res = allocate_for_resource(
+            allocator, &mem_req, prefers_dedicated, &info,
+            tiling == VK_IMAGE_TILING_LINEAR ? JVM_TILING_CLASS_LINEAR : JVM_TILING_CLASS_OPTIMAL, lazy, &dedicated_info,
+            p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,file, line
+#endif
+            );
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory required for the image");
+    }
+    return res;
+}
+
+static VkDeviceSize memory_offset(const jvm_memory_allocation* memory_allocation)
+{
+    return memory_allocation->allocation->chunk_offset + memory_allocation->allocation->padding;
+}
+
+VkResult jvm_bind_buffer_memory(
+        jvm_allocator* allocator, uint32_t count, jvm_memory_allocation* const* allocations, const VkBuffer* buffers)
+{
+    if (!allocator->bind_buffer_memory2)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const VkResult res = vkBindBufferMemory(
+                    allocator->device, buffers[i], allocations[i]->allocation->memory, memory_offset(allocations[i]));
+            if (res != VK_SUCCESS)
+            {
+                JVM_ERROR(allocator, "Could not bind memory to buffer %u", i);
+                return res;
+            }
+        }
+        return VK_SUCCESS;
+    }
+    VkBindBufferMemoryInfo infos[JVM_BIND_BATCH_SIZE];
+    for (uint32_t first = 0; first < count; first += JVM_BIND_BATCH_SIZE)
+    {
+        const uint32_t n = count - first < JVM_BIND_BATCH_SIZE ? count - first : JVM_BIND_BATCH_SIZE;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            infos[i] = (VkBindBufferMemoryInfo)
+                    {
+                            .sType = VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_INFO,
+                            .buffer = buffers[first + i],
+                            .memory = allocations[first + i]->allocation->memory,
+                            .memoryOffset = memory_offset(allocations[first + i]),
+                    };
+        }
+        const VkResult res = allocator->bind_buffer_memory2(allocator->device, n, infos);
+        if (res != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not bind memory to buffers: call to vkBindBufferMemory2 failed");
+            return res;
+        }
+    }
+    return VK_SUCCESS;
+}
+
+VkResult jvm_bind_image_memory(
+        jvm_allocator* allocator, uint32_t count, jvm_memory_allocation* const* allocations, const VkImage* images)
+{
+    if (!allocator->bind_image_memory2)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const VkResult res = vkBindImageMemory(
+                    allocator->device, images[i], allocations[i]->allocation->memory, memory_offset(allocations[i]));
+            if (res != VK_SUCCESS)
+            {
+                JVM_ERROR(allocator, "Could not bind memory to image %u", i);
+                return res;
+            }
+        }
+        return VK_SUCCESS;
+    }
+    VkBindImageMemoryInfo infos[JVM_BIND_BATCH_SIZE];
+    for (uint32_t first = 0; first < count; first += JVM_BIND_BATCH_SIZE)
+    {
+        const uint32_t n = count - first < JVM_BIND_BATCH_SIZE ? count - first : JVM_BIND_BATCH_SIZE;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            infos[i] = (VkBindImageMemoryInfo)
+                    {
+                            .sType = VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO,
+                            .image = images[first + i],
+                            .memory = allocations[first + i]->allocation->memory,
+                            .memoryOffset = memory_offset(allocations[first + i]),
+                    };
+        }
+        const VkResult res = allocator->bind_image_memory2(allocator->device, n, infos);
+        if (res != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not bind memory to images: call to vkBindImageMemory2 failed");
+            return res;
+        }
+    }
+    return VK_SUCCESS;
+}
+
+VkResult jvm_memory_free(jvm_memory_allocation* memory_allocation)
+{
+    jvm_allocator* const allocator = memory_allocation->allocator;
+    jvm_chunk* const chunk = memory_allocation->allocation;
+    if (chunk->mapped)
+    {
+        (void) jvm_chunk_unmap(allocator, chunk);
+    }
+    jvm_object_free(allocator, &allocator->memory_objects, memory_allocation);
+    return jvm_deallocate(allocator, chunk);
+}
+
+VkResult jvm_memory_free_deferred(jvm_memory_allocation* memory_allocation, uint64_t retire_value)
+{
+    jvm_allocator* const allocator = memory_allocation->allocator;
+    jvm_chunk* const chunk = memory_allocation->allocation;
+    const VkResult res = jvm_defer_destruction(allocator, retire_value, VK_NULL_HANDLE, VK_NULL_HANDLE, chunk);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    if (chunk->mapped)
+    {
+        (void) jvm_chunk_unmap(allocator, chunk);
+    }
+    jvm_object_free(allocator, &allocator->memory_objects, memory_allocation);
+    return VK_SUCCESS;
+}
+
+VkResult jvm_memory_map(jvm_memory_allocation* memory_allocation, size_t* p_size, void** p_out)
+{
+    return jvm_chunk_map(memory_allocation->allocator, memory_allocation->allocation, p_size, p_out);
+}
+
+VkResult jvm_memory_unmap(jvm_memory_allocation* memory_allocation)
+{
+    return jvm_chunk_unmap(memory_allocation->allocator, memory_allocation->allocation);
+}
+
+VkResult jvm_memory_mapped_flush(jvm_memory_allocation* memory_allocation)
+{
+    return jvm_chunk_mapped_flush(memory_allocation->allocator, memory_allocation->allocation);
+}
+
+VkResult jvm_memory_mapped_invalidate(jvm_memory_allocation* memory_allocation)
+{
+    return jvm_chunk_mapped_invalidate(memory_allocation->allocator, memory_allocation->allocation);
+}
+
+VkDeviceMemory jvm_memory_allocation_get_memory(jvm_memory_allocation* memory_allocation)
+{
+    return memory_allocation->allocation->memory;
+}
+
+VkDeviceSize jvm_memory_allocation_get_offset(jvm_memory_allocation* memory_allocation)
+{
+    return memory_offset(memory_allocation);
+}
+
+VkDeviceSize jvm_memory_allocation_get_size(jvm_memory_allocation* memory_allocation)
+{
+    return memory_allocation->size;
+}
+
+VkMemoryPropertyFlags jvm_memory_allocation_get_memory_flags(jvm_memory_allocation* memory_allocation)
+{
+    return memory_allocation->allocation->pool->memory_type_info.propertyFlags;
+}
@@ -0,0 +1,151 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+//  Returns the index of the first page at or after first and before end which is free if want_free is non-zero, or used
+//  otherwise. Returns end if there is none. Whole words which do not have it are skipped at once
+static uint32_t next_page(const uint64_t* free_pages, uint32_t first, uint32_t end, int want_free)
+{
+    if (first >= end)
+    {
+        return end;
+    }
+    const uint64_t flip = want_free ? 0 : ~(uint64_t) 0;
+    uint32_t w = first / 64;
+    uint64_t bits = (free_pages[w] ^ flip) & (~(uint64_t) 0 << (first % 64));
+    while (!bits)
+    {
+        w += 1;
+        if ((uint64_t) w * 64 >= end)
+        {
+            return end;
+        }
+        bits = free_pages[w] ^ flip;
+    }
+    const uint32_t page = w * 64 + jvm_lowest_bit(bits);
+    return page < end ? page : end;
+}
+
+//  Sets bits of pages [first, first + count) if value is non-zero, clears them otherwise
+static void set_pages(uint64_t* free_pages, uint32_t first, uint32_t count, int value)
+{
+    while (count)
+    {
+        const uint32_t bit = first % 64;
+        const uint32_t n = 64 - bit < count ? 64 - bit : count;
+        const uint64_t mask = (n == 64 ? ~(uint64_t) 0 : (((uint64_t) 1 << n) - 1)) << bit;
+        if (value)
+        {
+            free_pages[first / 64] |= mask;
+        }
+        else
+        {
+            free_pages[first / 64] &= ~mask;
+        }
+        first += n;
+        count -= n;
+    }
+}
+
+int jvm_page_pool_init(jvm_allocator* allocator, jvm_allocation_pool* pool, VkDeviceSize page_size)
+{
+    pool->page_size = page_size;
+    pool->page_count = (uint32_t) (pool->size / page_size);
+    pool->free_page_count = pool->page_count;
+    //  Bits past the last page stay clear, so they are never found free
+    const size_t words = (pool->page_count + 63) / 64;
+    pool->free_pages = jvm_alloc(allocator, sizeof(*pool->free_pages) * words);
+    if (!pool->free_pages)
+    {
+        JVM_ERROR(allocator, "Could not allocate page bitmap for pool of %u pages", pool->page_count);
+        return 0;
+    }
+    memset(pool->free_pages, 0, sizeof(*pool->free_pages) * words);
+    set_pages(pool->free_pages, 0, pool->page_count, 1);
+    return 1;
+}
+
+int jvm_page_pool_find(const jvm_allocation_pool* pool, uint32_t count, uint32_t* p_first)
+{
+    if (count > pool->free_page_count)
+    {
+        return 0;
+    }
+    uint32_t first = 0;
+    for (;;)
+    {
+        first = next_page(pool->free_pages, first, pool->page_count, 1);
+        if (pool->page_count - first < count)
+        {
+            return 0;
+        }
+        //  Run is long enough if no page in it is used, otherwise the search continues after the used page
+        const uint32_t used = next_page(pool->free_pages, first, first + count, 0);
+        if (used == first + count)
+        {
+            *p_first = first;
+            return 1;
+        }
+        first = used;
+    }
+}
+
+jvm_chunk* jvm_page_pool_take(
+        jvm_allocator* allocator, jvm_allocation_pool* pool, uint32_t first, uint32_t count, jvm_tiling_class tiling)
+{
+    jvm_chunk* const chunk = jvm_object_alloc(allocator, &allocator->chunk_objects);
+    if (!chunk)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for new chunk");
+        return NULL;
+    }
+    *chunk = (jvm_chunk)
+            {
+                    .size = pool->page_size * count,
+                    .chunk_offset = pool->page_size * first,
+                    .pool = pool,
+                    .memory = pool->memory,
+                    .used = 1,
+                    .tiling = tiling,
+                    .padding = 0,
+                    .mapped = 0,
+            };
+    set_pages(pool->free_pages, first, count, 0);
+    pool->free_page_count -= count;
+    return chunk;
+}
+
+void jvm_page_pool_give_back(jvm_allocator* allocator, jvm_chunk* chunk)
+{
+    jvm_allocation_pool* const pool = chunk->pool;
+    const uint32_t count = (uint32_t) (chunk->size / pool->page_size);
+    set_pages(pool->free_pages, (uint32_t) (chunk->chunk_offset / pool->page_size), count, 1);
+    pool->free_page_count += count;
+    jvm_object_free(allocator, &allocator->chunk_objects, chunk);
+}
+
+int jvm_page_pool_grow(jvm_allocation_pool* pool, jvm_chunk* chunk, uint32_t count, VkBool32 commit)
+{
+    const uint32_t first = (uint32_t) (chunk->chunk_offset / pool->page_size);
+    const uint32_t have = (uint32_t) (chunk->size / pool->page_size);
+    if (count <= have)
+    {
+        return 1;
+    }
+    if (pool->page_count - first < count || next_page(pool->free_pages, first + have, first + count, 0) != first + count)
+    {
+        return 0;
+    }
+    if (!commit)
+    {
+        return 1;
+    }
+    set_pages(pool->free_pages, first + have, count - have, 0);
+    pool->free_page_count -= count - have;
+    chunk->size = pool->page_size * count;
+    return 1;
+}
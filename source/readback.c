@@ -0,0 +1,279 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+static VkResult reserve_slot(jvm_readback* readback)
+{
+    if (readback->slot_count < readback->slot_capacity)
+    {
+        return VK_SUCCESS;
+    }
+    jvm_allocator* const allocator = readback->allocator;
+    const unsigned new_capacity = readback->slot_capacity ? readback->slot_capacity << 1 : 32;
+    jvm_readback_slot_info* const new_slots = jvm_realloc(
+            allocator, readback->slots, sizeof(*readback->slots) * new_capacity);
+    if (!new_slots)
+    {
+        JVM_ERROR(allocator, "Could not (re-)allocate readback slot array");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    readback->slots = new_slots;
+    VkMappedMemoryRange* const new_ranges = jvm_realloc(
+            allocator, readback->ranges, sizeof(*readback->ranges) * new_capacity);
+    if (!new_ranges)
+    {
+        JVM_ERROR(allocator, "Could not (re-)allocate readback range array");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    readback->ranges = new_ranges;
+    readback->slot_capacity = new_capacity;
+    return VK_SUCCESS;
+}
+
+//  Takes space for a new slot from the ring
+static VkResult acquire_slot(
+        jvm_readback* readback, VkDeviceSize size, VkDeviceSize alignment, uint64_t retire_value,
+        jvm_readback_slot_info** p_info)
+{
+    VkResult res = reserve_slot(readback);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    VkDeviceSize offset;
+    res = jvm_ring_acquire(&readback->ring, size, alignment, &offset);
+    if (res == VK_ERROR_OUT_OF_DEVICE_MEMORY)
+    {
+        JVM_ERROR(readback->allocator, "Readback of %zu bytes is larger than the readback ring (%zu bytes)",
+                  (size_t) size, (size_t) readback->ring.size);
+    }
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    //  Each slot is its own segment, so that it can be returned as soon as it and all before it are released
+    const jvm_readback_slot slot = readback->next_slot;
+    res = jvm_ring_close(readback->allocator, &readback->ring, slot);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    readback->next_slot += 1;
+    jvm_readback_slot_info* const info = readback->slots + readback->slot_count;
+    *info = (jvm_readback_slot_info)
+            {
+                    .slot = slot,
+                    .offset = offset,
+                    .size = size,
+                    .retire_value = retire_value,
+            };
+    readback->slot_count += 1;
+    readback->copied = 1;
+    if (retire_value > readback->last_retire_value)
+    {
+        readback->last_retire_value = retire_value;
+    }
+    *p_info = info;
+    return VK_SUCCESS;
+}
+
+static jvm_readback_slot_info* find_slot(jvm_readback* readback, jvm_readback_slot slot)
+{
+    //  Slots are kept in the order they were given out in
+    if (!readback->slot_count || slot < readback->slots[0].slot ||
+        slot - readback->slots[0].slot >= readback->slot_count)
+    {
+        return NULL;
+    }
+    return readback->slots + (slot - readback->slots[0].slot);
+}
+
+VkResult jvm_readback_create(jvm_allocator* allocator, VkDeviceSize ring_size, jvm_readback** p_out)
+{
+    jvm_readback* const this = jvm_alloc(allocator, sizeof(*this));
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for readback ring");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memset(this, 0, sizeof(*this));
+    this->allocator = allocator;
+    this->next_slot = 1;
+
+    const VkResult res = jvm_ring_create(
+            allocator, ring_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, JVM_MEMORY_USAGE_GPU_TO_CPU, &this->ring);
+    if (res != VK_SUCCESS)
+    {
+        jvm_free(allocator, this);
+        return res;
+    }
+
+    this->buffer_alignment = allocator->optimal_buffer_copy_offset_alignment;
+    if (this->buffer_alignment < 4)
+    {
+        this->buffer_alignment = 4;
+    }
+    this->atom_size = allocator->non_coherent_atom_size;
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+void jvm_readback_destroy(jvm_readback* readback)
+{
+    jvm_allocator* const allocator = readback->allocator;
+    //  Released slots are no longer tracked, but copies to them may still be executing
+    jvm_ring_destroy(allocator, &readback->ring, readback->copied, readback->last_retire_value);
+    jvm_free(allocator, readback->ranges);
+    jvm_free(allocator, readback->slots);
+    jvm_free(allocator, readback);
+}
+
+VkResult jvm_readback_read_buffer(
+        jvm_readback* readback, VkCommandBuffer command_buffer, jvm_buffer_allocation* buffer_allocation,
+        VkDeviceSize offset, VkDeviceSize size, uint64_t retire_value, jvm_readback_slot* p_slot)
+{
+    if (offset + size > buffer_allocation->buffer_size)
+    {
+        JVM_ERROR(readback->allocator, "Readback of [%zu, %zu) is out of bounds of a buffer of size %zu",
+                  (size_t) offset, (size_t) (offset + size), (size_t) buffer_allocation->buffer_size);
+        return VK_ERROR_UNKNOWN;
+    }
+    jvm_readback_slot_info* info;
+    const VkResult res = acquire_slot(readback, size, readback->buffer_alignment, retire_value, &info);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    const VkBufferCopy region = {.srcOffset = offset, .dstOffset = info->offset, .size = size};
+    vkCmdCopyBuffer(command_buffer, buffer_allocation->buffer, readback->ring.buffer->buffer, 1, &region);
+    *p_slot = info->slot;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_readback_read_image(
+        jvm_readback* readback, VkCommandBuffer command_buffer, jvm_image_allocation* image_allocation,
+        VkImageLayout layout, VkImageSubresourceLayers subresource, VkOffset3D offset, VkExtent3D extent,
+        VkDeviceSize size, uint64_t retire_value, jvm_readback_slot* p_slot)
+{
+    const VkDeviceSize alignment = jvm_image_copy_alignment(
+            readback->buffer_alignment, image_allocation->format, subresource.aspectMask);
+    if (!alignment)
+    {
+        JVM_ERROR(readback->allocator, "Texel block size of image format %d is not known, so it can not be read back",
+                  (int) image_allocation->format);
+        return VK_ERROR_FORMAT_NOT_SUPPORTED;
+    }
+    jvm_readback_slot_info* info;
+    const VkResult res = acquire_slot(readback, size, alignment, retire_value, &info);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    const VkBufferImageCopy region =
+            {
+                    .bufferOffset = info->offset,
+                    .imageSubresource = subresource,
+                    .imageOffset = offset,
+                    .imageExtent = extent,
+            };
+    vkCmdCopyImageToBuffer(
+            command_buffer, image_allocation->image, layout, readback->ring.buffer->buffer, 1, &region);
+    *p_slot = info->slot;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_readback_report_progress(jvm_readback* readback, uint64_t completed_value)
+{
+    const VkBool32 coherent = (readback->ring.memory_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    const jvm_chunk* const chunk = readback->ring.buffer->allocation;
+    const VkDeviceSize base = chunk->chunk_offset + chunk->padding;
+    const VkDeviceSize atom_mask = readback->atom_size - 1;
+    uint32_t range_count = 0;
+    for (unsigned i = 0; i < readback->slot_count; ++i)
+    {
+        jvm_readback_slot_info* const info = readback->slots + i;
+        if (info->ready || info->retire_value > completed_value)
+        {
+            continue;
+        }
+        info->ready = 1;
+        if (coherent)
+        {
+            continue;
+        }
+        //  Ranges must be aligned to the atom size, and neighbouring or overlapping ones are merged
+        const VkDeviceSize begin = (base + info->offset) & ~atom_mask;
+        VkDeviceSize end = (base + info->offset + info->size + atom_mask) & ~atom_mask;
+        if (end > chunk->pool->size)
+        {
+            end = chunk->pool->size;
+        }
+        VkMappedMemoryRange* const last = range_count ? readback->ranges + (range_count - 1) : NULL;
+        if (last && begin >= last->offset && begin <= last->offset + last->size)
+        {
+            if (end > last->offset + last->size)
+            {
+                last->size = end - last->offset;
+            }
+            continue;
+        }
+        readback->ranges[range_count++] = (VkMappedMemoryRange)
+                {
+                        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                        .memory = chunk->memory,
+                        .offset = begin,
+                        .size = end - begin,
+                };
+    }
+    if (!range_count)
+    {
+        return VK_SUCCESS;
+    }
+    const VkResult res = vkInvalidateMappedMemoryRanges(readback->allocator->device, range_count, readback->ranges);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(readback->allocator, "Could not invalidate readback ring");
+    }
+    return res;
+}
+
+const void* jvm_readback_get_data(jvm_readback* readback, jvm_readback_slot slot, VkDeviceSize* p_size)
+{
+    const jvm_readback_slot_info* const info = find_slot(readback, slot);
+    if (!info || !info->ready || info->released)
+    {
+        return NULL;
+    }
+    if (p_size)
+    {
+        *p_size = info->size;
+    }
+    return readback->ring.ptr + info->offset;
+}
+
+void jvm_readback_release(jvm_readback* readback, jvm_readback_slot slot)
+{
+    jvm_readback_slot_info* const info = find_slot(readback, slot);
+    if (!info)
+    {
+        return;
+    }
+    info->released = 1;
+    unsigned released = 0;
+    while (released < readback->slot_count && readback->slots[released].released)
+    {
+        released += 1;
+    }
+    if (!released)
+    {
+        return;
+    }
+    jvm_ring_retire(&readback->ring, readback->slots[released - 1].slot);
+    memmove(readback->slots, readback->slots + released, sizeof(*readback->slots) * (readback->slot_count - released));
+    readback->slot_count -= released;
+}
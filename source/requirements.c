@@ -0,0 +1,343 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+//  Cache stops growing at this many entries and is cleared instead, so resources with ever-changing sizes do not make
+//  it grow without bounds
+#define JVM_REQUIREMENTS_CACHE_LIMIT 4096
+
+void jvm_query_buffer_memory_requirements(
+        const jvm_allocator* allocator, VkBuffer buffer, VkMemoryRequirements* p_req, VkBool32* p_prefers_dedicated)
+{
+    if (!allocator->get_buffer_memory_requirements2)
+    {
+        vkGetBufferMemoryRequirements(allocator->device, buffer, p_req);
+        *p_prefers_dedicated = 0;
+        return;
+    }
+    VkMemoryDedicatedRequirements dedicated_req =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+            };
+    VkMemoryRequirements2 mem_req =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+                    .pNext = &dedicated_req,
+            };
+    const VkBufferMemoryRequirementsInfo2 req_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2,
+                    .buffer = buffer,
+            };
+    allocator->get_buffer_memory_requirements2(allocator->device, &req_info, &mem_req);
+    *p_req = mem_req.memoryRequirements;
+    *p_prefers_dedicated = dedicated_req.prefersDedicatedAllocation || dedicated_req.requiresDedicatedAllocation;
+}
+
+void jvm_query_image_memory_requirements(
+        const jvm_allocator* allocator, VkImage image, VkMemoryRequirements* p_req, VkBool32* p_prefers_dedicated)
+{
+    if (!allocator->get_image_memory_requirements2)
+    {
+        vkGetImageMemoryRequirements(allocator->device, image, p_req);
+        *p_prefers_dedicated = 0;
+        return;
+    }
+    VkMemoryDedicatedRequirements dedicated_req =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+            };
+    VkMemoryRequirements2 mem_req =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+                    .pNext = &dedicated_req,
+            };
+    const VkImageMemoryRequirementsInfo2 req_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2,
+                    .image = image,
+            };
+    allocator->get_image_memory_requirements2(allocator->device, &req_info, &mem_req);
+    *p_req = mem_req.memoryRequirements;
+    *p_prefers_dedicated = dedicated_req.prefersDedicatedAllocation || dedicated_req.requiresDedicatedAllocation;
+}
+
+static void make_buffer_key(const VkBufferCreateInfo* create_info, jvm_requirements_key* p_key)
+{
+    memset(p_key, 0, sizeof(*p_key));
+    p_key->is_image = 0;
+    p_key->flags = create_info->flags;
+    p_key->usage = create_info->usage;
+    p_key->sharing_mode = create_info->sharingMode;
+    p_key->size = create_info->size;
+}
+
+static void make_image_key(const VkImageCreateInfo* create_info, jvm_requirements_key* p_key)
+{
+    memset(p_key, 0, sizeof(*p_key));
+    p_key->is_image = 1;
+    p_key->flags = create_info->flags;
+    p_key->usage = create_info->usage;
+    p_key->sharing_mode = create_info->sharingMode;
+    p_key->image_type = create_info->imageType;
+    p_key->format = create_info->format;
+    p_key->extent = create_info->extent;
+    p_key->mip_levels = create_info->mipLevels;
+    p_key->array_layers = create_info->arrayLayers;
+    p_key->samples = create_info->samples;
+    p_key->tiling = create_info->tiling;
+}
+
+//  FNV-1a over the raw bytes of the key. Never returns zero, since that marks empty entries
+static uint64_t hash_key(const jvm_requirements_key* key)
+{
+    const uint8_t* const bytes = (const uint8_t*) key;
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < sizeof(*key); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3;
+    }
+    return hash ? hash : 1;
+}
+
+static const jvm_requirements_entry* cache_find(
+        const jvm_allocator* allocator, const jvm_requirements_key* key, uint64_t hash)
+{
+    if (!allocator->requirements_capacity)
+    {
+        return NULL;
+    }
+    const unsigned mask = allocator->requirements_capacity - 1;
+    for (unsigned i = hash & mask; allocator->requirements[i].hash; i = (i + 1) & mask)
+    {
+        const jvm_requirements_entry* const entry = allocator->requirements + i;
+        if (entry->hash == hash && memcmp(&entry->key, key, sizeof(*key)) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void cache_place(jvm_requirements_entry* entries, unsigned capacity, const jvm_requirements_entry* entry)
+{
+    const unsigned mask = capacity - 1;
+    unsigned i;
+    for (i = entry->hash & mask; entries[i].hash; i = (i + 1) & mask)
+    {
+        //  Linear probing until an empty entry is found
+    }
+    entries[i] = *entry;
+}
+
+static void cache_insert(
+        jvm_allocator* allocator, const jvm_requirements_key* key, uint64_t hash, const VkMemoryRequirements* req,
+        VkBool32 prefers_dedicated)
+{
+    if (cache_find(allocator, key, hash))
+    {
+        return;
+    }
+    if ((allocator->requirements_count + 1) * 4 > allocator->requirements_capacity * 3)
+    {
+        if (allocator->requirements_capacity >= JVM_REQUIREMENTS_CACHE_LIMIT)
+        {
+            //  Full, so start over
+            memset(allocator->requirements, 0, sizeof(*allocator->requirements) * allocator->requirements_capacity);
+            allocator->requirements_count = 0;
+        }
+        else
+        {
+            const unsigned new_capacity = allocator->requirements_capacity ? allocator->requirements_capacity << 1 : 64;
+            jvm_requirements_entry* const new_ptr = jvm_alloc(allocator, sizeof(*new_ptr) * new_capacity);
+            if (!new_ptr)
+            {
+                //  Caching is optional, so this is not an error
+                return;
+            }
+            memset(new_ptr, 0, sizeof(*new_ptr) * new_capacity);
+            for (unsigned i = 0; i < allocator->requirements_capacity; ++i)
+            {
+                if (allocator->requirements[i].hash)
+                {
+                    cache_place(new_ptr, new_capacity, allocator->requirements + i);
+                }
+            }
+            jvm_free(allocator, allocator->requirements);
+            allocator->requirements = new_ptr;
+            allocator->requirements_capacity = new_capacity;
+        }
+    }
+    const jvm_requirements_entry entry =
+            {
+                    .hash = hash,
+                    .key = *key,
+                    .requirements = *req,
+                    .prefers_dedicated = prefers_dedicated,
+            };
+    cache_place(allocator->requirements, allocator->requirements_capacity, &entry);
+    allocator->requirements_count += 1;
+}
+
+void jvm_cache_buffer_memory_requirements(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, const VkMemoryRequirements* req,
+        VkBool32 prefers_dedicated)
+{
+    if (create_info->pNext)
+    {
+        //  Extension structures may change the requirements in ways which the key does not capture
+        return;
+    }
+    jvm_requirements_key key;
+    make_buffer_key(create_info, &key);
+    cache_insert(allocator, &key, hash_key(&key), req, prefers_dedicated);
+}
+
+void jvm_cache_image_memory_requirements(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, const VkMemoryRequirements* req,
+        VkBool32 prefers_dedicated)
+{
+    if (create_info->pNext)
+    {
+        //  Extension structures may change the requirements in ways which the key does not capture
+        return;
+    }
+    jvm_requirements_key key;
+    make_image_key(create_info, &key);
+    cache_insert(allocator, &key, hash_key(&key), req, prefers_dedicated);
+}
+
+VkBool32 jvm_find_buffer_memory_requirements(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, VkMemoryRequirements* p_req,
+        VkBool32* p_prefers_dedicated)
+{
+    if (!create_info->pNext)
+    {
+        jvm_requirements_key key;
+        make_buffer_key(create_info, &key);
+        const jvm_requirements_entry* const entry = cache_find(allocator, &key, hash_key(&key));
+        if (entry)
+        {
+            *p_req = entry->requirements;
+            *p_prefers_dedicated = entry->prefers_dedicated;
+            return 1;
+        }
+    }
+    if (!allocator->get_device_buffer_memory_requirements)
+    {
+        return 0;
+    }
+
+    VkMemoryDedicatedRequirements dedicated_req =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+            };
+    VkMemoryRequirements2 mem_req =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+                    .pNext = allocator->dedicated_allocation ? &dedicated_req : NULL,
+            };
+    const VkDeviceBufferMemoryRequirements req_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS,
+                    .pCreateInfo = create_info,
+            };
+    allocator->get_device_buffer_memory_requirements(allocator->device, &req_info, &mem_req);
+    *p_req = mem_req.memoryRequirements;
+    *p_prefers_dedicated = dedicated_req.prefersDedicatedAllocation || dedicated_req.requiresDedicatedAllocation;
+    jvm_cache_buffer_memory_requirements(allocator, create_info, p_req, *p_prefers_dedicated);
+    return 1;
+}
+
+VkBool32 jvm_find_image_memory_requirements(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, VkMemoryRequirements* p_req,
+        VkBool32* p_prefers_dedicated)
+{
+    if (!create_info->pNext)
+    {
+        jvm_requirements_key key;
+        make_image_key(create_info, &key);
+        const jvm_requirements_entry* const entry = cache_find(allocator, &key, hash_key(&key));
+        if (entry)
+        {
+            *p_req = entry->requirements;
+            *p_prefers_dedicated = entry->prefers_dedicated;
+            return 1;
+        }
+    }
+    if (!allocator->get_device_image_memory_requirements)
+    {
+        return 0;
+    }
+
+    VkMemoryDedicatedRequirements dedicated_req =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+            };
+    VkMemoryRequirements2 mem_req =
+            {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+                    .pNext = allocator->dedicated_allocation ? &dedicated_req : NULL,
+            };
+    const VkDeviceImageMemoryRequirements req_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+                    .pCreateInfo = create_info,
+            };
+    allocator->get_device_image_memory_requirements(allocator->device, &req_info, &mem_req);
+    *p_req = mem_req.memoryRequirements;
+    *p_prefers_dedicated = dedicated_req.prefersDedicatedAllocation || dedicated_req.requiresDedicatedAllocation;
+    jvm_cache_image_memory_requirements(allocator, create_info, p_req, *p_prefers_dedicated);
+    return 1;
+}
+
+VkResult jvm_buffer_memory_requirements(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info, VkMemoryRequirements* p_out)
+{
+    VkBool32 prefers_dedicated;
+    if (jvm_find_buffer_memory_requirements(allocator, create_info, p_out, &prefers_dedicated))
+    {
+        return VK_SUCCESS;
+    }
+
+    //  Requirements can only be obtained from an actual buffer
+    VkBuffer buffer;
+    const VkResult vk_result = vkCreateBuffer(allocator->device, create_info, jvm_vk_callbacks(allocator), &buffer);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create buffer to query its memory requirements");
+        return vk_result;
+    }
+    jvm_query_buffer_memory_requirements(allocator, buffer, p_out, &prefers_dedicated);
+    vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+    jvm_cache_buffer_memory_requirements(allocator, create_info, p_out, prefers_dedicated);
+    return VK_SUCCESS;
+}
+
+VkResult jvm_image_memory_requirements(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info, VkMemoryRequirements* p_out)
+{
+    VkBool32 prefers_dedicated;
+    if (jvm_find_image_memory_requirements(allocator, create_info, p_out, &prefers_dedicated))
+    {
+        return VK_SUCCESS;
+    }
+
+    //  Requirements can only be obtained from an actual image
+    VkImage image;
+    const VkResult vk_result = vkCreateImage(allocator->device, create_info, jvm_vk_callbacks(allocator), &image);
+    if (vk_result != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create image to query its memory requirements");
+        return vk_result;
+    }
+    jvm_query_image_memory_requirements(allocator, image, p_out, &prefers_dedicated);
+    vkDestroyImage(allocator->device, image, jvm_vk_callbacks(allocator));
+    jvm_cache_image_memory_requirements(allocator, create_info, p_out, prefers_dedicated);
+    return VK_SUCCESS;
+}
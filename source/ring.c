@@ -0,0 +1,150 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+VkResult jvm_ring_create(
+        jvm_allocator* allocator, VkDeviceSize size, VkBufferUsageFlags usage, jvm_memory_usage memory_usage,
+        jvm_ring* p_ring)
+{
+    const VkBufferCreateInfo create_info =
+            {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                    .size = size,
+                    .usage = usage,
+                    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            };
+    const jvm_allocation_create_info allocation_info =
+            {
+                    .usage = memory_usage,
+                    .desired_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+            };
+
+    jvm_buffer_allocation* buffer;
+    VkResult res = jvm_buffer_create2(allocator, &create_info, &allocation_info, &buffer);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create ring buffer of size %zu", (size_t) size);
+        return res;
+    }
+    size_t mapped_size;
+    void* ptr;
+    res = jvm_buffer_map(buffer, &mapped_size, &ptr);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not map ring buffer");
+        jvm_buffer_destroy(buffer);
+        return res;
+    }
+
+    memset(p_ring, 0, sizeof(*p_ring));
+    p_ring->buffer = buffer;
+    p_ring->ptr = ptr;
+    p_ring->size = size;
+    p_ring->memory_flags = buffer->allocation->pool->memory_type_info.propertyFlags;
+    return VK_SUCCESS;
+}
+
+void jvm_ring_destroy(jvm_allocator* allocator, jvm_ring* ring, VkBool32 in_use, uint64_t retire_value)
+{
+    jvm_buffer_unmap(ring->buffer);
+    if (!in_use || jvm_buffer_destroy_deferred(ring->buffer, retire_value) != VK_SUCCESS)
+    {
+        jvm_buffer_destroy(ring->buffer);
+    }
+    jvm_free(allocator, ring->segments);
+    memset(ring, 0, sizeof(*ring));
+}
+
+VkResult jvm_ring_acquire(jvm_ring* ring, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* p_offset)
+{
+    if (size > ring->size)
+    {
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+    VkDeviceSize offset = (ring->end + (alignment - 1)) / alignment * alignment;
+    if (!ring->wrapped)
+    {
+        //  Free space is after the end and before the beginning
+        if (offset + size > ring->size)
+        {
+            if (size > ring->begin)
+            {
+                return VK_NOT_READY;
+            }
+            //  Space at the end of the ring is skipped until the data before it retires
+            offset = 0;
+            ring->wrapped = 1;
+            ring->open_wrapped = 1;
+        }
+    }
+    else if (offset + size > ring->begin)
+    {
+        //  Free space is only between the end and the beginning
+        return VK_NOT_READY;
+    }
+    ring->end = offset + size;
+    ring->open = 1;
+    *p_offset = offset;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_ring_close(jvm_allocator* allocator, jvm_ring* ring, uint64_t retire_value)
+{
+    if (!ring->open)
+    {
+        return VK_SUCCESS;
+    }
+    if (ring->segment_count == ring->segment_capacity)
+    {
+        const unsigned new_capacity = ring->segment_capacity ? ring->segment_capacity << 1 : 8;
+        jvm_ring_segment* const new_ptr = jvm_realloc(allocator, ring->segments, sizeof(*ring->segments) * new_capacity);
+        if (!new_ptr)
+        {
+            JVM_ERROR(allocator, "Could not (re-)allocate ring segment queue");
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        ring->segments = new_ptr;
+        ring->segment_capacity = new_capacity;
+    }
+    ring->segments[ring->segment_count] = (jvm_ring_segment)
+            {
+                    .retire_value = retire_value,
+                    .end = ring->end,
+                    .wrapped = ring->open_wrapped,
+            };
+    ring->segment_count += 1;
+    ring->open = 0;
+    ring->open_wrapped = 0;
+    return VK_SUCCESS;
+}
+
+void jvm_ring_retire(jvm_ring* ring, uint64_t completed_value)
+{
+    unsigned retired = 0;
+    while (retired < ring->segment_count && ring->segments[retired].retire_value <= completed_value)
+    {
+        ring->begin = ring->segments[retired].end;
+        if (ring->segments[retired].wrapped)
+        {
+            ring->wrapped = 0;
+        }
+        retired += 1;
+    }
+    if (!retired)
+    {
+        return;
+    }
+    memmove(ring->segments, ring->segments + retired, sizeof(*ring->segments) * (ring->segment_count - retired));
+    ring->segment_count -= retired;
+    if (!ring->segment_count && !ring->open)
+    {
+        //  Nothing is in use, so start again from the beginning of the buffer
+        ring->begin = 0;
+        ring->end = 0;
+        ring->wrapped = 0;
+    }
+}
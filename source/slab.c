@@ -0,0 +1,103 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include "../include/jvm.h"
+#include "internal.h"
+
+static jvm_slot* slot_of(const void* object)
+{
+    return (jvm_slot*) object - 1;
+}
+
+void jvm_object_pool_init(jvm_object_pool* pool, size_t object_size, unsigned slab_slots)
+{
+    //  Objects follow their slot header, so slot size is kept a multiple of its alignment
+    const size_t header_size = sizeof(jvm_slot);
+    pool->slot_size = header_size + (object_size + header_size - 1) / header_size * header_size;
+    pool->slab_slots = slab_slots;
+    pool->slabs = NULL;
+    pool->free_slots = NULL;
+    pool->free_tail = NULL;
+}
+
+void jvm_object_pool_release(jvm_allocator* allocator, jvm_object_pool* pool)
+{
+    jvm_slab* slab = pool->slabs;
+    while (slab)
+    {
+        jvm_slab* const next = slab->next;
+        jvm_free(allocator, slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_slots = NULL;
+    pool->free_tail = NULL;
+}
+
+static void append_free_slot(jvm_object_pool* pool, jvm_slot* slot)
+{
+    slot->next_free = NULL;
+    if (pool->free_tail)
+    {
+        pool->free_tail->next_free = slot;
+    }
+    else
+    {
+        pool->free_slots = slot;
+    }
+    pool->free_tail = slot;
+}
+
+static int add_slab(jvm_allocator* allocator, jvm_object_pool* pool)
+{
+    //  Header of the slab takes up the place of the first slot, which keeps the others aligned
+    jvm_slab* const slab = jvm_alloc(allocator, pool->slot_size * (pool->slab_slots + 1));
+    if (!slab)
+    {
+        return 0;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    unsigned char* const slots = (unsigned char*) slab + pool->slot_size;
+    //  Slots are appended in address order, so that they are also handed out in it
+    for (unsigned i = 0; i < pool->slab_slots; ++i)
+    {
+        jvm_slot* const slot = (jvm_slot*) (slots + pool->slot_size * i);
+        slot->generation = 0;
+        append_free_slot(pool, slot);
+    }
+    return 1;
+}
+
+void* jvm_object_alloc(jvm_allocator* allocator, jvm_object_pool* pool)
+{
+    if (!pool->free_slots && !add_slab(allocator, pool))
+    {
+        JVM_ERROR(allocator, "Could not allocate slab of %u objects", pool->slab_slots);
+        return NULL;
+    }
+    jvm_slot* const slot = pool->free_slots;
+    pool->free_slots = slot->next_free;
+    if (!pool->free_slots)
+    {
+        pool->free_tail = NULL;
+    }
+    slot->next_free = NULL;
+    slot->generation += 1;
+    return slot + 1;
+}
+
+void jvm_object_free(jvm_allocator* allocator, jvm_object_pool* pool, void* object)
+{
+    jvm_slot* const slot = slot_of(object);
+    if (!(slot->generation & 1))
+    {
+        JVM_ERROR(allocator, "Object %p was already freed", object);
+        return;
+    }
+    slot->generation += 1;
+    //  Freed slots go to the back of the list, so that one is reused as late as possible. Freed objects can therefore
+    //  still be reported as freed for a while, but not reliably, so this is a debugging aid rather than a safety net
+    append_free_slot(pool, slot);
+}
@@ -0,0 +1,793 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+#undef jvm_sparse_buffer_create
+#undef jvm_sparse_image_create
+
+static VkResult allocate_page(jvm_sparse_pages* pages, VkDeviceSize size, jvm_chunk** p_out)
+{
+    return jvm_allocate_sparse_page(
+            pages->allocator, size, pages->page_size, pages->memory_type_index, pages->tiling, pages->priority,
+            p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+            ,pages->file, pages->line
+#endif
+            );
+}
+
+//  Sets up pages of a resource, which already has its allocator (and tracking information) set
+static VkResult pages_init(
+        const VkMemoryRequirements* mem_req, const jvm_allocation_create_info* allocation_info,
+        jvm_tiling_class tiling, uint32_t page_count, jvm_sparse_pages* pages)
+{
+    jvm_allocator* const allocator = pages->allocator;
+    pages->page_size = mem_req->alignment;
+    pages->tiling = tiling;
+    pages->page_count = page_count;
+    pages->priority = jvm_allocation_priority(allocator, allocation_info);
+    //  Lazily allocated memory can not be used for sparse binding
+    const VkResult res = jvm_choose_memory_type(
+            allocator, mem_req->memoryTypeBits, allocation_info, 0, &pages->memory_type_index);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "There was no available memory type to support the sparse resource given the nature of"
+                             " the allocation, the desired, and the undesired flags");
+        return res;
+    }
+    if (!page_count)
+    {
+        return VK_SUCCESS;
+    }
+    pages->pages = jvm_alloc(allocator, sizeof(*pages->pages) * page_count);
+    pages->dirty = jvm_alloc(allocator, sizeof(*pages->dirty) * page_count);
+    if (!pages->pages || !pages->dirty)
+    {
+        JVM_ERROR(allocator, "Could not allocate page table of sparse resource with %u pages", page_count);
+        jvm_free(allocator, pages->dirty);
+        jvm_free(allocator, pages->pages);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memset(pages->pages, 0, sizeof(*pages->pages) * page_count);
+    return VK_SUCCESS;
+}
+
+//  Returns memory of all resident pages right away, which is only valid if the device is not using any of them
+static void pages_release(jvm_sparse_pages* pages)
+{
+    for (uint32_t i = 0; i < pages->page_count; ++i)
+    {
+        if (pages->pages[i].chunk)
+        {
+            (void) jvm_deallocate(pages->allocator, pages->pages[i].chunk);
+        }
+    }
+    jvm_free(pages->allocator, pages->dirty);
+    jvm_free(pages->allocator, pages->pages);
+}
+
+static void mark_dirty(jvm_sparse_pages* pages, uint32_t index)
+{
+    jvm_sparse_page* const page = pages->pages + index;
+    if (!page->dirty)
+    {
+        page->dirty = 1;
+        pages->dirty[pages->dirty_count++] = index;
+    }
+}
+
+static VkResult make_page_resident(jvm_sparse_pages* pages, uint32_t index)
+{
+    jvm_sparse_page* const page = pages->pages + index;
+    if (page->chunk)
+    {
+        return VK_SUCCESS;
+    }
+    const VkResult res = allocate_page(pages, pages->page_size, &page->chunk);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    pages->resident_count += 1;
+    mark_dirty(pages, index);
+    return VK_SUCCESS;
+}
+
+//  Memory of the page is returned once the unbind (and any use before it) is done, as signalled by the retire value
+static VkResult evict_page(jvm_sparse_pages* pages, uint32_t index, uint64_t retire_value)
+{
+    jvm_sparse_page* const page = pages->pages + index;
+    if (!page->chunk)
+    {
+        return VK_SUCCESS;
+    }
+    const VkResult res = jvm_defer_destruction(
+            pages->allocator, retire_value, VK_NULL_HANDLE, VK_NULL_HANDLE, page->chunk);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    page->chunk = NULL;
+    pages->resident_count -= 1;
+    mark_dirty(pages, index);
+    return VK_SUCCESS;
+}
+
+static VkDeviceSize page_memory_offset(const jvm_sparse_page* page)
+{
+    return page->chunk ? page->chunk->chunk_offset + page->chunk->padding : 0;
+}
+
+static int compare_page_index(const void* a, const void* b)
+{
+    const uint32_t i1 = *(const uint32_t*) a;
+    const uint32_t i2 = *(const uint32_t*) b;
+    return (i1 > i2) - (i1 < i2);
+}
+
+static void pages_clean(jvm_sparse_pages* pages)
+{
+    for (uint32_t i = 0; i < pages->dirty_count; ++i)
+    {
+        pages->pages[pages->dirty[i]].dirty = 0;
+    }
+    pages->dirty_count = 0;
+}
+
+VkResult jvm_sparse_buffer_create(
+        jvm_allocator* allocator, const VkBufferCreateInfo* create_info,
+        const jvm_allocation_create_info* allocation_info, jvm_sparse_buffer** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    if (!(create_info->flags & VK_BUFFER_CREATE_SPARSE_BINDING_BIT))
+    {
+        JVM_ERROR(allocator, "Sparse buffer must be created with VK_BUFFER_CREATE_SPARSE_BINDING_BIT");
+        return VK_ERROR_UNKNOWN;
+    }
+    jvm_sparse_buffer* const this = jvm_alloc(allocator, sizeof(*this));
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for sparse buffer");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    memset(this, 0, sizeof(*this));
+    this->pages.allocator = allocator;
+#ifdef JVM_TRACK_ALLOCATIONS
+    this->pages.file = file;
+    this->pages.line = line;
+#endif
+
+    VkBuffer buffer;
+    VkResult res = vkCreateBuffer(allocator->device, create_info, jvm_vk_callbacks(allocator), &buffer);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create new buffer: call to vkCreateBuffer failed");
+        jvm_free(allocator, this);
+        return res;
+    }
+    //  Alignment of a sparse resource is its sparse block size, and its size is a multiple of that
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    jvm_query_buffer_memory_requirements(allocator, buffer, &mem_req, &prefers_dedicated);
+    const uint32_t page_count = (uint32_t) ((mem_req.size + mem_req.alignment - 1) / mem_req.alignment);
+    res = pages_init(&mem_req, allocation_info, JVM_TILING_CLASS_LINEAR, page_count, &this->pages);
+    if (res != VK_SUCCESS)
+    {
+        vkDestroyBuffer(allocator->device, buffer, jvm_vk_callbacks(allocator));
+        jvm_free(allocator, this);
+        return res;
+    }
+    this->buffer = buffer;
+    this->buffer_size = create_info->size;
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+void jvm_sparse_buffer_destroy(jvm_sparse_buffer* sparse_buffer)
+{
+    jvm_allocator* const allocator = sparse_buffer->pages.allocator;
+    vkDestroyBuffer(allocator->device, sparse_buffer->buffer, jvm_vk_callbacks(allocator));
+    pages_release(&sparse_buffer->pages);
+    jvm_free(allocator, sparse_buffer);
+}
+
+//  Queues destruction of the resource and all of its resident pages, all or nothing
+static VkResult pages_destroy_deferred(
+        jvm_sparse_pages* pages, uint64_t retire_value, VkBuffer buffer, VkImage image, uint32_t opaque_count,
+        const jvm_sparse_opaque* opaque)
+{
+    jvm_allocator* const allocator = pages->allocator;
+    const VkResult res = jvm_reserve_deferred(allocator, 1 + pages->resident_count + opaque_count);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    (void) jvm_defer_destruction(allocator, retire_value, buffer, image, NULL);
+    for (uint32_t i = 0; i < pages->page_count; ++i)
+    {
+        if (pages->pages[i].chunk)
+        {
+            (void) jvm_defer_destruction(
+                    allocator, retire_value, VK_NULL_HANDLE, VK_NULL_HANDLE, pages->pages[i].chunk);
+        }
+    }
+    for (uint32_t i = 0; i < opaque_count; ++i)
+    {
+        (void) jvm_defer_destruction(allocator, retire_value, VK_NULL_HANDLE, VK_NULL_HANDLE, opaque[i].chunk);
+    }
+    jvm_free(allocator, pages->dirty);
+    jvm_free(allocator, pages->pages);
+    return VK_SUCCESS;
+}
+
+VkResult jvm_sparse_buffer_destroy_deferred(jvm_sparse_buffer* sparse_buffer, uint64_t retire_value)
+{
+    jvm_allocator* const allocator = sparse_buffer->pages.allocator;
+    const VkResult res = pages_destroy_deferred(
+            &sparse_buffer->pages, retire_value, sparse_buffer->buffer, VK_NULL_HANDLE, 0, NULL);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    jvm_free(allocator, sparse_buffer);
+    return VK_SUCCESS;
+}
+
+//  Finds the range of pages [*p_first, *p_last) which cover the range of the buffer
+static VkResult buffer_page_range(
+        const jvm_sparse_buffer* sparse_buffer, VkDeviceSize offset, VkDeviceSize size, uint32_t* p_first,
+        uint32_t* p_last)
+{
+    if (offset + size > sparse_buffer->buffer_size)
+    {
+        JVM_ERROR(sparse_buffer->pages.allocator, "Range [%zu, %zu) is out of bounds of a sparse buffer of size %zu",
+                  (size_t) offset, (size_t) (offset + size), (size_t) sparse_buffer->buffer_size);
+        return VK_ERROR_UNKNOWN;
+    }
+    const VkDeviceSize page_size = sparse_buffer->pages.page_size;
+    *p_first = (uint32_t) (offset / page_size);
+    *p_last = (uint32_t) ((offset + size + page_size - 1) / page_size);
+    return VK_SUCCESS;
+}
+
+VkResult jvm_sparse_buffer_make_resident(jvm_sparse_buffer* sparse_buffer, VkDeviceSize offset, VkDeviceSize size)
+{
+    uint32_t first, last;
+    VkResult res = buffer_page_range(sparse_buffer, offset, size, &first, &last);
+    for (uint32_t i = first; res == VK_SUCCESS && i < last; ++i)
+    {
+        res = make_page_resident(&sparse_buffer->pages, i);
+    }
+    return res;
+}
+
+VkResult jvm_sparse_buffer_evict(
+        jvm_sparse_buffer* sparse_buffer, VkDeviceSize offset, VkDeviceSize size, uint64_t retire_value)
+{
+    uint32_t first, last;
+    VkResult res = buffer_page_range(sparse_buffer, offset, size, &first, &last);
+    for (uint32_t i = first; res == VK_SUCCESS && i < last; ++i)
+    {
+        res = evict_page(&sparse_buffer->pages, i, retire_value);
+    }
+    return res;
+}
+
+VkBuffer jvm_sparse_buffer_get_buffer(jvm_sparse_buffer* sparse_buffer)
+{
+    return sparse_buffer->buffer;
+}
+
+VkDeviceSize jvm_sparse_buffer_get_page_size(jvm_sparse_buffer* sparse_buffer)
+{
+    return sparse_buffer->pages.page_size;
+}
+
+VkDeviceSize jvm_sparse_buffer_get_resident_size(jvm_sparse_buffer* sparse_buffer)
+{
+    return sparse_buffer->pages.resident_count * sparse_buffer->pages.page_size;
+}
+
+static uint32_t mip_dimension(uint32_t dimension, uint32_t mip_level)
+{
+    const uint32_t d = dimension >> mip_level;
+    return d ? d : 1;
+}
+
+static uint32_t tile_count(uint32_t dimension, uint32_t granularity)
+{
+    return (dimension + granularity - 1) / granularity;
+}
+
+//  Adds opaque ranges of a mip tail, which is either shared by all layers or one per layer
+static void add_mip_tail(
+        jvm_sparse_image* this, const VkSparseImageMemoryRequirements* req, uint32_t array_layers,
+        VkSparseMemoryBindFlags flags)
+{
+    const uint32_t tail_count = (req->formatProperties.flags & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT)
+                                ? 1 : array_layers;
+    for (uint32_t i = 0; i < tail_count; ++i)
+    {
+        this->opaque[this->opaque_count++] = (jvm_sparse_opaque)
+                {
+                        .resource_offset = req->imageMipTailOffset + i * req->imageMipTailStride,
+                        .size = req->imageMipTailSize,
+                        .flags = flags,
+                };
+    }
+}
+
+static void image_release(jvm_sparse_image* this)
+{
+    jvm_allocator* const allocator = this->pages.allocator;
+    for (uint32_t i = 0; i < this->opaque_count; ++i)
+    {
+        if (this->opaque[i].chunk)
+        {
+            (void) jvm_deallocate(allocator, this->opaque[i].chunk);
+        }
+    }
+    jvm_free(allocator, this->opaque);
+    jvm_free(allocator, this->mip_first_page);
+}
+
+//  Lays out tiles and opaque ranges of the image and allocates memory of the opaque ranges
+static VkResult image_init(
+        jvm_sparse_image* this, jvm_allocator* allocator, const VkImageCreateInfo* create_info,
+        const VkMemoryRequirements* mem_req, const jvm_allocation_create_info* allocation_info)
+{
+    uint32_t req_count = 0;
+    vkGetImageSparseMemoryRequirements(allocator->device, this->image, &req_count, NULL);
+    VkSparseImageMemoryRequirements* const reqs = jvm_alloc(allocator, sizeof(*reqs) * (req_count ? req_count : 1));
+    if (!reqs)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for sparse memory requirements");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    vkGetImageSparseMemoryRequirements(allocator->device, this->image, &req_count, reqs);
+
+    //  Only images where one aspect is bound tile by tile are supported, and the metadata aspect, if any, is bound
+    //  opaquely as a whole
+    const VkSparseImageMemoryRequirements* tiles = NULL;
+    const VkSparseImageMemoryRequirements* metadata = NULL;
+    for (uint32_t i = 0; i < req_count; ++i)
+    {
+        if (reqs[i].formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT)
+        {
+            metadata = reqs + i;
+        }
+        else if (!tiles)
+        {
+            tiles = reqs + i;
+        }
+        else
+        {
+            JVM_ERROR(allocator, "Sparse images with more than one aspect bound separately are not supported");
+            jvm_free(allocator, reqs);
+            return VK_ERROR_FORMAT_NOT_SUPPORTED;
+        }
+    }
+    if (!tiles)
+    {
+        JVM_ERROR(allocator, "Sparse image has no aspect which can be bound tile by tile");
+        jvm_free(allocator, reqs);
+        return VK_ERROR_FORMAT_NOT_SUPPORTED;
+    }
+
+    const uint32_t layers = create_info->arrayLayers;
+    this->extent = create_info->extent;
+    this->array_layers = layers;
+    this->aspect = tiles->formatProperties.aspectMask;
+    this->granularity = tiles->formatProperties.imageGranularity;
+    this->tail_first_lod = tiles->imageMipTailFirstLod < create_info->mipLevels
+                           ? tiles->imageMipTailFirstLod : create_info->mipLevels;
+    this->mip_first_page = jvm_alloc(allocator, sizeof(*this->mip_first_page) * (this->tail_first_lod + 1));
+    //  At most one mip tail per layer for each of the two requirements
+    this->opaque = jvm_alloc(allocator, sizeof(*this->opaque) * 2 * layers);
+    if (!this->mip_first_page || !this->opaque)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for sparse image layout");
+        jvm_free(allocator, reqs);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    uint32_t pages_per_layer = 0;
+    for (uint32_t mip = 0; mip < this->tail_first_lod; ++mip)
+    {
+        this->mip_first_page[mip] = pages_per_layer;
+        pages_per_layer += tile_count(mip_dimension(this->extent.width, mip), this->granularity.width) *
+                           tile_count(mip_dimension(this->extent.height, mip), this->granularity.height) *
+                           tile_count(mip_dimension(this->extent.depth, mip), this->granularity.depth);
+    }
+    this->mip_first_page[this->tail_first_lod] = pages_per_layer;
+    this->pages_per_layer = pages_per_layer;
+
+    if (this->tail_first_lod < create_info->mipLevels)
+    {
+        add_mip_tail(this, tiles, layers, 0);
+    }
+    if (metadata)
+    {
+        add_mip_tail(this, metadata, layers, VK_SPARSE_MEMORY_BIND_METADATA_BIT);
+    }
+    jvm_free(allocator, reqs);
+
+    VkResult res = pages_init(
+            mem_req, allocation_info,
+            create_info->tiling == VK_IMAGE_TILING_LINEAR ? JVM_TILING_CLASS_LINEAR : JVM_TILING_CLASS_OPTIMAL,
+            pages_per_layer * layers, &this->pages);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    //  Mip tails and metadata stay resident for the whole lifetime of the image
+    for (uint32_t i = 0; i < this->opaque_count; ++i)
+    {
+        const VkDeviceSize size = (this->opaque[i].size + this->pages.page_size - 1) & ~(this->pages.page_size - 1);
+        res = allocate_page(&this->pages, size, &this->opaque[i].chunk);
+        if (res != VK_SUCCESS)
+        {
+            JVM_ERROR(allocator, "Could not allocate memory for mip tail of sparse image");
+            pages_release(&this->pages);
+            return res;
+        }
+    }
+    this->opaque_dirty = this->opaque_count != 0;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_sparse_image_create(
+        jvm_allocator* allocator, const VkImageCreateInfo* create_info,
+        const jvm_allocation_create_info* allocation_info, jvm_sparse_image** p_out
+#ifdef JVM_TRACK_ALLOCATIONS
+        ,const char* file, int line
+#endif
+)
+{
+    const VkImageCreateFlags sparse_flags = VK_IMAGE_CREATE_SPARSE_BINDING_BIT | VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
+    if ((create_info->flags & sparse_flags) != sparse_flags)
+    {
+        JVM_ERROR(allocator, "Sparse image must be created with VK_IMAGE_CREATE_SPARSE_BINDING_BIT and"
+                             " VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT");
+        return VK_ERROR_UNKNOWN;
+    }
+    jvm_sparse_image* const this = jvm_alloc(allocator, sizeof(*this));
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for sparse image");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memset(this, 0, sizeof(*this));
+    //  Mip tails are allocated while the image is laid out, so tracking information has to be there before
+    this->pages.allocator = allocator;
+#ifdef JVM_TRACK_ALLOCATIONS
+    this->pages.file = file;
+    this->pages.line = line;
+#endif
+
+    VkResult res = vkCreateImage(allocator->device, create_info, jvm_vk_callbacks(allocator), &this->image);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not create new image");
+        jvm_free(allocator, this);
+        return res;
+    }
+    VkMemoryRequirements mem_req;
+    VkBool32 prefers_dedicated;
+    jvm_query_image_memory_requirements(allocator, this->image, &mem_req, &prefers_dedicated);
+    res = image_init(this, allocator, create_info, &mem_req, allocation_info);
+    if (res != VK_SUCCESS)
+    {
+        image_release(this);
+        vkDestroyImage(allocator->device, this->image, jvm_vk_callbacks(allocator));
+        jvm_free(allocator, this);
+        return res;
+    }
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+void jvm_sparse_image_destroy(jvm_sparse_image* sparse_image)
+{
+    jvm_allocator* const allocator = sparse_image->pages.allocator;
+    vkDestroyImage(allocator->device, sparse_image->image, jvm_vk_callbacks(allocator));
+    pages_release(&sparse_image->pages);
+    image_release(sparse_image);
+    jvm_free(allocator, sparse_image);
+}
+
+VkResult jvm_sparse_image_destroy_deferred(jvm_sparse_image* sparse_image, uint64_t retire_value)
+{
+    jvm_allocator* const allocator = sparse_image->pages.allocator;
+    const VkResult res = pages_destroy_deferred(
+            &sparse_image->pages, retire_value, VK_NULL_HANDLE, sparse_image->image, sparse_image->opaque_count,
+            sparse_image->opaque);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    jvm_free(allocator, sparse_image->opaque);
+    jvm_free(allocator, sparse_image->mip_first_page);
+    jvm_free(allocator, sparse_image);
+    return VK_SUCCESS;
+}
+
+//  Calls the function for each tile which the region touches. Regions in the mip tail have no tiles
+static VkResult for_each_tile(
+        jvm_sparse_image* sparse_image, VkImageSubresource subresource, VkOffset3D offset, VkExtent3D extent,
+        VkResult (*function)(jvm_sparse_pages* pages, uint32_t index, uint64_t retire_value), uint64_t retire_value)
+{
+    const uint32_t mip = subresource.mipLevel;
+    if (subresource.arrayLayer >= sparse_image->array_layers || offset.x < 0 || offset.y < 0 || offset.z < 0 ||
+        (uint32_t) offset.x + extent.width > mip_dimension(sparse_image->extent.width, mip) ||
+        (uint32_t) offset.y + extent.height > mip_dimension(sparse_image->extent.height, mip) ||
+        (uint32_t) offset.z + extent.depth > mip_dimension(sparse_image->extent.depth, mip))
+    {
+        JVM_ERROR(sparse_image->pages.allocator, "Region is out of bounds of the sparse image");
+        return VK_ERROR_UNKNOWN;
+    }
+    if (mip >= sparse_image->tail_first_lod || !extent.width || !extent.height || !extent.depth)
+    {
+        return VK_SUCCESS;
+    }
+    const VkExtent3D g = sparse_image->granularity;
+    const uint32_t tiles_x = tile_count(mip_dimension(sparse_image->extent.width, mip), g.width);
+    const uint32_t tiles_y = tile_count(mip_dimension(sparse_image->extent.height, mip), g.height);
+    const uint32_t first_page = subresource.arrayLayer * sparse_image->pages_per_layer +
+                                sparse_image->mip_first_page[mip];
+    for (uint32_t z = offset.z / g.depth; z <= (offset.z + extent.depth - 1) / g.depth; ++z)
+    {
+        for (uint32_t y = offset.y / g.height; y <= (offset.y + extent.height - 1) / g.height; ++y)
+        {
+            for (uint32_t x = offset.x / g.width; x <= (offset.x + extent.width - 1) / g.width; ++x)
+            {
+                const VkResult res = function(&sparse_image->pages, first_page + (z * tiles_y + y) * tiles_x + x,
+                                              retire_value);
+                if (res != VK_SUCCESS)
+                {
+                    return res;
+                }
+            }
+        }
+    }
+    return VK_SUCCESS;
+}
+
+static VkResult make_tile_resident(jvm_sparse_pages* pages, uint32_t index, uint64_t retire_value)
+{
+    (void) retire_value;
+    return make_page_resident(pages, index);
+}
+
+VkResult jvm_sparse_image_make_resident(
+        jvm_sparse_image* sparse_image, VkImageSubresource subresource, VkOffset3D offset, VkExtent3D extent)
+{
+    return for_each_tile(sparse_image, subresource, offset, extent, make_tile_resident, 0);
+}
+
+VkResult jvm_sparse_image_evict(
+        jvm_sparse_image* sparse_image, VkImageSubresource subresource, VkOffset3D offset, VkExtent3D extent,
+        uint64_t retire_value)
+{
+    return for_each_tile(sparse_image, subresource, offset, extent, evict_page, retire_value);
+}
+
+VkImage jvm_sparse_image_get_image(jvm_sparse_image* sparse_image)
+{
+    return sparse_image->image;
+}
+
+VkExtent3D jvm_sparse_image_get_granularity(jvm_sparse_image* sparse_image)
+{
+    return sparse_image->granularity;
+}
+
+VkDeviceSize jvm_sparse_image_get_resident_size(jvm_sparse_image* sparse_image)
+{
+    return sparse_image->pages.resident_count * sparse_image->pages.page_size;
+}
+
+//  Fills in binds of dirty pages of a buffer, merging runs of neighbouring pages which are contiguous in memory or all
+//  unbound. Returns the number of binds
+static uint32_t fill_buffer_binds(jvm_sparse_buffer* sparse_buffer, VkSparseMemoryBind* binds)
+{
+    jvm_sparse_pages* const pages = &sparse_buffer->pages;
+    qsort(pages->dirty, pages->dirty_count, sizeof(*pages->dirty), compare_page_index);
+    uint32_t bind_count = 0;
+    for (uint32_t i = 0; i < pages->dirty_count; ++i)
+    {
+        const uint32_t index = pages->dirty[i];
+        const jvm_sparse_page* const page = pages->pages + index;
+        const VkDeviceMemory memory = page->chunk ? page->chunk->memory : VK_NULL_HANDLE;
+        const VkDeviceSize resource_offset = (VkDeviceSize) index * pages->page_size;
+        VkSparseMemoryBind* const last = bind_count ? binds + (bind_count - 1) : NULL;
+        if (last && last->resourceOffset + last->size == resource_offset && last->memory == memory &&
+            (memory == VK_NULL_HANDLE || last->memoryOffset + last->size == page_memory_offset(page)))
+        {
+            last->size += pages->page_size;
+            continue;
+        }
+        binds[bind_count++] = (VkSparseMemoryBind)
+                {
+                        .resourceOffset = resource_offset,
+                        .size = pages->page_size,
+                        .memory = memory,
+                        .memoryOffset = page_memory_offset(page),
+                };
+    }
+    return bind_count;
+}
+
+//  Fills in binds of dirty tiles of an image, clamping tiles on the edges to the size of their mip level
+static uint32_t fill_image_binds(const jvm_sparse_image* sparse_image, VkSparseImageMemoryBind* binds)
+{
+    const jvm_sparse_pages* const pages = &sparse_image->pages;
+    const VkExtent3D g = sparse_image->granularity;
+    for (uint32_t i = 0; i < pages->dirty_count; ++i)
+    {
+        const uint32_t index = pages->dirty[i];
+        const uint32_t layer = index / sparse_image->pages_per_layer;
+        uint32_t tile = index % sparse_image->pages_per_layer;
+        uint32_t mip = 0;
+        while (sparse_image->mip_first_page[mip + 1] <= tile)
+        {
+            mip += 1;
+        }
+        tile -= sparse_image->mip_first_page[mip];
+        const uint32_t width = mip_dimension(sparse_image->extent.width, mip);
+        const uint32_t height = mip_dimension(sparse_image->extent.height, mip);
+        const uint32_t depth = mip_dimension(sparse_image->extent.depth, mip);
+        const uint32_t tiles_x = tile_count(width, g.width);
+        const uint32_t tiles_y = tile_count(height, g.height);
+        const uint32_t x = (tile % tiles_x) * g.width;
+        const uint32_t y = (tile / tiles_x % tiles_y) * g.height;
+        const uint32_t z = (tile / tiles_x / tiles_y) * g.depth;
+        const jvm_sparse_page* const page = pages->pages + index;
+        binds[i] = (VkSparseImageMemoryBind)
+                {
+                        .subresource = {.aspectMask = sparse_image->aspect, .mipLevel = mip, .arrayLayer = layer},
+                        .offset = {.x = (int32_t) x, .y = (int32_t) y, .z = (int32_t) z},
+                        .extent =
+                                {
+                                        .width = width - x < g.width ? width - x : g.width,
+                                        .height = height - y < g.height ? height - y : g.height,
+                                        .depth = depth - z < g.depth ? depth - z : g.depth,
+                                },
+                        .memory = page->chunk ? page->chunk->memory : VK_NULL_HANDLE,
+                        .memoryOffset = page_memory_offset(page),
+                };
+    }
+    return pages->dirty_count;
+}
+
+//  Builds a single batch out of binds of all dirty pages and submits it. Scratch arrays have room for all binds
+static VkResult submit_binds(
+        jvm_allocator* allocator, VkQueue queue, const VkBindSparseInfo* batch_info, uint32_t buffer_count,
+        jvm_sparse_buffer* const* sparse_buffers, uint32_t image_count, jvm_sparse_image* const* sparse_images,
+        VkFence fence, VkSparseBufferMemoryBindInfo* buffer_infos, VkSparseImageOpaqueMemoryBindInfo* opaque_infos,
+        VkSparseImageMemoryBindInfo* image_infos, VkSparseMemoryBind* memory_binds, VkSparseImageMemoryBind* image_binds)
+{
+    VkBindSparseInfo info = batch_info ? *batch_info : (VkBindSparseInfo) {.sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO};
+    info.bufferBindCount = 0;
+    info.imageOpaqueBindCount = 0;
+    info.imageBindCount = 0;
+    VkSparseMemoryBind* next_memory_bind = memory_binds;
+    VkSparseImageMemoryBind* next_image_bind = image_binds;
+    for (uint32_t i = 0; i < buffer_count; ++i)
+    {
+        jvm_sparse_buffer* const sparse_buffer = sparse_buffers[i];
+        if (!sparse_buffer->pages.dirty_count)
+        {
+            continue;
+        }
+        const uint32_t count = fill_buffer_binds(sparse_buffer, next_memory_bind);
+        buffer_infos[info.bufferBindCount++] = (VkSparseBufferMemoryBindInfo)
+                {.buffer = sparse_buffer->buffer, .bindCount = count, .pBinds = next_memory_bind};
+        next_memory_bind += count;
+    }
+    for (uint32_t i = 0; i < image_count; ++i)
+    {
+        const jvm_sparse_image* const sparse_image = sparse_images[i];
+        if (sparse_image->opaque_dirty)
+        {
+            for (uint32_t j = 0; j < sparse_image->opaque_count; ++j)
+            {
+                const jvm_sparse_opaque* const opaque = sparse_image->opaque + j;
+                next_memory_bind[j] = (VkSparseMemoryBind)
+                        {
+                                .resourceOffset = opaque->resource_offset,
+                                .size = opaque->size,
+                                .memory = opaque->chunk->memory,
+                                .memoryOffset = opaque->chunk->chunk_offset + opaque->chunk->padding,
+                                .flags = opaque->flags,
+                        };
+            }
+            opaque_infos[info.imageOpaqueBindCount++] = (VkSparseImageOpaqueMemoryBindInfo)
+                    {.image = sparse_image->image, .bindCount = sparse_image->opaque_count, .pBinds = next_memory_bind};
+            next_memory_bind += sparse_image->opaque_count;
+        }
+        if (sparse_image->pages.dirty_count)
+        {
+            const uint32_t count = fill_image_binds(sparse_image, next_image_bind);
+            image_infos[info.imageBindCount++] = (VkSparseImageMemoryBindInfo)
+                    {.image = sparse_image->image, .bindCount = count, .pBinds = next_image_bind};
+            next_image_bind += count;
+        }
+    }
+    info.pBufferBinds = buffer_infos;
+    info.pImageOpaqueBinds = opaque_infos;
+    info.pImageBinds = image_infos;
+
+    const VkResult res = vkQueueBindSparse(queue, 1, &info, fence);
+    if (res != VK_SUCCESS)
+    {
+        //  Everything stays dirty, so that it can be submitted again
+        JVM_ERROR(allocator, "Could not bind sparse memory");
+        return res;
+    }
+    for (uint32_t i = 0; i < buffer_count; ++i)
+    {
+        pages_clean(&sparse_buffers[i]->pages);
+    }
+    for (uint32_t i = 0; i < image_count; ++i)
+    {
+        pages_clean(&sparse_images[i]->pages);
+        sparse_images[i]->opaque_dirty = 0;
+    }
+    return VK_SUCCESS;
+}
+
+VkResult jvm_sparse_submit(
+        jvm_allocator* allocator, VkQueue queue, const VkBindSparseInfo* batch_info, uint32_t buffer_count,
+        jvm_sparse_buffer* const* sparse_buffers, uint32_t image_count, jvm_sparse_image* const* sparse_images,
+        VkFence fence)
+{
+    uint32_t memory_bind_count = 0;
+    uint32_t image_bind_count = 0;
+    for (uint32_t i = 0; i < buffer_count; ++i)
+    {
+        memory_bind_count += sparse_buffers[i]->pages.dirty_count;
+    }
+    for (uint32_t i = 0; i < image_count; ++i)
+    {
+        memory_bind_count += sparse_images[i]->opaque_dirty ? sparse_images[i]->opaque_count : 0;
+        image_bind_count += sparse_images[i]->pages.dirty_count;
+    }
+
+    //  Each array gets one extra element, so that none of the allocations is empty
+    VkSparseBufferMemoryBindInfo* const buffer_infos = jvm_alloc(allocator, sizeof(*buffer_infos) * (buffer_count + 1));
+    VkSparseImageOpaqueMemoryBindInfo* const opaque_infos = jvm_alloc(
+            allocator, sizeof(*opaque_infos) * (image_count + 1));
+    VkSparseImageMemoryBindInfo* const image_infos = jvm_alloc(allocator, sizeof(*image_infos) * (image_count + 1));
+    VkSparseMemoryBind* const memory_binds = jvm_alloc(allocator, sizeof(*memory_binds) * (memory_bind_count + 1));
+    VkSparseImageMemoryBind* const image_binds = jvm_alloc(allocator, sizeof(*image_binds) * (image_bind_count + 1));
+    VkResult res;
+    if (!buffer_infos || !opaque_infos || !image_infos || !memory_binds || !image_binds)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for sparse binds");
+        res = VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    else
+    {
+        res = submit_binds(
+                allocator, queue, batch_info, buffer_count, sparse_buffers, image_count, sparse_images, fence,
+                buffer_infos, opaque_infos, image_infos, memory_binds, image_binds);
+    }
+    jvm_free(allocator, image_binds);
+    jvm_free(allocator, memory_binds);
+    jvm_free(allocator, image_infos);
+    jvm_free(allocator, opaque_infos);
+    jvm_free(allocator, buffer_infos);
+    return res;
+}
@@ -0,0 +1,265 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+#include "../include/jvm.h"
+#include "internal.h"
+
+#ifndef _WIN32
+
+//  Defaults used when jvm_stream_info leaves them at zero
+#define JVM_STREAM_DEFAULT_CHUNK_SIZE ((VkDeviceSize) 4 << 20)
+#define JVM_STREAM_DEFAULT_THREAD_COUNT 4
+
+struct jvm_stream_T
+{
+    jvm_allocator* allocator;   //  allocator of the destination buffer
+    jvm_chunk* chunk;           //  memory of the destination buffer, mapped for as long as the stream exists
+    uint8_t* dst;               //  where the first byte of the range goes
+    VkDeviceSize dst_offset;    //  offset of dst within the buffer's VkDeviceMemory
+    VkBool32 flush;             //  non-zero if the memory is not host coherent
+    int fd;                     //  file being read
+    uint64_t file_offset;       //  offset in the file of the first byte of the range
+    VkDeviceSize size;          //  size of the range
+    VkDeviceSize chunk_size;    //  size of all chunks except the last one
+    uint64_t chunk_count;       //  number of chunks the range is split into
+    jvm_stream_callback callback;   //  called by the last worker to finish, may be NULL
+    void* user_data;            //  passed to the callback
+
+    pthread_mutex_t mutex;      //  protects everything below
+    uint64_t next_chunk;        //  index of the next chunk no worker took yet
+    uint32_t running;           //  number of workers which did not finish yet
+    int read_error;             //  errno of the first failed read, -1 if the file ended early, zero otherwise
+    VkResult result;            //  first error, or VK_SUCCESS
+
+    uint32_t thread_count;      //  number of worker threads
+    pthread_t threads[];        //  worker threads
+};
+
+//  Reads the chunk into the buffer and flushes it. Returns zero on success, errno or -1 if the file ended on failure
+static int stream_chunk(jvm_stream* stream, uint64_t idx, VkResult* p_result)
+{
+    const VkDeviceSize begin = idx * stream->chunk_size;
+    const VkDeviceSize end = begin + stream->chunk_size < stream->size ? begin + stream->chunk_size : stream->size;
+    for (VkDeviceSize pos = begin; pos < end;)
+    {
+        //  Reads may return less than asked for, such as on signals or for very large sizes
+        const ssize_t n = pread(
+                stream->fd, stream->dst + pos, (size_t) (end - pos), (off_t) (stream->file_offset + pos));
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+        if (n == 0)
+        {
+            return -1;
+        }
+        pos += (VkDeviceSize) n;
+    }
+    if (stream->flush)
+    {
+        //  Range has to be a multiple of nonCoherentAtomSize, unless it goes to the end of the memory
+        jvm_allocator* const allocator = stream->allocator;
+        const VkDeviceSize atom = allocator->non_coherent_atom_size;
+        const VkDeviceSize memory_size = stream->chunk->pool->size;
+        const VkDeviceSize offset = (stream->dst_offset + begin) & ~(atom - 1);
+        VkDeviceSize range_end = (stream->dst_offset + end + atom - 1) & ~(atom - 1);
+        if (range_end > memory_size)
+        {
+            range_end = memory_size;
+        }
+        const VkMappedMemoryRange range =
+                {
+                        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                        .memory = stream->chunk->memory,
+                        .offset = offset,
+                        .size = range_end - offset,
+                };
+        *p_result = vkFlushMappedMemoryRanges(allocator->device, 1, &range);
+    }
+    return 0;
+}
+
+static void* stream_worker(void* param)
+{
+    jvm_stream* const stream = param;
+    pthread_mutex_lock(&stream->mutex);
+    while (stream->result == VK_SUCCESS && stream->next_chunk < stream->chunk_count)
+    {
+        const uint64_t idx = stream->next_chunk++;
+        pthread_mutex_unlock(&stream->mutex);
+        VkResult result = VK_SUCCESS;
+        const int read_error = stream_chunk(stream, idx, &result);
+        pthread_mutex_lock(&stream->mutex);
+        if (read_error && stream->result == VK_SUCCESS)
+        {
+            stream->read_error = read_error;
+            stream->result = VK_ERROR_UNKNOWN;
+        }
+        else if (result != VK_SUCCESS && stream->result == VK_SUCCESS)
+        {
+            stream->result = result;
+        }
+    }
+    stream->running -= 1;
+    const int last = stream->running == 0;
+    const VkResult result = stream->result;
+    pthread_mutex_unlock(&stream->mutex);
+    if (last && stream->callback)
+    {
+        stream->callback(stream->user_data, result);
+    }
+    return NULL;
+}
+
+VkResult jvm_stream_file_into(
+        jvm_buffer_allocation* buffer_allocation, const jvm_stream_info* stream_info, jvm_stream** p_out)
+{
+    jvm_allocator* const allocator = buffer_allocation->allocator;
+    jvm_chunk* const chunk = buffer_allocation->allocation;
+    if (!(chunk->pool->memory_type_info.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+    {
+        JVM_ERROR(allocator, "Files can only be streamed into host visible memory");
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+    if (stream_info->buffer_offset > buffer_allocation->buffer_size ||
+        stream_info->size > buffer_allocation->buffer_size - stream_info->buffer_offset)
+    {
+        JVM_ERROR(allocator, "Range of %zu bytes at offset %zu does not fit into the buffer of size %zu",
+                  (size_t) stream_info->size, (size_t) stream_info->buffer_offset,
+                  (size_t) buffer_allocation->buffer_size);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    const VkDeviceSize chunk_size = stream_info->chunk_size ? stream_info->chunk_size : JVM_STREAM_DEFAULT_CHUNK_SIZE;
+    const uint64_t chunk_count = (stream_info->size + chunk_size - 1) / chunk_size;
+    uint32_t thread_count = stream_info->thread_count ? stream_info->thread_count : JVM_STREAM_DEFAULT_THREAD_COUNT;
+    if (thread_count > chunk_count)
+    {
+        thread_count = chunk_count ? (uint32_t) chunk_count : 1;
+    }
+
+    jvm_stream* const this = jvm_alloc(allocator, sizeof(*this) + sizeof(*this->threads) * thread_count);
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for stream");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    this->fd = open(stream_info->path, O_RDONLY);
+    if (this->fd < 0)
+    {
+        JVM_ERROR(allocator, "Could not open file \"%s\" to stream: %s", stream_info->path, strerror(errno));
+        jvm_free(allocator, this);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    size_t mapped_size;
+    void* mapped;
+    VkResult res = jvm_chunk_map(allocator, chunk, &mapped_size, &mapped);
+    if (res != VK_SUCCESS)
+    {
+        JVM_ERROR(allocator, "Could not map buffer to stream into");
+        close(this->fd);
+        jvm_free(allocator, this);
+        return res;
+    }
+    this->allocator = allocator;
+    this->chunk = chunk;
+    this->dst = (uint8_t*) mapped + stream_info->buffer_offset;
+    this->dst_offset = chunk->chunk_offset + chunk->padding + stream_info->buffer_offset;
+    this->flush = !(chunk->pool->memory_type_info.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    this->file_offset = stream_info->file_offset;
+    this->size = stream_info->size;
+    this->chunk_size = chunk_size;
+    this->chunk_count = chunk_count;
+    this->callback = stream_info->callback;
+    this->user_data = stream_info->user_data;
+    pthread_mutex_init(&this->mutex, NULL);
+    this->next_chunk = 0;
+    this->running = thread_count;
+    this->read_error = 0;
+    this->result = VK_SUCCESS;
+    this->thread_count = 0;
+
+    //  Workers are already running while the rest are started, so the count of running ones is protected too
+    pthread_mutex_lock(&this->mutex);
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        if (pthread_create(this->threads + i, NULL, stream_worker, this) != 0)
+        {
+            break;
+        }
+        this->thread_count += 1;
+    }
+    if (this->thread_count == 0)
+    {
+        pthread_mutex_unlock(&this->mutex);
+        JVM_ERROR(allocator, "Could not start any stream worker threads");
+        pthread_mutex_destroy(&this->mutex);
+        (void) jvm_chunk_unmap(allocator, chunk);
+        close(this->fd);
+        jvm_free(allocator, this);
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+    //  Those which could not be started will not finish either
+    this->running = this->thread_count;
+    pthread_mutex_unlock(&this->mutex);
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_stream_wait(jvm_stream* stream)
+{
+    jvm_allocator* const allocator = stream->allocator;
+    for (uint32_t i = 0; i < stream->thread_count; ++i)
+    {
+        pthread_join(stream->threads[i], NULL);
+    }
+    VkResult res = stream->result;
+    if (stream->read_error > 0)
+    {
+        JVM_ERROR(allocator, "Could not read file to stream: %s", strerror(stream->read_error));
+    }
+    else if (stream->read_error < 0)
+    {
+        JVM_ERROR(allocator, "File to stream ended before the whole range was read");
+    }
+    const VkResult unmap_res = jvm_chunk_unmap(allocator, stream->chunk);
+    if (res == VK_SUCCESS)
+    {
+        res = unmap_res;
+    }
+    pthread_mutex_destroy(&stream->mutex);
+    close(stream->fd);
+    jvm_free(allocator, stream);
+    return res;
+}
+
+#else
+
+VkResult jvm_stream_file_into(
+        jvm_buffer_allocation* buffer_allocation, const jvm_stream_info* stream_info, jvm_stream** p_out)
+{
+    (void) stream_info;
+    (void) p_out;
+    JVM_ERROR(buffer_allocation->allocator, "Streaming files is not supported on this platform");
+    return VK_ERROR_FEATURE_NOT_PRESENT;
+}
+
+VkResult jvm_stream_wait(jvm_stream* stream)
+{
+    (void) stream;
+    return VK_ERROR_FEATURE_NOT_PRESENT;
+}
+
+#endif
@@ -0,0 +1,286 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+static VkResult reserve_copy(jvm_uploader* uploader)
+{
+    if (uploader->copy_count < uploader->copy_capacity)
+    {
+        return VK_SUCCESS;
+    }
+    jvm_allocator* const allocator = uploader->allocator;
+    const unsigned new_capacity = uploader->copy_capacity ? uploader->copy_capacity << 1 : 32;
+    jvm_upload_copy* const new_copies = jvm_realloc(
+            allocator, uploader->copies, sizeof(*uploader->copies) * new_capacity);
+    if (!new_copies)
+    {
+        JVM_ERROR(allocator, "Could not (re-)allocate upload copy array");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    uploader->copies = new_copies;
+    VkBufferCopy* const new_buffer_regions = jvm_realloc(
+            allocator, uploader->buffer_regions, sizeof(*uploader->buffer_regions) * new_capacity);
+    if (!new_buffer_regions)
+    {
+        JVM_ERROR(allocator, "Could not (re-)allocate upload region array");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    uploader->buffer_regions = new_buffer_regions;
+    VkBufferImageCopy* const new_image_regions = jvm_realloc(
+            allocator, uploader->image_regions, sizeof(*uploader->image_regions) * new_capacity);
+    if (!new_image_regions)
+    {
+        JVM_ERROR(allocator, "Could not (re-)allocate upload region array");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    uploader->image_regions = new_image_regions;
+    uploader->copy_capacity = new_capacity;
+    return VK_SUCCESS;
+}
+
+//  Copies data into the staging ring and returns where it was put
+static VkResult stage_data(
+        jvm_uploader* uploader, const void* data, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* p_offset)
+{
+    VkResult res = reserve_copy(uploader);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    res = jvm_ring_acquire(&uploader->ring, size, alignment, p_offset);
+    if (res == VK_ERROR_OUT_OF_DEVICE_MEMORY)
+    {
+        JVM_ERROR(uploader->allocator, "Upload of %zu bytes is larger than the staging ring (%zu bytes)", (size_t) size,
+                  (size_t) uploader->ring.size);
+    }
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    jvm_mapped_copy(uploader->allocator, uploader->ring.memory_flags, uploader->ring.ptr + *p_offset, data, size);
+    return VK_SUCCESS;
+}
+
+static int buffer_regions_overlap(const VkBufferCopy* r1, const VkBufferCopy* r2)
+{
+    return r1->dstOffset < r2->dstOffset + r2->size && r2->dstOffset < r1->dstOffset + r1->size;
+}
+
+static int image_regions_overlap(const VkBufferImageCopy* r1, const VkBufferImageCopy* r2)
+{
+    const VkImageSubresourceLayers* const s1 = &r1->imageSubresource;
+    const VkImageSubresourceLayers* const s2 = &r2->imageSubresource;
+    if (s1->mipLevel != s2->mipLevel || !(s1->aspectMask & s2->aspectMask) ||
+        s1->baseArrayLayer >= s2->baseArrayLayer + s2->layerCount ||
+        s2->baseArrayLayer >= s1->baseArrayLayer + s1->layerCount)
+    {
+        return 0;
+    }
+    return r1->imageOffset.x < r2->imageOffset.x + (int32_t) r2->imageExtent.width &&
+           r2->imageOffset.x < r1->imageOffset.x + (int32_t) r1->imageExtent.width &&
+           r1->imageOffset.y < r2->imageOffset.y + (int32_t) r2->imageExtent.height &&
+           r2->imageOffset.y < r1->imageOffset.y + (int32_t) r1->imageExtent.height &&
+           r1->imageOffset.z < r2->imageOffset.z + (int32_t) r2->imageExtent.depth &&
+           r2->imageOffset.z < r1->imageOffset.z + (int32_t) r1->imageExtent.depth;
+}
+
+VkResult jvm_uploader_create(jvm_allocator* allocator, VkDeviceSize ring_size, jvm_uploader** p_out)
+{
+    jvm_uploader* const this = jvm_alloc(allocator, sizeof(*this));
+    if (!this)
+    {
+        JVM_ERROR(allocator, "Could not allocate memory for uploader");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memset(this, 0, sizeof(*this));
+    this->allocator = allocator;
+
+    const VkResult res = jvm_ring_create(
+            allocator, ring_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, JVM_MEMORY_USAGE_CPU_ONLY, &this->ring);
+    if (res != VK_SUCCESS)
+    {
+        jvm_free(allocator, this);
+        return res;
+    }
+
+    //  Copies to images also need the offset to be a multiple of the texel block size, which is added for each of them
+    this->buffer_alignment = allocator->optimal_buffer_copy_offset_alignment;
+    if (this->buffer_alignment < 4)
+    {
+        this->buffer_alignment = 4;
+    }
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+void jvm_uploader_destroy(jvm_uploader* uploader)
+{
+    jvm_allocator* const allocator = uploader->allocator;
+    const jvm_ring* const ring = &uploader->ring;
+    jvm_ring_destroy(
+            allocator, &uploader->ring, ring->segment_count != 0,
+            ring->segment_count ? ring->segments[ring->segment_count - 1].retire_value : 0);
+    jvm_free(allocator, uploader->image_regions);
+    jvm_free(allocator, uploader->buffer_regions);
+    jvm_free(allocator, uploader->copies);
+    jvm_free(allocator, uploader);
+}
+
+VkResult jvm_uploader_upload_buffer(
+        jvm_uploader* uploader, jvm_buffer_allocation* buffer_allocation, VkDeviceSize offset, const void* data,
+        VkDeviceSize size)
+{
+    if (offset + size > buffer_allocation->buffer_size)
+    {
+        JVM_ERROR(uploader->allocator, "Upload to [%zu, %zu) is out of bounds of a buffer of size %zu", (size_t) offset,
+                  (size_t) (offset + size), (size_t) buffer_allocation->buffer_size);
+        return VK_ERROR_UNKNOWN;
+    }
+    if (buffer_allocation->allocation->pool->memory_type_info.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        //  Memory can be written directly (integrated devices or resizable BAR), so there is no need for staging
+        return jvm_chunk_write(uploader->allocator, buffer_allocation->allocation, offset, data, size);
+    }
+
+    VkDeviceSize staged_offset;
+    const VkResult res = stage_data(uploader, data, size, uploader->buffer_alignment, &staged_offset);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    uploader->copies[uploader->copy_count] = (jvm_upload_copy)
+            {
+                    .buffer = buffer_allocation->buffer,
+                    .buffer_region = {.srcOffset = staged_offset, .dstOffset = offset, .size = size},
+            };
+    uploader->copy_count += 1;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_uploader_upload_image(
+        jvm_uploader* uploader, jvm_image_allocation* image_allocation, VkImageLayout layout,
+        VkImageSubresourceLayers subresource, VkOffset3D offset, VkExtent3D extent, const void* data, VkDeviceSize size)
+{
+    const VkDeviceSize alignment = jvm_image_copy_alignment(
+            uploader->buffer_alignment, image_allocation->format, subresource.aspectMask);
+    if (!alignment)
+    {
+        JVM_ERROR(uploader->allocator, "Texel block size of image format %d is not known, so it can not be uploaded to",
+                  (int) image_allocation->format);
+        return VK_ERROR_FORMAT_NOT_SUPPORTED;
+    }
+    VkDeviceSize staged_offset;
+    const VkResult res = stage_data(uploader, data, size, alignment, &staged_offset);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+    uploader->copies[uploader->copy_count] = (jvm_upload_copy)
+            {
+                    .image = image_allocation->image,
+                    .layout = layout,
+                    .image_region =
+                            {
+                                    .bufferOffset = staged_offset,
+                                    .imageSubresource = subresource,
+                                    .imageOffset = offset,
+                                    .imageExtent = extent,
+                            },
+            };
+    uploader->copy_count += 1;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_uploader_record(jvm_uploader* uploader, VkCommandBuffer command_buffer, uint64_t retire_value)
+{
+    if (!uploader->copy_count)
+    {
+        return VK_SUCCESS;
+    }
+    if (!(uploader->ring.memory_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        const VkResult res = jvm_buffer_mapped_flush(uploader->ring.buffer);
+        if (res != VK_SUCCESS)
+        {
+            JVM_ERROR(uploader->allocator, "Could not flush staging ring");
+            return res;
+        }
+    }
+    const VkResult res = jvm_ring_close(uploader->allocator, &uploader->ring, retire_value);
+    if (res != VK_SUCCESS)
+    {
+        return res;
+    }
+
+    //  Consecutive copies to the same destination are recorded with a single command, unless their destination regions
+    //  overlap, since regions of a single command may not
+    const VkBuffer staging_buffer = uploader->ring.buffer->buffer;
+    for (unsigned i = 0; i < uploader->copy_count;)
+    {
+        const jvm_upload_copy* const first = uploader->copies + i;
+        uint32_t region_count = 0;
+        if (first->buffer != VK_NULL_HANDLE)
+        {
+            for (; i < uploader->copy_count; ++i)
+            {
+                const jvm_upload_copy* const copy = uploader->copies + i;
+                if (copy->buffer != first->buffer)
+                {
+                    break;
+                }
+                uint32_t j;
+                for (j = 0; j < region_count; ++j)
+                {
+                    if (buffer_regions_overlap(uploader->buffer_regions + j, &copy->buffer_region))
+                    {
+                        break;
+                    }
+                }
+                if (j != region_count)
+                {
+                    break;
+                }
+                uploader->buffer_regions[region_count++] = copy->buffer_region;
+            }
+            vkCmdCopyBuffer(command_buffer, staging_buffer, first->buffer, region_count, uploader->buffer_regions);
+        }
+        else
+        {
+            for (; i < uploader->copy_count; ++i)
+            {
+                const jvm_upload_copy* const copy = uploader->copies + i;
+                if (copy->image != first->image || copy->layout != first->layout)
+                {
+                    break;
+                }
+                uint32_t j;
+                for (j = 0; j < region_count; ++j)
+                {
+                    if (image_regions_overlap(uploader->image_regions + j, &copy->image_region))
+                    {
+                        break;
+                    }
+                }
+                if (j != region_count)
+                {
+                    break;
+                }
+                uploader->image_regions[region_count++] = copy->image_region;
+            }
+            vkCmdCopyBufferToImage(
+                    command_buffer, staging_buffer, first->image, first->layout, region_count, uploader->image_regions);
+        }
+    }
+    uploader->copy_count = 0;
+    return VK_SUCCESS;
+}
+
+void jvm_uploader_report_progress(jvm_uploader* uploader, uint64_t completed_value)
+{
+    jvm_ring_retire(&uploader->ring, completed_value);
+}
@@ -0,0 +1,150 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include "../include/jvm.h"
+#include "internal.h"
+
+//  BAR smaller than this is the legacy 256 MiB window, which should only be used by resources which really need it
+#define JVM_RESIZABLE_BAR_MIN_SIZE ((VkDeviceSize) 256 << 20)
+
+//  Scores how well a memory type suits a usage. Negative if it should not be used for it at all
+static int score_memory_type(jvm_memory_usage usage, VkMemoryPropertyFlags flags, VkBool32 bar_usable, VkBool32 unified)
+{
+    const int device_local = (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+    const int host_visible = (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    const int host_coherent = (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    const int host_cached = (flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) != 0;
+    const int lazy = (flags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+    if (flags & VK_MEMORY_PROPERTY_PROTECTED_BIT)
+    {
+        //  Only usable by protected resources
+        return -1;
+    }
+    if (lazy && usage != JVM_MEMORY_USAGE_GPU_LAZY)
+    {
+        return -1;
+    }
+    //  Device coherent memory is slow and only needed for debugging
+    const int amd_penalty = (flags & VK_MEMORY_PROPERTY_DEVICE_COHERENT_BIT_AMD) ? 64 : 0;
+    int score;
+    switch (usage)
+    {
+    case JVM_MEMORY_USAGE_GPU_ONLY:
+        score = device_local * 16 + !host_visible * 8;
+        break;
+    case JVM_MEMORY_USAGE_CPU_TO_GPU:
+        if (!host_visible)
+        {
+            return -1;
+        }
+        //  Host writes go straight over the bus, so write-combined (uncached) memory is best
+        score = (device_local ? (bar_usable ? 32 : 0) : 16) + host_coherent * 4 + !host_cached * 2;
+        break;
+    case JVM_MEMORY_USAGE_GPU_TO_CPU:
+        if (!host_visible)
+        {
+            return -1;
+        }
+        score = host_cached * 32 + (!device_local || unified) * 16 + host_coherent * 4;
+        break;
+    case JVM_MEMORY_USAGE_CPU_ONLY:
+        if (!host_visible)
+        {
+            return -1;
+        }
+        score = (!device_local || unified) * 32 + host_coherent * 4 + !host_cached * 2;
+        break;
+    case JVM_MEMORY_USAGE_GPU_LAZY:
+        score = lazy * 32 + device_local * 16 + !host_visible * 8;
+        break;
+    default:
+        //  Every type is as good as any other
+        score = 0;
+        break;
+    }
+    return score - amd_penalty + 64;
+}
+
+void jvm_rank_memory_types(
+        const VkPhysicalDeviceMemoryProperties* memory_properties, VkPhysicalDeviceType device_type,
+        uint32_t type_counts[JVM_MEMORY_USAGE_COUNT], uint32_t types[JVM_MEMORY_USAGE_COUNT][VK_MAX_MEMORY_TYPES])
+{
+    //  Integrated devices have no separate device memory, even if not all heaps are marked as device local
+    const VkBool32 unified = device_type == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU ||
+                             device_type == VK_PHYSICAL_DEVICE_TYPE_CPU;
+    VkBool32 bar_usable = unified;
+    for (uint32_t i = 0; i < memory_properties->memoryTypeCount; ++i)
+    {
+        const VkMemoryType* const type = memory_properties->memoryTypes + i;
+        const VkMemoryPropertyFlags bar_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        if ((type->propertyFlags & bar_flags) == bar_flags &&
+            memory_properties->memoryHeaps[type->heapIndex].size > JVM_RESIZABLE_BAR_MIN_SIZE)
+        {
+            bar_usable = 1;
+        }
+    }
+
+    for (unsigned usage = 0; usage < JVM_MEMORY_USAGE_COUNT; ++usage)
+    {
+        int scores[VK_MAX_MEMORY_TYPES];
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < memory_properties->memoryTypeCount; ++i)
+        {
+            const int score = score_memory_type(
+                    (jvm_memory_usage) usage, memory_properties->memoryTypes[i].propertyFlags, bar_usable, unified);
+            if (score < 0)
+            {
+                continue;
+            }
+            //  Insert sorted by score, then by heap size, keeping the order of types otherwise
+            const VkDeviceSize heap_size = memory_properties->memoryHeaps[memory_properties->memoryTypes[i].heapIndex].size;
+            uint32_t pos = count;
+            while (pos > 0)
+            {
+                const uint32_t prev = types[usage][pos - 1];
+                const VkDeviceSize prev_heap_size = memory_properties->memoryHeaps[memory_properties->memoryTypes[prev].heapIndex].size;
+                if (scores[pos - 1] > score || (scores[pos - 1] == score && prev_heap_size >= heap_size))
+                {
+                    break;
+                }
+                types[usage][pos] = prev;
+                scores[pos] = scores[pos - 1];
+                pos -= 1;
+            }
+            types[usage][pos] = i;
+            scores[pos] = score;
+            count += 1;
+        }
+        type_counts[usage] = count;
+    }
+}
+
+VkResult jvm_choose_memory_type(
+        const jvm_allocator* allocator, uint32_t type_bits, const jvm_allocation_create_info* allocation_info,
+        VkBool32 allow_lazy, uint32_t* p_index)
+{
+    const VkMemoryPropertyFlags desired_flags = allocation_info->desired_flags;
+    VkMemoryPropertyFlags undesired_flags = allocation_info->undesired_flags;
+    if (!allow_lazy)
+    {
+        undesired_flags |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+    }
+    if (allocation_info->usage == JVM_MEMORY_USAGE_UNKNOWN || allocation_info->usage >= JVM_MEMORY_USAGE_COUNT)
+    {
+        return jvm_find_memory_type(&allocator->memory_properties, type_bits, desired_flags, undesired_flags, p_index);
+    }
+
+    const uint32_t count = allocator->usage_type_counts[allocation_info->usage];
+    const uint32_t* const types = allocator->usage_types[allocation_info->usage];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const VkMemoryPropertyFlags flags = allocator->memory_properties.memoryTypes[types[i]].propertyFlags;
+        if ((type_bits & (1 << types[i])) && (flags & desired_flags) == desired_flags && !(flags & undesired_flags))
+        {
+            *p_index = types[i];
+            return VK_SUCCESS;
+        }
+    }
+    return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+}
@@ -0,0 +1,166 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <string.h>
+#include "../include/jvm.h"
+#include "internal.h"
+
+//  A virtual block is a pool without memory, owned by an allocator without a device. The allocator only holds what the
+//  chunk placement needs: host callbacks, slabs of chunks and the placement parameters. Vulkan is never called for it
+struct jvm_virtual_block_T
+{
+    jvm_allocator host;                 //  host-only allocator the pool's chunks are allocated with
+    jvm_allocation_pool pool;           //  pool with no memory, whose chunks are the block's allocations
+    jvm_allocation_strategy strategy;   //  strategy used for all allocations
+};
+
+VkResult jvm_virtual_block_create(jvm_virtual_block_create_info create_info, jvm_virtual_block** p_out)
+{
+    jvm_virtual_block_create_info info = create_info;
+    if (!info.allocation_callbacks)
+    {
+        info.allocation_callbacks = &DEFAULT_ALLOC_CALLBACKS;
+    }
+    if (!info.error_callbacks)
+    {
+        info.error_callbacks = &DEFAULT_ERROR_CALLBACKS;
+    }
+
+    jvm_virtual_block* const this = info.allocation_callbacks->allocate(
+            info.allocation_callbacks->state, sizeof(*this));
+    if (!this)
+    {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memset(this, 0, sizeof(*this));
+    jvm_allocator* const host = &this->host;
+    host->allocation_callbacks = *info.allocation_callbacks;
+    host->error_callbacks = *info.error_callbacks;
+    host->min_allocation_size = info.min_allocation_size;
+    //  Everything in the block is of the same class, so there is never any granularity to keep
+    host->buffer_image_granularity = 1;
+    host->separate_linear_and_optimal = 0;
+    host->default_strategy = info.strategy != JVM_ALLOCATION_STRATEGY_DEFAULT
+                             ? info.strategy : JVM_ALLOCATION_STRATEGY_FIRST_FIT;
+    this->strategy = host->default_strategy;
+    if (info.size == 0)
+    {
+        JVM_ERROR(host, "Virtual block can not be of size zero");
+        info.allocation_callbacks->free(info.allocation_callbacks->state, this);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    jvm_object_pool_init(&host->chunk_objects, sizeof(jvm_chunk), 256);
+
+    jvm_allocation_pool* const pool = &this->pool;
+    pool->memory = VK_NULL_HANDLE;
+    pool->size = info.size;
+    pool->lifetime = JVM_ALLOCATION_LIFETIME_DEFAULT;
+    pool->priority = JVM_DEFAULT_PRIORITY;
+    if (!jvm_init_pool_chunks(host, pool, info.size))
+    {
+        jvm_object_pool_release(host, &host->chunk_objects);
+        info.allocation_callbacks->free(info.allocation_callbacks->state, this);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    *p_out = this;
+    return VK_SUCCESS;
+}
+
+void jvm_virtual_block_destroy(jvm_virtual_block* block)
+{
+    jvm_allocator* const host = &block->host;
+    jvm_allocation_pool* const pool = &block->pool;
+    unsigned used = 0;
+    for (unsigned i = 0; i < pool->chunk_count; ++i)
+    {
+        used += pool->chunks[i]->used != 0;
+    }
+    if (used)
+    {
+        JVM_ERROR(host, "Virtual block has %u allocations left, which were not free-d yet", used);
+    }
+    jvm_free_pool_metadata(host, pool);
+    jvm_object_pool_release(host, &host->chunk_objects);
+    //  Callbacks are copied out first, since they are in the memory being freed
+    const jvm_allocation_callbacks callbacks = host->allocation_callbacks;
+    callbacks.free(callbacks.state, block);
+}
+
+VkResult jvm_virtual_block_allocate(
+        jvm_virtual_block* block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* p_offset)
+{
+    jvm_allocator* const host = &block->host;
+    if (size == 0)
+    {
+        JVM_ERROR(host, "Virtual allocation can not be of size zero");
+        return VK_ERROR_UNKNOWN;
+    }
+    jvm_chunk* chunk;
+    const int res = jvm_allocate_from_pool(
+            host, &block->pool, size, alignment ? alignment : 1, JVM_TILING_CLASS_NONE, block->strategy, &chunk);
+    if (res > 0)
+    {
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+    if (res < 0)
+    {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    *p_offset = chunk->chunk_offset + chunk->padding;
+    return VK_SUCCESS;
+}
+
+VkResult jvm_virtual_block_free(jvm_virtual_block* block, VkDeviceSize offset)
+{
+    jvm_allocation_pool* const pool = &block->pool;
+    //  Chunks are sorted by their offsets, so the allocation is in the last one which begins at or before it
+    unsigned idx = 0, end = pool->chunk_count;
+    while (idx < end)
+    {
+        const unsigned mid = idx + (end - idx) / 2;
+        if (pool->chunk_offsets[mid] <= offset)
+        {
+            idx = mid + 1;
+        }
+        else
+        {
+            end = mid;
+        }
+    }
+    jvm_chunk* const chunk = idx ? pool->chunks[idx - 1] : NULL;
+    if (!chunk || !chunk->used || chunk->chunk_offset + chunk->padding != offset)
+    {
+        JVM_ERROR(&block->host, "Virtual block has no allocation at offset %zu", (size_t) offset);
+        return VK_ERROR_UNKNOWN;
+    }
+    (void) jvm_deallocate_from_pool(&block->host, pool, chunk);
+    return VK_SUCCESS;
+}
+
+void jvm_virtual_block_get_stats(const jvm_virtual_block* block, jvm_virtual_block_stats* p_stats)
+{
+    const jvm_allocation_pool* const pool = &block->pool;
+    jvm_virtual_block_stats stats =
+            {
+                    .size = pool->size,
+            };
+    for (unsigned i = 0; i < pool->chunk_count; ++i)
+    {
+        if (pool->chunks[i]->used)
+        {
+            stats.allocation_count += 1;
+            stats.used_size += pool->chunk_sizes[i];
+        }
+        else
+        {
+            stats.unused_range_count += 1;
+            if (pool->chunk_sizes[i] > stats.largest_unused_range)
+            {
+                stats.largest_unused_range = pool->chunk_sizes[i];
+            }
+        }
+    }
+    *p_stats = stats;
+}
@@ -0,0 +1,77 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/jvm.h"
+#include "../source/internal.h"
+
+//  Measures every kernel for write-combined memory the CPU supports. Without a device there is no write-combined memory
+//  to write to, so ordinary memory is used, where non-temporal stores gain from not reading the destination into cache
+
+#define BUFFER_SIZE ((size_t) 64 << 20)
+#define REPEAT_COUNT 16
+
+static double gigabytes_per_second(clock_t begin, clock_t end)
+{
+    const double seconds = (double) (end - begin) / CLOCKS_PER_SEC;
+    return seconds > 0 ? (double) BUFFER_SIZE * REPEAT_COUNT / seconds / 1e9 : 0;
+}
+
+int main(void)
+{
+    unsigned char* const src = malloc(BUFFER_SIZE);
+    unsigned char* const dst = malloc(BUFFER_SIZE);
+    if (!src || !dst)
+    {
+        fprintf(stderr, "Could not allocate %zu bytes for benchmark buffers\n", BUFFER_SIZE);
+        free(src);
+        free(dst);
+        return 1;
+    }
+    for (size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        src[i] = (unsigned char) (i * 31);
+    }
+    memset(dst, 0, BUFFER_SIZE);
+
+    jvm_mapped_kernels kernels[JVM_MAPPED_KERNEL_COUNT];
+    const unsigned count = jvm_supported_mapped_kernels(kernels);
+    int res = 0;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        const jvm_mapped_kernels* const k = kernels + i;
+        clock_t begin = clock();
+        for (unsigned j = 0; j < REPEAT_COUNT; ++j)
+        {
+            k->write(dst, src, BUFFER_SIZE);
+        }
+        const double write_rate = gigabytes_per_second(begin, clock());
+        if (memcmp(dst, src, BUFFER_SIZE) != 0)
+        {
+            fprintf(stderr, "Write kernel %s did not copy the buffer\n", k->name);
+            res = 1;
+        }
+
+        begin = clock();
+        for (unsigned j = 0; j < REPEAT_COUNT; ++j)
+        {
+            k->fill(dst, (int) j, BUFFER_SIZE);
+        }
+        const double fill_rate = gigabytes_per_second(begin, clock());
+        if (dst[0] != REPEAT_COUNT - 1 || dst[BUFFER_SIZE - 1] != REPEAT_COUNT - 1)
+        {
+            fprintf(stderr, "Fill kernel %s did not fill the buffer\n", k->name);
+            res = 1;
+        }
+
+        printf("%-8s write %6.2f GB/s  fill %6.2f GB/s\n", k->name, write_rate, fill_rate);
+    }
+
+    free(src);
+    free(dst);
+    return res;
+}
@@ -0,0 +1,145 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../include/jvm.h"
+#include "../source/internal.h"
+
+//  Replays the same random sequence of allocations and frees, all of them a multiple of the page size, through a page
+//  pool and through a pool of chunks. Pools are given no memory and are used with a host-only allocator, the same way a
+//  virtual block does, so this measures the placement without a device
+
+#define SLOT_COUNT 2000
+#define OPERATION_COUNT 100000
+#define PAGE_SIZE ((VkDeviceSize) 64 << 10)
+#define POOL_SIZE ((VkDeviceSize) 1 << 30)
+
+static uint64_t next_random(uint64_t* state)
+{
+    //  xorshift64, so that both pools see exactly the same sequence on every platform
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static void init_host(jvm_allocator* host)
+{
+    memset(host, 0, sizeof(*host));
+    host->allocation_callbacks = DEFAULT_ALLOC_CALLBACKS;
+    host->error_callbacks = DEFAULT_ERROR_CALLBACKS;
+    host->buffer_image_granularity = 1;
+    host->default_strategy = JVM_ALLOCATION_STRATEGY_FIRST_FIT;
+    jvm_object_pool_init(&host->chunk_objects, sizeof(jvm_chunk), 256);
+}
+
+static int replay(int paged, const char* name)
+{
+    jvm_allocator host;
+    init_host(&host);
+    jvm_allocation_pool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.memory = VK_NULL_HANDLE;
+    pool.size = POOL_SIZE;
+    pool.lifetime = JVM_ALLOCATION_LIFETIME_DEFAULT;
+    pool.priority = JVM_DEFAULT_PRIORITY;
+    const int init_res = paged ? jvm_page_pool_init(&host, &pool, PAGE_SIZE)
+                               : jvm_init_pool_chunks(&host, &pool, POOL_SIZE);
+    if (!init_res)
+    {
+        fprintf(stderr, "Could not create %s\n", name);
+        jvm_object_pool_release(&host, &host.chunk_objects);
+        return 1;
+    }
+    static jvm_chunk* chunks[SLOT_COUNT];
+    for (unsigned i = 0; i < SLOT_COUNT; ++i)
+    {
+        chunks[i] = NULL;
+    }
+    uint64_t state = 0x9E3779B97F4A7C15u;
+    unsigned failed = 0;
+    int res = 0;
+
+    const clock_t begin = clock();
+    for (unsigned i = 0; i < OPERATION_COUNT; ++i)
+    {
+        const unsigned slot = (unsigned) (next_random(&state) % SLOT_COUNT);
+        if (chunks[slot])
+        {
+            (void) jvm_deallocate_from_pool(&host, &pool, chunks[slot]);
+            chunks[slot] = NULL;
+            continue;
+        }
+        //  Mostly runs of a few pages, with the occasional one of up to 4 MiB
+        const uint64_t r = next_random(&state);
+        const uint32_t page_count = (r & 15) ? 1 + (uint32_t) ((r >> 8) % 8) : 1 + (uint32_t) ((r >> 8) % 64);
+        if (paged)
+        {
+            uint32_t first;
+            if (jvm_page_pool_find(&pool, page_count, &first))
+            {
+                chunks[slot] = jvm_page_pool_take(&host, &pool, first, page_count, JVM_TILING_CLASS_NONE);
+                if (!chunks[slot])
+                {
+                    res = 1;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            const int alloc_res = jvm_allocate_from_pool(
+                    &host, &pool, PAGE_SIZE * page_count, PAGE_SIZE, JVM_TILING_CLASS_NONE,
+                    JVM_ALLOCATION_STRATEGY_FIRST_FIT, chunks + slot);
+            if (alloc_res < 0)
+            {
+                res = 1;
+                break;
+            }
+            if (alloc_res > 0)
+            {
+                chunks[slot] = NULL;
+            }
+        }
+        failed += !chunks[slot];
+    }
+    const clock_t end = clock();
+
+    unsigned live = 0;
+    VkDeviceSize used = 0;
+    for (unsigned i = 0; i < SLOT_COUNT; ++i)
+    {
+        if (chunks[i])
+        {
+            live += 1;
+            used += chunks[i]->size;
+            (void) jvm_deallocate_from_pool(&host, &pool, chunks[i]);
+        }
+    }
+    if (res)
+    {
+        fprintf(stderr, "Could not allocate host memory for %s\n", name);
+    }
+    else
+    {
+        printf("%-10s %8.2f ms  %6u failed  %6u allocations  %8zu KiB used\n", name,
+               1000.0 * (double) (end - begin) / CLOCKS_PER_SEC, failed, live, (size_t) (used >> 10));
+    }
+
+    jvm_free_pool_metadata(&host, &pool);
+    jvm_object_pool_release(&host, &host.chunk_objects);
+    return res;
+}
+
+int main(void)
+{
+    int res = 0;
+    res |= replay(1, "pages");
+    res |= replay(0, "chunks");
+    return res;
+}
@@ -0,0 +1,100 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <stdio.h>
+#include <time.h>
+#include "../include/jvm.h"
+
+//  Replays the same random sequence of allocations and frees with each placement strategy. Virtual blocks place their
+//  allocations with the same code as memory pools do, so this measures the strategies without a device
+
+#define SLOT_COUNT 4000
+#define OPERATION_COUNT 100000
+#define BLOCK_SIZE ((VkDeviceSize) 256 << 20)
+
+static uint64_t next_random(uint64_t* state)
+{
+    //  xorshift64, so that each strategy sees exactly the same sequence on every platform
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static int replay(jvm_allocation_strategy strategy, const char* name)
+{
+    jvm_virtual_block* block;
+    const jvm_virtual_block_create_info create_info =
+            {
+                    .size = BLOCK_SIZE,
+                    .min_allocation_size = 64,
+                    .strategy = strategy,
+            };
+    if (jvm_virtual_block_create(create_info, &block) != VK_SUCCESS)
+    {
+        fprintf(stderr, "Could not create virtual block for strategy %s\n", name);
+        return 1;
+    }
+    static VkDeviceSize offsets[SLOT_COUNT];
+    static int live[SLOT_COUNT];
+    for (unsigned i = 0; i < SLOT_COUNT; ++i)
+    {
+        live[i] = 0;
+    }
+    uint64_t state = 0x9E3779B97F4A7C15u;
+    unsigned failed = 0;
+
+    const clock_t begin = clock();
+    for (unsigned i = 0; i < OPERATION_COUNT; ++i)
+    {
+        const unsigned slot = (unsigned) (next_random(&state) % SLOT_COUNT);
+        if (live[slot])
+        {
+            (void) jvm_virtual_block_free(block, offsets[slot]);
+            live[slot] = 0;
+            continue;
+        }
+        //  Mostly small buffers, with the occasional large one of up to 1 MiB
+        const uint64_t r = next_random(&state);
+        const VkDeviceSize size = (r & 15) ? 1 + (r >> 8) % (16 << 10) : 1 + (r >> 8) % (1 << 20);
+        const VkDeviceSize alignment = (VkDeviceSize) 1 << ((r >> 4) % 9);
+        if (jvm_virtual_block_allocate(block, size, alignment, offsets + slot) == VK_SUCCESS)
+        {
+            live[slot] = 1;
+        }
+        else
+        {
+            failed += 1;
+        }
+    }
+    const clock_t end = clock();
+
+    jvm_virtual_block_stats stats;
+    jvm_virtual_block_get_stats(block, &stats);
+    printf("%-10s %8.2f ms  %6u failed  %6u allocations  %6u unused ranges  largest unused %8zu KiB\n", name,
+           1000.0 * (double) (end - begin) / CLOCKS_PER_SEC, failed, stats.allocation_count, stats.unused_range_count,
+           (size_t) (stats.largest_unused_range >> 10));
+
+    for (unsigned i = 0; i < SLOT_COUNT; ++i)
+    {
+        if (live[i])
+        {
+            (void) jvm_virtual_block_free(block, offsets[i]);
+        }
+    }
+    jvm_virtual_block_destroy(block);
+    return 0;
+}
+
+int main(void)
+{
+    int res = 0;
+    res |= replay(JVM_ALLOCATION_STRATEGY_FIRST_FIT, "FIRST_FIT");
+    res |= replay(JVM_ALLOCATION_STRATEGY_BEST_FIT, "BEST_FIT");
+    res |= replay(JVM_ALLOCATION_STRATEGY_MIN_OFFSET, "MIN_OFFSET");
+    res |= replay(JVM_ALLOCATION_STRATEGY_FASTEST, "FASTEST");
+    return res;
+}
@@ -0,0 +1,70 @@
+//
+// Created by jan on 18.10.2026.
+//
+
+#include <stdio.h>
+#include "../include/jvm.h"
+#include "../source/internal.h"
+
+//  Checks placement of transient attachments on memory properties alone, so that it runs without a device
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); return 1; } } while (0)
+
+int main(void)
+{
+    //  Discrete device: device local and host visible memory, nothing lazily allocated
+    VkPhysicalDeviceMemoryProperties props =
+            {
+                    .memoryTypeCount = 3,
+                    .memoryTypes =
+                            {
+                                    {VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1},
+                                    {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0},
+                                    {VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 1},
+                            },
+                    .memoryHeapCount = 2,
+                    .memoryHeaps =
+                            {
+                                    {(VkDeviceSize) 8 << 30, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT},
+                                    {(VkDeviceSize) 16 << 30, 0},
+                            },
+            };
+    VkMemoryPropertyFlags desired = 0, undesired = 0;
+    uint32_t idx;
+
+    //  Without lazily allocated memory the attachment falls back to device local memory and need not be dedicated
+    CHECK(!jvm_transient_attachment_flags(&props, 0x7, &desired, &undesired));
+    CHECK(desired & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    CHECK(!(desired & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT));
+    CHECK(jvm_find_memory_type(&props, 0x7, desired, undesired, &idx) == VK_SUCCESS);
+    CHECK(idx == 1);
+
+    //  Types the resource can not use do not change that
+    desired = 0;
+    undesired = 0;
+    CHECK(!jvm_transient_attachment_flags(&props, 0x5, &desired, &undesired));
+    CHECK(!(desired & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+    CHECK(jvm_find_memory_type(&props, 0x5, desired, undesired, &idx) == VK_SUCCESS);
+
+    //  Tile-based device which exposes lazily allocated memory gets it, and never a mappable type
+    props.memoryTypes[props.memoryTypeCount++] = (VkMemoryType)
+            {
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, 0
+            };
+    desired = 0;
+    undesired = 0;
+    CHECK(jvm_transient_attachment_flags(&props, 0xF, &desired, &undesired));
+    CHECK(desired & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+    CHECK(undesired & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    CHECK(jvm_find_memory_type(&props, 0xF, desired, undesired, &idx) == VK_SUCCESS);
+    CHECK(idx == 3);
+
+    //  Unless the resource can not be placed there
+    desired = 0;
+    undesired = 0;
+    CHECK(!jvm_transient_attachment_flags(&props, 0x7, &desired, &undesired));
+    CHECK(jvm_find_memory_type(&props, 0x7, desired, undesired, &idx) == VK_SUCCESS);
+    CHECK(idx == 1);
+
+    return 0;
+}